@@ -10,8 +10,11 @@
 #include "render.h"
 
 int main([[maybe_unused]] int argc, [[maybe_unused]] char* argv[]) {
-  crossdesk::Render render;
-  render.Run();
+  {
+    crossdesk::Render render;
+    render.Run();
+  }
+  crossdesk::ShutdownLogger();
 
   return 0;
 }
\ No newline at end of file
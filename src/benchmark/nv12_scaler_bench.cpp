@@ -0,0 +1,161 @@
+// Times Nv12Scaler against the libyuv path the thumbnail used before:
+// NV12ToI420, a bilinear I420Scale to the letterboxed size, I420ToABGR
+// and a copy into the black frame. Both scale the same synthetic frame
+// to a 160x90 thumbnail and the largest per-channel difference is shown.
+//
+// usage: crossdesk_nv12_scaler_bench [width] [height] [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "libyuv.h"
+#include "nv12_scaler.h"
+
+using namespace crossdesk;
+
+namespace {
+
+constexpr int kThumbnailWidth = 160;
+constexpr int kThumbnailHeight = 90;
+
+// the pre-Nv12Scaler Thumbnail::ScaleNv12ToABGR, scratch buffers kept
+class LibyuvScaler {
+ public:
+  void Scale(const uint8_t* src, int src_w, int src_h, int dst_w, int dst_h,
+             uint8_t* dst_rgba) {
+    const uint8_t* y = src;
+    const uint8_t* uv = y + src_w * src_h;
+
+    float src_aspect = float(src_w) / src_h;
+    float dst_aspect = float(dst_w) / dst_h;
+    int fit_w = dst_w, fit_h = dst_h;
+    if (src_aspect > dst_aspect) {
+      fit_h = int(dst_w / src_aspect);
+    } else {
+      fit_w = int(dst_h * src_aspect);
+    }
+
+    size_t y_size = (size_t)src_w * src_h;
+    size_t uv_size = (size_t)(src_w / 2) * (src_h / 2);
+    i420_scratch_.resize(y_size + 2 * uv_size);
+    uint8_t* y_i420 = i420_scratch_.data();
+    uint8_t* u_i420 = y_i420 + y_size;
+    uint8_t* v_i420 = u_i420 + uv_size;
+    libyuv::NV12ToI420(y, src_w, uv, src_w, y_i420, src_w, u_i420, src_w / 2,
+                       v_i420, src_w / 2, src_w, src_h);
+
+    int fit_uv_w = (fit_w + 1) / 2;
+    size_t y_fit_size = (size_t)fit_w * fit_h;
+    size_t uv_fit_size = (size_t)fit_uv_w * ((fit_h + 1) / 2);
+    fit_scratch_.resize(y_fit_size + 2 * uv_fit_size);
+    uint8_t* y_fit = fit_scratch_.data();
+    uint8_t* u_fit = y_fit + y_fit_size;
+    uint8_t* v_fit = u_fit + uv_fit_size;
+    libyuv::I420Scale(y_i420, src_w, u_i420, src_w / 2, v_i420, src_w / 2,
+                      src_w, src_h, y_fit, fit_w, u_fit, fit_uv_w, v_fit,
+                      fit_uv_w, fit_w, fit_h, libyuv::kFilterBilinear);
+
+    abgr_scratch_.resize((size_t)fit_w * fit_h * 4);
+    libyuv::I420ToABGR(y_fit, fit_w, u_fit, fit_uv_w, v_fit, fit_uv_w,
+                       abgr_scratch_.data(), fit_w * 4, fit_w, fit_h);
+
+    memset(dst_rgba, 0, dst_w * dst_h * 4);
+    for (int i = 0; i < dst_w * dst_h; ++i) {
+      dst_rgba[i * 4 + 3] = 0xFF;
+    }
+    for (int row = 0; row < fit_h; ++row) {
+      int dst_offset =
+          ((row + (dst_h - fit_h) / 2) * dst_w + (dst_w - fit_w) / 2) * 4;
+      memcpy(dst_rgba + dst_offset, abgr_scratch_.data() + row * fit_w * 4,
+             fit_w * 4);
+    }
+  }
+
+ private:
+  std::vector<uint8_t> i420_scratch_;
+  std::vector<uint8_t> fit_scratch_;
+  std::vector<uint8_t> abgr_scratch_;
+};
+
+// smooth gradients plus a little noise, closer to a desktop than random
+// bytes and still defeating any caching of repeated rows
+void FillFrame(std::vector<uint8_t>& nv12, int width, int height) {
+  uint32_t seed = 1;
+  auto noise = [&seed]() {
+    seed = seed * 1664525u + 1013904223u;
+    return (int)(seed >> 28) - 8;
+  };
+  uint8_t* y = nv12.data();
+  for (int row = 0; row < height; ++row) {
+    for (int col = 0; col < width; ++col) {
+      int value = 16 + (col * 219 / width + row * 64 / height) / 2 + noise();
+      y[row * width + col] = (uint8_t)std::clamp(value, 16, 235);
+    }
+  }
+  uint8_t* uv = y + (size_t)width * height;
+  for (int row = 0; row < height / 2; ++row) {
+    for (int col = 0; col < width / 2; ++col) {
+      uv[row * width + col * 2] = (uint8_t)(64 + col * 128 / (width / 2));
+      uv[row * width + col * 2 + 1] = (uint8_t)(64 + row * 128 / (height / 2));
+    }
+  }
+}
+
+template <typename Scaler>
+double TimeScaler(Scaler& scaler, const std::vector<uint8_t>& nv12, int width,
+                  int height, int iterations, std::vector<uint8_t>& rgba) {
+  // first call sizes the scratch buffers, as a thumbnail's first frame does
+  scaler.Scale(nv12.data(), width, height, kThumbnailWidth, kThumbnailHeight,
+               rgba.data());
+  double best = 1e9;
+  for (int i = 0; i < iterations; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    scaler.Scale(nv12.data(), width, height, kThumbnailWidth,
+                 kThumbnailHeight, rgba.data());
+    double ms = std::chrono::duration<double, std::milli>(
+                    std::chrono::steady_clock::now() - start)
+                    .count();
+    best = std::min(best, ms);
+  }
+  return best;
+}
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  int width = argc > 1 ? atoi(argv[1]) : 3840;
+  int height = argc > 2 ? atoi(argv[2]) : 2160;
+  int iterations = argc > 3 ? atoi(argv[3]) : 50;
+  if (width < 2 || height < 2 || (width & 1) || (height & 1) ||
+      iterations < 1) {
+    fprintf(stderr, "width and height must be even and at least 2\n");
+    return 1;
+  }
+
+  std::vector<uint8_t> nv12((size_t)width * height * 3 / 2);
+  FillFrame(nv12, width, height);
+
+  std::vector<uint8_t> libyuv_rgba(kThumbnailWidth * kThumbnailHeight * 4);
+  std::vector<uint8_t> scaler_rgba(libyuv_rgba.size());
+  LibyuvScaler libyuv_scaler;
+  Nv12Scaler nv12_scaler;
+  double libyuv_ms = TimeScaler(libyuv_scaler, nv12, width, height,
+                                iterations, libyuv_rgba);
+  double scaler_ms =
+      TimeScaler(nv12_scaler, nv12, width, height, iterations, scaler_rgba);
+
+  int max_diff = 0;
+  for (size_t i = 0; i < libyuv_rgba.size(); ++i) {
+    max_diff = std::max(max_diff, std::abs(libyuv_rgba[i] - scaler_rgba[i]));
+  }
+  printf(
+      "%dx%d -> %dx%d, best of %d: libyuv %.3f ms, Nv12Scaler %.3f ms "
+      "(%.1fx), max channel difference %d\n",
+      width, height, kThumbnailWidth, kThumbnailHeight, iterations, libyuv_ms,
+      scaler_ms, libyuv_ms / scaler_ms, max_diff);
+  return 0;
+}
@@ -0,0 +1,103 @@
+// Stress benchmark for SpscRingBuffer. A producer thread writes a counting
+// byte stream in fragments of random size, like PulseAudio does, while the
+// consumer peeks whole 10 ms frames in place and checks every byte.
+//
+// usage: crossdesk_spsc_bench [megabytes] [seed]
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "spsc_ring_buffer.h"
+
+using namespace crossdesk;
+
+namespace {
+
+// 480 mono S16 samples, the capture frame
+constexpr size_t kFrameBytes = 960;
+constexpr size_t kRingFrames = 32;
+// PulseAudio fragments range from a few samples to several frames
+constexpr size_t kMaxFragment = 4 * kFrameBytes;
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  uint64_t megabytes = argc > 1 ? strtoull(argv[1], nullptr, 10) : 1024;
+  uint32_t seed = argc > 2 ? (uint32_t)strtoul(argv[2], nullptr, 10)
+                           : std::random_device()();
+  uint64_t total = megabytes * 1024 * 1024 / kFrameBytes * kFrameBytes;
+
+  SpscRingBuffer ring(kRingFrames * kFrameBytes);
+  uint64_t producer_spins = 0;
+  uint64_t consumer_spins = 0;
+  uint64_t fragments = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  std::thread producer([&]() {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<size_t> fragment_size(1, kMaxFragment);
+    std::vector<uint8_t> fragment(kMaxFragment);
+    uint64_t produced = 0;
+    while (produced < total) {
+      size_t size = fragment_size(rng);
+      if (size > total - produced) {
+        size = (size_t)(total - produced);
+      }
+      for (size_t i = 0; i < size; ++i) {
+        fragment[i] = (uint8_t)(produced + i);
+      }
+
+      size_t written = 0;
+      while (written < size) {
+        size_t n = ring.Write(fragment.data() + written, size - written);
+        if (n == 0) {
+          producer_spins++;
+          std::this_thread::yield();
+        }
+        written += n;
+      }
+      produced += size;
+      fragments++;
+    }
+  });
+
+  uint64_t consumed = 0;
+  uint64_t errors = 0;
+  while (consumed < total) {
+    const uint8_t* frame = ring.Peek(kFrameBytes);
+    if (!frame) {
+      consumer_spins++;
+      std::this_thread::yield();
+      continue;
+    }
+    for (size_t i = 0; i < kFrameBytes; ++i) {
+      if (frame[i] != (uint8_t)(consumed + i)) {
+        if (errors++ == 0) {
+          fprintf(stderr, "mismatch at byte %llu\n",
+                  (unsigned long long)(consumed + i));
+        }
+      }
+    }
+    ring.Consume(kFrameBytes);
+    consumed += kFrameBytes;
+  }
+  producer.join();
+
+  double seconds = std::chrono::duration<double>(
+                       std::chrono::steady_clock::now() - start)
+                       .count();
+  printf(
+      "seed %u: %llu MiB in %llu fragments, %.3f s, %.1f MiB/s, "
+      "%.1f ns/frame, %llu producer and %llu consumer spins, %llu errors\n",
+      seed, (unsigned long long)(total / (1024 * 1024)),
+      (unsigned long long)fragments, seconds,
+      (double)total / (1024 * 1024) / seconds,
+      seconds * 1e9 / (double)(total / kFrameBytes),
+      (unsigned long long)producer_spins, (unsigned long long)consumer_spins,
+      (unsigned long long)errors);
+  return errors == 0 ? 0 : 1;
+}
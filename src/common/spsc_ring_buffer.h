@@ -0,0 +1,94 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _SPSC_RING_BUFFER_H_
+#define _SPSC_RING_BUFFER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+namespace crossdesk {
+
+// Single producer, single consumer byte ring with a fixed, preallocated
+// capacity. Neither side allocates or locks. When the consumer always reads
+// in units that divide the capacity, every unit it peeks is contiguous.
+class SpscRingBuffer {
+ public:
+  explicit SpscRingBuffer(size_t capacity)
+      : buffer_(new uint8_t[capacity]), capacity_(capacity) {}
+
+  SpscRingBuffer(const SpscRingBuffer&) = delete;
+  SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+ public:
+  // producer: copies as much of |data| as fits, returns the bytes written
+  size_t Write(const uint8_t* data, size_t size) {
+    size_t write_pos = write_pos_.load(std::memory_order_relaxed);
+    size_t read_pos = read_pos_.load(std::memory_order_acquire);
+    size_t writable = capacity_ - (write_pos - read_pos);
+    if (size > writable) {
+      size = writable;
+    }
+    if (size == 0) {
+      return 0;
+    }
+
+    size_t offset = write_pos % capacity_;
+    size_t first = capacity_ - offset < size ? capacity_ - offset : size;
+    memcpy(buffer_.get() + offset, data, first);
+    memcpy(buffer_.get(), data + first, size - first);
+
+    write_pos_.store(write_pos + size, std::memory_order_release);
+    return size;
+  }
+
+  // consumer: pointer to the next |size| bytes, or nullptr if fewer are
+  // buffered or they wrap around the end of the ring
+  const uint8_t* Peek(size_t size) const {
+    size_t read_pos = read_pos_.load(std::memory_order_relaxed);
+    size_t write_pos = write_pos_.load(std::memory_order_acquire);
+    if (write_pos - read_pos < size) {
+      return nullptr;
+    }
+
+    size_t offset = read_pos % capacity_;
+    if (offset + size > capacity_) {
+      return nullptr;
+    }
+    return buffer_.get() + offset;
+  }
+
+  // consumer: releases bytes returned by Peek back to the producer
+  void Consume(size_t size) {
+    read_pos_.store(read_pos_.load(std::memory_order_relaxed) + size,
+                    std::memory_order_release);
+  }
+
+  size_t Size() const {
+    return write_pos_.load(std::memory_order_acquire) -
+           read_pos_.load(std::memory_order_acquire);
+  }
+
+  size_t Capacity() const { return capacity_; }
+
+  // only safe while neither side is running
+  void Reset() {
+    read_pos_.store(0, std::memory_order_relaxed);
+    write_pos_.store(0, std::memory_order_relaxed);
+  }
+
+ private:
+  std::unique_ptr<uint8_t[]> buffer_;
+  size_t capacity_;
+  // monotonic byte counters, kept on separate cache lines
+  alignas(64) std::atomic<size_t> read_pos_{0};
+  alignas(64) std::atomic<size_t> write_pos_{0};
+};
+}  // namespace crossdesk
+#endif
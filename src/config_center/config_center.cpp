@@ -1,7 +1,18 @@
 #include "config_center.h"
 
+#include <algorithm>
+
+#include "rd_log.h"
+
 namespace crossdesk {
 
+namespace {
+int ClampVideoFps(long video_fps) {
+  return (int)std::clamp<long>(video_fps, ConfigCenter::kMinVideoFps,
+                               ConfigCenter::kMaxVideoFps);
+}
+}  // namespace
+
 ConfigCenter::ConfigCenter(const std::string& config_path,
                            const std::string& cert_file_path)
     : config_path_(config_path),
@@ -20,47 +31,180 @@ int ConfigCenter::Load() {
     return -1;
   }
 
+  ReadValues(ini_);
+
+  return 0;
+}
+
+int ConfigCenter::Save() {
+  WriteValues();
+
+  SI_Error rc = ini_.SaveFile(config_path_.c_str());
+  if (rc < 0) {
+    return -1;
+  }
+
+  return 0;
+}
+
+uint32_t ConfigCenter::Reload() {
+  // parsed aside, a half-written file must not wipe the current values
+  CSimpleIniA ini;
+  ini.SetUnicode(true);
+  SI_Error rc = ini.LoadFile(config_path_.c_str());
+  if (rc < 0) {
+    LOG_WARN("Failed to reload config file [{}]", config_path_);
+    return 0;
+  }
+
+  LANGUAGE language = language_;
+  VIDEO_QUALITY video_quality = video_quality_;
+  int video_fps = video_fps_;
+  int max_capture_height = max_capture_height_;
+  std::map<std::string, int> display_max_capture_heights =
+      display_max_capture_heights_;
+  VIDEO_ENCODE_FORMAT video_encode_format = video_encode_format_;
+  bool hardware_video_codec = hardware_video_codec_;
+  bool enable_turn = enable_turn_;
+  bool enable_srtp = enable_srtp_;
+  std::string signal_server_host = signal_server_host_;
+  int signal_server_port = signal_server_port_;
+  int coturn_server_port = coturn_server_port_;
+  std::string cert_file_path = cert_file_path_;
+  bool enable_self_hosted = enable_self_hosted_;
+  bool enable_minimize_to_tray = enable_minimize_to_tray_;
+  bool mute_background_tabs = mute_background_tabs_;
+  int audio_resample_quality = audio_resample_quality_;
+  bool audio_latency_probe = audio_latency_probe_;
+  bool live_preview = live_preview_;
+
+  ReadValues(ini);
+  // later setters save ini_ back, it has to hold what was just read
+  WriteValues();
+
+  uint32_t changed = 0;
+  if (language != language_) {
+    changed |= kLanguageChanged;
+  }
+  if (video_quality != video_quality_) {
+    changed |= kVideoQualityChanged;
+  }
+  if (video_fps != video_fps_) {
+    changed |= kVideoFrameRateChanged;
+  }
+  if (max_capture_height != max_capture_height_ ||
+      display_max_capture_heights != display_max_capture_heights_) {
+    changed |= kCaptureResolutionChanged;
+  }
+  if (video_encode_format != video_encode_format_ ||
+      hardware_video_codec != hardware_video_codec_) {
+    changed |= kVideoCodecChanged;
+  }
+  if (enable_turn != enable_turn_ || enable_srtp != enable_srtp_ ||
+      signal_server_host != signal_server_host_ ||
+      signal_server_port != signal_server_port_ ||
+      coturn_server_port != coturn_server_port_ ||
+      cert_file_path != cert_file_path_ ||
+      enable_self_hosted != enable_self_hosted_) {
+    changed |= kConnectionChanged;
+  }
+  if (audio_resample_quality != audio_resample_quality_ ||
+      mute_background_tabs != mute_background_tabs_ ||
+      audio_latency_probe != audio_latency_probe_) {
+    changed |= kAudioChanged;
+  }
+  if (enable_minimize_to_tray != enable_minimize_to_tray_ ||
+      live_preview != live_preview_) {
+    changed |= kInterfaceChanged;
+  }
+
+  return changed;
+}
+
+void ConfigCenter::ReadValues(const CSimpleIniA& ini) {
   language_ = static_cast<LANGUAGE>(
-      ini_.GetLongValue(section_, "language", static_cast<long>(language_)));
+      ini.GetLongValue(section_, "language", static_cast<long>(language_)));
 
-  video_quality_ = static_cast<VIDEO_QUALITY>(ini_.GetLongValue(
+  video_quality_ = static_cast<VIDEO_QUALITY>(ini.GetLongValue(
       section_, "video_quality", static_cast<long>(video_quality_)));
 
-  video_frame_rate_ = static_cast<VIDEO_FRAME_RATE>(ini_.GetLongValue(
-      section_, "video_frame_rate", static_cast<long>(video_frame_rate_)));
+  // before video_fps, video_frame_rate held 0 for 30 fps and 1 for 60 fps
+  long legacy_frame_rate = ini.GetLongValue(section_, "video_frame_rate", -1);
+  long default_fps = video_fps_;
+  if (legacy_frame_rate == 0) {
+    default_fps = 30;
+  } else if (legacy_frame_rate == 1) {
+    default_fps = 60;
+  }
+  video_fps_ =
+      ClampVideoFps(ini.GetLongValue(section_, "video_fps", default_fps));
+
+  max_capture_height_ = static_cast<int>(ini.GetLongValue(
+      section_, "max_capture_height", max_capture_height_));
+  if (max_capture_height_ < 0) {
+    max_capture_height_ = 0;
+  }
+
+  display_max_capture_heights_.clear();
+  CSimpleIniA::TNamesDepend display_names;
+  ini.GetAllKeys(display_max_capture_height_section_, display_names);
+  for (const auto& display_name : display_names) {
+    long height = ini.GetLongValue(display_max_capture_height_section_,
+                                   display_name.pItem, 0);
+    if (height > 0) {
+      display_max_capture_heights_[display_name.pItem] = (int)height;
+    }
+  }
 
   video_encode_format_ = static_cast<VIDEO_ENCODE_FORMAT>(
-      ini_.GetLongValue(section_, "video_encode_format",
-                        static_cast<long>(video_encode_format_)));
+      ini.GetLongValue(section_, "video_encode_format",
+                       static_cast<long>(video_encode_format_)));
 
-  hardware_video_codec_ = ini_.GetBoolValue(section_, "hardware_video_codec",
-                                            hardware_video_codec_);
+  hardware_video_codec_ = ini.GetBoolValue(section_, "hardware_video_codec",
+                                           hardware_video_codec_);
 
-  enable_turn_ = ini_.GetBoolValue(section_, "enable_turn", enable_turn_);
-  enable_srtp_ = ini_.GetBoolValue(section_, "enable_srtp", enable_srtp_);
-  signal_server_host_ = ini_.GetValue(section_, "signal_server_host",
-                                      signal_server_host_.c_str());
+  enable_turn_ = ini.GetBoolValue(section_, "enable_turn", enable_turn_);
+  enable_srtp_ = ini.GetBoolValue(section_, "enable_srtp", enable_srtp_);
+  signal_server_host_ = ini.GetValue(section_, "signal_server_host",
+                                     signal_server_host_.c_str());
   signal_server_port_ = static_cast<int>(
-      ini_.GetLongValue(section_, "signal_server_port", signal_server_port_));
+      ini.GetLongValue(section_, "signal_server_port", signal_server_port_));
   coturn_server_port_ = static_cast<int>(
-      ini_.GetLongValue(section_, "coturn_server_port", coturn_server_port_));
+      ini.GetLongValue(section_, "coturn_server_port", coturn_server_port_));
   cert_file_path_ =
-      ini_.GetValue(section_, "cert_file_path", cert_file_path_.c_str());
+      ini.GetValue(section_, "cert_file_path", cert_file_path_.c_str());
   enable_self_hosted_ =
-      ini_.GetBoolValue(section_, "enable_self_hosted", enable_self_hosted_);
+      ini.GetBoolValue(section_, "enable_self_hosted", enable_self_hosted_);
 
-  enable_minimize_to_tray_ = ini_.GetBoolValue(
+  enable_minimize_to_tray_ = ini.GetBoolValue(
       section_, "enable_minimize_to_tray", enable_minimize_to_tray_);
 
-  return 0;
+  mute_background_tabs_ = ini.GetBoolValue(section_, "mute_background_tabs",
+                                           mute_background_tabs_);
+  audio_resample_quality_ = static_cast<int>(ini.GetLongValue(
+      section_, "audio_resample_quality", audio_resample_quality_));
+  if (audio_resample_quality_ < 0 || audio_resample_quality_ > 2) {
+    audio_resample_quality_ = 1;
+  }
+  audio_latency_probe_ = ini.GetBoolValue(section_, "audio_latency_probe",
+                                          audio_latency_probe_);
+  live_preview_ = ini.GetBoolValue(section_, "live_preview", live_preview_);
 }
 
-int ConfigCenter::Save() {
+void ConfigCenter::WriteValues() {
   ini_.SetLongValue(section_, "language", static_cast<long>(language_));
   ini_.SetLongValue(section_, "video_quality",
                     static_cast<long>(video_quality_));
-  ini_.SetLongValue(section_, "video_frame_rate",
-                    static_cast<long>(video_frame_rate_));
+  ini_.SetLongValue(section_, "video_fps", static_cast<long>(video_fps_));
+  // still read by older versions
+  ini_.SetLongValue(section_, "video_frame_rate", video_fps_ >= 60 ? 1 : 0);
+  ini_.SetLongValue(section_, "max_capture_height",
+                    static_cast<long>(max_capture_height_));
+  ini_.Delete(display_max_capture_height_section_, nullptr);
+  for (const auto& it : display_max_capture_heights_) {
+    ini_.SetLongValue(display_max_capture_height_section_, it.first.c_str(),
+                      static_cast<long>(it.second));
+  }
   ini_.SetLongValue(section_, "video_encode_format",
                     static_cast<long>(video_encode_format_));
   ini_.SetBoolValue(section_, "hardware_video_codec", hardware_video_codec_);
@@ -69,17 +213,17 @@ int ConfigCenter::Save() {
   ini_.SetValue(section_, "signal_server_host", signal_server_host_.c_str());
   ini_.SetLongValue(section_, "signal_server_port",
                     static_cast<long>(signal_server_port_));
+  ini_.SetLongValue(section_, "coturn_server_port",
+                    static_cast<long>(coturn_server_port_));
   ini_.SetValue(section_, "cert_file_path", cert_file_path_.c_str());
   ini_.SetBoolValue(section_, "enable_self_hosted", enable_self_hosted_);
   ini_.SetBoolValue(section_, "enable_minimize_to_tray",
                     enable_minimize_to_tray_);
-
-  SI_Error rc = ini_.SaveFile(config_path_.c_str());
-  if (rc < 0) {
-    return -1;
-  }
-
-  return 0;
+  ini_.SetBoolValue(section_, "mute_background_tabs", mute_background_tabs_);
+  ini_.SetLongValue(section_, "audio_resample_quality",
+                    static_cast<long>(audio_resample_quality_));
+  ini_.SetBoolValue(section_, "audio_latency_probe", audio_latency_probe_);
+  ini_.SetBoolValue(section_, "live_preview", live_preview_);
 }
 
 // setters
@@ -105,10 +249,21 @@ int ConfigCenter::SetVideoQuality(VIDEO_QUALITY video_quality) {
   return 0;
 }
 
-int ConfigCenter::SetVideoFrameRate(VIDEO_FRAME_RATE video_frame_rate) {
-  video_frame_rate_ = video_frame_rate;
-  ini_.SetLongValue(section_, "video_frame_rate",
-                    static_cast<long>(video_frame_rate_));
+int ConfigCenter::SetVideoFps(int video_fps) {
+  video_fps_ = ClampVideoFps(video_fps);
+  ini_.SetLongValue(section_, "video_fps", static_cast<long>(video_fps_));
+  ini_.SetLongValue(section_, "video_frame_rate", video_fps_ >= 60 ? 1 : 0);
+  SI_Error rc = ini_.SaveFile(config_path_.c_str());
+  if (rc < 0) {
+    return -1;
+  }
+  return 0;
+}
+
+int ConfigCenter::SetMaxCaptureHeight(int max_capture_height) {
+  max_capture_height_ = max_capture_height > 0 ? max_capture_height : 0;
+  ini_.SetLongValue(section_, "max_capture_height",
+                    static_cast<long>(max_capture_height_));
   SI_Error rc = ini_.SaveFile(config_path_.c_str());
   if (rc < 0) {
     return -1;
@@ -181,8 +336,9 @@ int ConfigCenter::SetServerPort(int signal_server_port) {
 
 int ConfigCenter::SetCoturnServerPort(int coturn_server_port) {
   coturn_server_port_ = coturn_server_port;
-  SI_Error rc = ini_.SetLongValue(section_, "coturn_server_port",
-                                  static_cast<long>(coturn_server_port_));
+  ini_.SetLongValue(section_, "coturn_server_port",
+                    static_cast<long>(coturn_server_port_));
+  SI_Error rc = ini_.SaveFile(config_path_.c_str());
   if (rc < 0) {
     return -1;
   }
@@ -201,6 +357,7 @@ int ConfigCenter::SetCertFilePath(const std::string& cert_file_path) {
 
 int ConfigCenter::SetSelfHosted(bool enable_self_hosted) {
   enable_self_hosted_ = enable_self_hosted;
+  ini_.SetBoolValue(section_, "enable_self_hosted", enable_self_hosted_);
   SI_Error rc = ini_.SaveFile(config_path_.c_str());
   if (rc < 0) {
     return -1;
@@ -210,6 +367,53 @@ int ConfigCenter::SetSelfHosted(bool enable_self_hosted) {
 
 int ConfigCenter::SetMinimizeToTray(bool enable_minimize_to_tray) {
   enable_minimize_to_tray_ = enable_minimize_to_tray;
+  ini_.SetBoolValue(section_, "enable_minimize_to_tray",
+                    enable_minimize_to_tray_);
+  SI_Error rc = ini_.SaveFile(config_path_.c_str());
+  if (rc < 0) {
+    return -1;
+  }
+  return 0;
+}
+
+int ConfigCenter::SetMuteBackgroundTabs(bool mute_background_tabs) {
+  mute_background_tabs_ = mute_background_tabs;
+  ini_.SetBoolValue(section_, "mute_background_tabs", mute_background_tabs_);
+  SI_Error rc = ini_.SaveFile(config_path_.c_str());
+  if (rc < 0) {
+    return -1;
+  }
+  return 0;
+}
+
+int ConfigCenter::SetAudioResampleQuality(int audio_resample_quality) {
+  audio_resample_quality_ = audio_resample_quality;
+  ini_.SetLongValue(section_, "audio_resample_quality",
+                    static_cast<long>(audio_resample_quality_));
+  SI_Error rc = ini_.SaveFile(config_path_.c_str());
+  if (rc < 0) {
+    return -1;
+  }
+  return 0;
+}
+
+int ConfigCenter::SetAudioLatencyProbe(bool audio_latency_probe) {
+  audio_latency_probe_ = audio_latency_probe;
+  ini_.SetBoolValue(section_, "audio_latency_probe", audio_latency_probe_);
+  SI_Error rc = ini_.SaveFile(config_path_.c_str());
+  if (rc < 0) {
+    return -1;
+  }
+  return 0;
+}
+
+int ConfigCenter::SetLivePreview(bool live_preview) {
+  live_preview_ = live_preview;
+  ini_.SetBoolValue(section_, "live_preview", live_preview_);
+  SI_Error rc = ini_.SaveFile(config_path_.c_str());
+  if (rc < 0) {
+    return -1;
+  }
   return 0;
 }
 
@@ -221,8 +425,13 @@ ConfigCenter::VIDEO_QUALITY ConfigCenter::GetVideoQuality() const {
   return video_quality_;
 }
 
-ConfigCenter::VIDEO_FRAME_RATE ConfigCenter::GetVideoFrameRate() const {
-  return video_frame_rate_;
+int ConfigCenter::GetVideoFps() const { return video_fps_; }
+
+int ConfigCenter::GetMaxCaptureHeight() const { return max_capture_height_; }
+
+const std::map<std::string, int>& ConfigCenter::GetDisplayMaxCaptureHeights()
+    const {
+  return display_max_capture_heights_;
 }
 
 ConfigCenter::VIDEO_ENCODE_FORMAT ConfigCenter::GetVideoEncodeFormat() const {
@@ -266,4 +475,16 @@ std::string ConfigCenter::GetDefaultCertFilePath() const {
 bool ConfigCenter::IsSelfHosted() const { return enable_self_hosted_; }
 
 bool ConfigCenter::IsMinimizeToTray() const { return enable_minimize_to_tray_; }
+
+bool ConfigCenter::IsMuteBackgroundTabs() const {
+  return mute_background_tabs_;
+}
+
+int ConfigCenter::GetAudioResampleQuality() const {
+  return audio_resample_quality_;
+}
+
+bool ConfigCenter::IsAudioLatencyProbe() const { return audio_latency_probe_; }
+
+bool ConfigCenter::IsLivePreview() const { return live_preview_; }
 }  // namespace crossdesk
\ No newline at end of file
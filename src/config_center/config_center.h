@@ -7,6 +7,8 @@
 #ifndef _CONFIG_CENTER_H_
 #define _CONFIG_CENTER_H_
 
+#include <cstdint>
+#include <map>
 #include <string>
 
 #include "SimpleIni.h"
@@ -17,9 +19,26 @@ class ConfigCenter {
  public:
   enum class LANGUAGE { CHINESE = 0, ENGLISH = 1 };
   enum class VIDEO_QUALITY { LOW = 0, MEDIUM = 1, HIGH = 2 };
-  enum class VIDEO_FRAME_RATE { FPS_30 = 0, FPS_60 = 1 };
   enum class VIDEO_ENCODE_FORMAT { H264 = 0, AV1 = 1 };
 
+  static constexpr int kMinVideoFps = 1;
+  static constexpr int kMaxVideoFps = 144;
+
+  // groups of settings reported by Reload
+  static constexpr uint32_t kLanguageChanged = 1 << 0;
+  static constexpr uint32_t kVideoQualityChanged = 1 << 1;
+  static constexpr uint32_t kVideoFrameRateChanged = 1 << 2;
+  // encode format or hardware codec
+  static constexpr uint32_t kVideoCodecChanged = 1 << 3;
+  // TURN, SRTP or the self-hosted server
+  static constexpr uint32_t kConnectionChanged = 1 << 4;
+  // resample quality, background tab muting or the latency probe
+  static constexpr uint32_t kAudioChanged = 1 << 5;
+  // tray or live preview
+  static constexpr uint32_t kInterfaceChanged = 1 << 6;
+  // global or per display maximum capture height
+  static constexpr uint32_t kCaptureResolutionChanged = 1 << 7;
+
  public:
   explicit ConfigCenter(
       const std::string& config_path = "config.ini",
@@ -29,7 +48,10 @@ class ConfigCenter {
   // write config
   int SetLanguage(LANGUAGE language);
   int SetVideoQuality(VIDEO_QUALITY video_quality);
-  int SetVideoFrameRate(VIDEO_FRAME_RATE video_frame_rate);
+  // clamped to kMinVideoFps..kMaxVideoFps
+  int SetVideoFps(int video_fps);
+  // frames taller than this are scaled down before encoding, 0 for no limit
+  int SetMaxCaptureHeight(int max_capture_height);
   int SetVideoEncodeFormat(VIDEO_ENCODE_FORMAT video_encode_format);
   int SetHardwareVideoCodec(bool hardware_video_codec);
   int SetTurn(bool enable_turn);
@@ -40,12 +62,22 @@ class ConfigCenter {
   int SetCertFilePath(const std::string& cert_file_path);
   int SetSelfHosted(bool enable_self_hosted);
   int SetMinimizeToTray(bool enable_minimize_to_tray);
+  int SetMuteBackgroundTabs(bool mute_background_tabs);
+  // 0 linear, 1 16 tap sinc, 2 32 tap sinc
+  int SetAudioResampleQuality(int audio_resample_quality);
+  // diagnostics: inject and detect audio latency probe tones
+  int SetAudioLatencyProbe(bool audio_latency_probe);
+  int SetLivePreview(bool live_preview);
 
   // read config
 
   LANGUAGE GetLanguage() const;
   VIDEO_QUALITY GetVideoQuality() const;
-  VIDEO_FRAME_RATE GetVideoFrameRate() const;
+  int GetVideoFps() const;
+  int GetMaxCaptureHeight() const;
+  // per display limits from the [MaxCaptureHeight] section, by display
+  // name, they override the global one
+  const std::map<std::string, int>& GetDisplayMaxCaptureHeights() const;
   VIDEO_ENCODE_FORMAT GetVideoEncodeFormat() const;
   bool IsHardwareVideoCodec() const;
   bool IsEnableTurn() const;
@@ -60,19 +92,33 @@ class ConfigCenter {
   std::string GetDefaultCertFilePath() const;
   bool IsSelfHosted() const;
   bool IsMinimizeToTray() const;
+  bool IsMuteBackgroundTabs() const;
+  int GetAudioResampleQuality() const;
+  bool IsAudioLatencyProbe() const;
+  bool IsLivePreview() const;
 
   int Load();
   int Save();
+  // re-reads the file after it was changed by someone else, returns the
+  // k*Changed bits of the settings that differ, 0 if none or unreadable
+  uint32_t Reload();
+
+ private:
+  void ReadValues(const CSimpleIniA& ini);
+  void WriteValues();
 
  private:
   std::string config_path_;
   std::string cert_file_path_;
   CSimpleIniA ini_;
   const char* section_ = "Settings";
+  const char* display_max_capture_height_section_ = "MaxCaptureHeight";
 
   LANGUAGE language_ = LANGUAGE::CHINESE;
   VIDEO_QUALITY video_quality_ = VIDEO_QUALITY::MEDIUM;
-  VIDEO_FRAME_RATE video_frame_rate_ = VIDEO_FRAME_RATE::FPS_30;
+  int video_fps_ = 30;
+  int max_capture_height_ = 0;
+  std::map<std::string, int> display_max_capture_heights_;
   VIDEO_ENCODE_FORMAT video_encode_format_ = VIDEO_ENCODE_FORMAT::H264;
   bool hardware_video_codec_ = false;
   bool enable_turn_ = false;
@@ -86,6 +132,10 @@ class ConfigCenter {
   std::string cert_file_path_default_ = "";
   bool enable_self_hosted_ = false;
   bool enable_minimize_to_tray_ = false;
+  bool mute_background_tabs_ = false;
+  int audio_resample_quality_ = 1;
+  bool audio_latency_probe_ = false;
+  bool live_preview_ = false;
 };
 }  // namespace crossdesk
 #endif
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "config_watcher.h"
+
+#include <algorithm>
+#include <filesystem>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "rd_log.h"
+
+namespace crossdesk {
+
+// writes closer together than this are one change
+constexpr auto kSettleTime = std::chrono::milliseconds(200);
+constexpr auto kPollInterval = std::chrono::milliseconds(1000);
+
+ConfigWatcher::ConfigWatcher(const std::string& file_path,
+                             std::function<void()> on_change)
+    : file_path_(file_path), on_change_(std::move(on_change)) {}
+
+ConfigWatcher::~ConfigWatcher() { Stop(); }
+
+int ConfigWatcher::Start() {
+  if (thread_.joinable()) {
+    return 0;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exit_ = false;
+  }
+#if defined(__linux__)
+  wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (wake_fd_ < 0) {
+    LOG_WARN("eventfd unavailable, polling [{}] instead", file_path_);
+    thread_ = std::thread(&ConfigWatcher::PollLoop, this);
+  } else {
+    thread_ = std::thread(&ConfigWatcher::WatchLoop, this);
+  }
+#else
+  thread_ = std::thread(&ConfigWatcher::PollLoop, this);
+#endif
+  LOG_INFO("Watching config file [{}]", file_path_);
+  return 0;
+}
+
+void ConfigWatcher::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exit_ = true;
+  }
+  exit_cv_.notify_all();
+#if defined(__linux__)
+  if (wake_fd_ >= 0) {
+    uint64_t one = 1;
+    if (write(wake_fd_, &one, sizeof(one)) < 0) {
+      LOG_ERROR("Failed to wake config watcher");
+    }
+  }
+#endif
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+#if defined(__linux__)
+  if (wake_fd_ >= 0) {
+    close(wake_fd_);
+    wake_fd_ = -1;
+  }
+#endif
+}
+
+bool ConfigWatcher::WaitFor(std::chrono::milliseconds timeout) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  return !exit_cv_.wait_for(lock, timeout, [this]() { return exit_; });
+}
+
+void ConfigWatcher::WatchLoop() {
+#if defined(__linux__)
+  std::filesystem::path path(file_path_);
+  std::string dir = path.parent_path().string();
+  std::string file_name = path.filename().string();
+  if (dir.empty()) {
+    dir = ".";
+  }
+
+  int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd < 0 || inotify_add_watch(fd, dir.c_str(),
+                                  IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+    LOG_WARN("inotify unavailable for [{}], polling instead", dir);
+    if (fd >= 0) {
+      close(fd);
+    }
+    PollLoop();
+    return;
+  }
+
+  bool pending = false;
+  auto last_event = std::chrono::steady_clock::now();
+  while (true) {
+    // sleep until an event or Stop, or until a pending change settles
+    int timeout_ms = -1;
+    if (pending) {
+      auto left = kSettleTime - (std::chrono::steady_clock::now() - last_event);
+      timeout_ms = (int)std::max<int64_t>(
+          0, std::chrono::ceil<std::chrono::milliseconds>(left).count());
+    }
+
+    pollfd pfds[2] = {{fd, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+    int ret = poll(pfds, 2, timeout_ms);
+    if (pfds[1].revents & POLLIN) {
+      break;
+    }
+    if (ret > 0 && (pfds[0].revents & POLLIN)) {
+      alignas(inotify_event) char buffer[4096];
+      ssize_t len;
+      while ((len = read(fd, buffer, sizeof(buffer))) > 0) {
+        for (char* p = buffer; p < buffer + len;) {
+          const inotify_event* event = (const inotify_event*)p;
+          if (event->len > 0 && file_name == event->name) {
+            pending = true;
+            last_event = std::chrono::steady_clock::now();
+          }
+          p += sizeof(inotify_event) + event->len;
+        }
+      }
+    }
+
+    if (pending &&
+        std::chrono::steady_clock::now() - last_event >= kSettleTime) {
+      pending = false;
+      on_change_();
+    }
+  }
+
+  close(fd);
+#endif
+}
+
+void ConfigWatcher::PollLoop() {
+  std::error_code ec;
+  auto last_write = std::filesystem::last_write_time(file_path_, ec);
+  while (WaitFor(kPollInterval)) {
+    auto write_time = std::filesystem::last_write_time(file_path_, ec);
+    if (ec || write_time == last_write) {
+      continue;
+    }
+    // let the writer finish
+    if (!WaitFor(kSettleTime)) {
+      break;
+    }
+    last_write = std::filesystem::last_write_time(file_path_, ec);
+    on_change_();
+  }
+}
+}  // namespace crossdesk
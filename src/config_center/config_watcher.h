@@ -0,0 +1,52 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _CONFIG_WATCHER_H_
+#define _CONFIG_WATCHER_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace crossdesk {
+
+// Reports changes to one file from a thread of its own. On Linux the
+// directory is watched with inotify, so editors that save by rename are
+// seen too, elsewhere the modification time is polled. A burst of writes
+// is reported once the file has been quiet for a moment.
+class ConfigWatcher {
+ public:
+  // |on_change| runs on the watcher thread
+  ConfigWatcher(const std::string& file_path, std::function<void()> on_change);
+  ~ConfigWatcher();
+
+ public:
+  int Start();
+  void Stop();
+
+ private:
+  void WatchLoop();
+  void PollLoop();
+  // false once Stop was called
+  bool WaitFor(std::chrono::milliseconds timeout);
+
+ private:
+  const std::string file_path_;
+  std::function<void()> on_change_;
+
+  std::mutex mutex_;
+  std::condition_variable exit_cv_;
+  bool exit_ = false;
+  // eventfd Stop writes to, wakes the inotify poll
+  int wake_fd_ = -1;
+  std::thread thread_;
+};
+}  // namespace crossdesk
+#endif
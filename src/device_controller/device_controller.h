@@ -7,6 +7,7 @@
 #ifndef _DEVICE_CONTROLLER_H_
 #define _DEVICE_CONTROLLER_H_
 
+#include <stdint.h>
 #include <stdio.h>
 
 #include "display_info.h"
@@ -19,6 +20,13 @@ typedef enum {
   audio_capture,
   host_infomation,
   display_id,
+  text_input,
+  input_ack,
+  cursor_info,
+  data_fragment,
+  audio_silence,
+  audio_timing,
+  audio_probe,
 } ControlType;
 typedef enum {
   move = 0,
@@ -32,6 +40,20 @@ typedef enum {
   wheel_horizontal
 } MouseFlag;
 typedef enum { key_down = 0, key_up } KeyFlag;
+typedef enum {
+  cursor_arrow = 0,
+  cursor_ibeam,
+  cursor_hand,
+  cursor_wait,
+  cursor_crosshair,
+  cursor_size_all,
+  cursor_size_ns,
+  cursor_size_we,
+  cursor_size_nwse,
+  cursor_size_nesw,
+  cursor_not_allowed,
+  cursor_hidden
+} CursorStyle;
 typedef struct {
   float x;
   float y;
@@ -55,15 +77,41 @@ typedef struct {
   int* bottom;
 } HostInfo;
 
+// UTF-8 text run, injected as characters rather than key strokes
+typedef struct {
+  char* text;
+  size_t text_size;
+} TextInput;
+
+// host reply to a tagged mouse/keyboard action once it has been injected
+typedef struct {
+  uint32_t seq;
+  int64_t input_timestamp;
+  int64_t inject_timestamp;
+} InputAck;
+
+// host cursor, position normalized to the captured display
+typedef struct {
+  float x;
+  float y;
+  CursorStyle style;
+} CursorInfo;
+
 typedef struct {
   ControlType type;
   union {
     Mouse m;
     Key k;
     HostInfo i;
+    TextInput t;
+    InputAck ack;
+    CursorInfo c;
     bool a;
     int d;
   };
+  // latency probe for mouse/keyboard actions, seq 0 means untagged
+  uint32_t seq;
+  int64_t timestamp;
 } RemoteAction;
 
 // int key_code, bool is_down
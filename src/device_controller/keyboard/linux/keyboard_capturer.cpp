@@ -1,5 +1,7 @@
 #include "keyboard_capturer.h"
 
+#include <thread>
+
 #include "keyboard_converter.h"
 #include "rd_log.h"
 
@@ -8,13 +10,41 @@ namespace crossdesk {
 static OnKeyAction g_on_key_action = nullptr;
 static void* g_user_ptr = nullptr;
 
-static int KeyboardEventHandler(Display* display, XEvent* event) {
-  if (event->xkey.type == KeyPress || event->xkey.type == KeyRelease) {
-    KeySym keySym = XKeycodeToKeysym(display, event->xkey.keycode, 0);
-    int key_code = XKeysymToKeycode(display, keySym);
+// upper bound of keycodes borrowed at once for text input
+constexpr size_t kMaxTextInputKeyCodes = 16;
+// XSync only means the server queued the fake keys, the focused client
+// translates them with the keymap it holds later on
+constexpr auto kTextKeysSettleTime = std::chrono::milliseconds(50);
+
+static KeySym CodePointToKeySym(uint32_t code_point) {
+  if (code_point == '\n' || code_point == '\r') {
+    return XK_Return;
+  } else if (code_point == '\t') {
+    return XK_Tab;
+  } else if (code_point < 0x20 || code_point == 0x7F) {
+    return NoSymbol;
+  } else if (code_point < 0x100) {
+    // Latin-1 keysyms equal their code points
+    return code_point;
+  }
+  return 0x01000000 | code_point;
+}
+
+static int KeyboardEventHandler(KeyboardCapturer* keyboard_capturer,
+                                XEvent* event) {
+  if (event->type == MappingNotify) {
+    keyboard_capturer->OnMappingNotify(&event->xmapping);
+  } else if (event->xkey.type == KeyPress || event->xkey.type == KeyRelease) {
+    KeySym key_sym = XLookupKeysym(&event->xkey, 0);
+    // the vkCode table only knows upper case letters
+    if (key_sym >= XK_a && key_sym <= XK_z) {
+      key_sym -= XK_a - XK_A;
+    }
+    int key_code =
+        LookupKeyCode(x11KeySymToVkCode, X11KeySymToIndex((int)key_sym));
     bool is_key_down = (event->xkey.type == KeyPress);
 
-    if (g_on_key_action) {
+    if (g_on_key_action && key_code != kInvalidKeyCode) {
       g_on_key_action(key_code, is_key_down, g_user_ptr);
     }
   }
@@ -25,11 +55,22 @@ KeyboardCapturer::KeyboardCapturer() : display_(nullptr), running_(true) {
   display_ = XOpenDisplay(nullptr);
   if (!display_) {
     LOG_ERROR("Failed to open X display.");
+    return;
   }
+
+  RebuildKeyCodeCache();
 }
 
 KeyboardCapturer::~KeyboardCapturer() {
   if (display_) {
+    if (!text_key_codes_.empty()) {
+      WaitForTextKeys();
+      KeySym no_symbol[2] = {NoSymbol, NoSymbol};
+      for (KeyCode key_code : text_key_codes_) {
+        XChangeKeyboardMapping(display_, key_code, 2, no_symbol, 1);
+      }
+      XSync(display_, False);
+    }
     XCloseDisplay(display_);
   }
 }
@@ -44,7 +85,7 @@ int KeyboardCapturer::Hook(OnKeyAction on_key_action, void* user_ptr) {
   while (running_) {
     XEvent event;
     XNextEvent(display_, &event);
-    KeyboardEventHandler(display_, &event);
+    KeyboardEventHandler(this, &event);
   }
 
   return 0;
@@ -61,12 +102,168 @@ int KeyboardCapturer::SendKeyboardCommand(int key_code, bool is_down) {
     return -1;
   }
 
-  if (vkCodeToX11KeySym.find(key_code) != vkCodeToX11KeySym.end()) {
-    int x11_key_code = vkCodeToX11KeySym[key_code];
-    KeyCode keycode = XKeysymToKeycode(display_, x11_key_code);
-    XTestFakeKeyEvent(display_, keycode, is_down, CurrentTime);
+  // MappingNotify is delivered to every client, pick it up from the local
+  // queue without blocking so the cache follows layout changes
+  XEvent event;
+  while (XCheckTypedEvent(display_, MappingNotify, &event)) {
+    OnMappingNotify(&event.xmapping);
+  }
+
+  if (key_code < 0 || key_code >= (int)vk_code_to_x11_key_code_.size()) {
+    return -1;
+  }
+
+  KeyCode x11_key_code = vk_code_to_x11_key_code_[key_code];
+  if (0 != x11_key_code) {
+    XTestFakeKeyEvent(display_, x11_key_code, is_down, CurrentTime);
     XFlush(display_);
   }
   return 0;
 }
-}  // namespace crossdesk
\ No newline at end of file
+
+int KeyboardCapturer::SendTextCommand(const char* text, size_t text_size) {
+  if (!display_) {
+    LOG_ERROR("Display not initialized.");
+    return -1;
+  }
+
+  std::vector<KeySym> key_syms;
+  std::vector<uint32_t> code_points = Utf8ToCodePoints(text, text_size);
+  key_syms.reserve(code_points.size());
+  for (size_t i = 0; i < code_points.size(); ++i) {
+    // treat CRLF as a single line break
+    if (code_points[i] == '\n' && i > 0 && code_points[i - 1] == '\r') {
+      continue;
+    }
+    KeySym key_sym = CodePointToKeySym(code_points[i]);
+    if (key_sym != NoSymbol) {
+      key_syms.push_back(key_sym);
+    }
+  }
+
+  if (text_key_codes_.empty()) {
+    // once mapped they are no longer spare, so they are looked up only once
+    text_key_codes_ = FindSpareKeyCodes();
+    text_key_syms_.assign(text_key_codes_.size(), NoSymbol);
+  }
+  if (text_key_codes_.empty()) {
+    LOG_ERROR("No spare keycode available for text input");
+    return -1;
+  }
+
+  // Type as many characters as the borrowed keycodes can hold at once.
+  // Keysyms still bound from earlier batches or calls are reused, the
+  // other slots are remapped only after the client caught up with them.
+  size_t slots = text_key_codes_.size();
+  size_t batch_begin = 0;
+  while (batch_begin < key_syms.size()) {
+    std::vector<bool> used(slots, false);
+    std::vector<std::pair<size_t, KeySym>> remaps;
+    std::vector<KeyCode> batch_key_codes;
+    size_t batch_end = batch_begin;
+    for (; batch_end < key_syms.size(); ++batch_end) {
+      KeySym key_sym = key_syms[batch_end];
+      size_t slot = 0;
+      while (slot < slots && text_key_syms_[slot] != key_sym) {
+        ++slot;
+      }
+      if (slot == slots) {
+        slot = 0;
+        while (slot < slots && used[slot]) {
+          ++slot;
+        }
+        if (slot == slots) {
+          break;
+        }
+        remaps.emplace_back(slot, key_sym);
+        text_key_syms_[slot] = key_sym;
+      }
+      used[slot] = true;
+      batch_key_codes.push_back(text_key_codes_[slot]);
+    }
+
+    if (!remaps.empty()) {
+      WaitForTextKeys();
+      for (const auto& [slot, key_sym] : remaps) {
+        // same keysym on both levels so shift state does not matter
+        KeySym level_syms[2] = {key_sym, key_sym};
+        XChangeKeyboardMapping(display_, text_key_codes_[slot], 2, level_syms,
+                               1);
+      }
+      XSync(display_, False);
+    }
+
+    for (KeyCode key_code : batch_key_codes) {
+      XTestFakeKeyEvent(display_, key_code, True, CurrentTime);
+      XTestFakeKeyEvent(display_, key_code, False, CurrentTime);
+    }
+    XSync(display_, False);
+    last_text_keys_time_ = std::chrono::steady_clock::now();
+
+    batch_begin = batch_end;
+  }
+
+  return 0;
+}
+
+void KeyboardCapturer::WaitForTextKeys() {
+  auto elapsed = std::chrono::steady_clock::now() - last_text_keys_time_;
+  if (elapsed < kTextKeysSettleTime) {
+    std::this_thread::sleep_for(kTextKeysSettleTime - elapsed);
+  }
+}
+
+std::vector<KeyCode> KeyboardCapturer::FindSpareKeyCodes() {
+  std::vector<KeyCode> spare_key_codes;
+  int min_key_code = 0;
+  int max_key_code = 0;
+  int key_syms_per_key_code = 0;
+  XDisplayKeycodes(display_, &min_key_code, &max_key_code);
+  KeySym* key_syms =
+      XGetKeyboardMapping(display_, (KeyCode)min_key_code,
+                          max_key_code - min_key_code + 1,
+                          &key_syms_per_key_code);
+  if (!key_syms) {
+    return spare_key_codes;
+  }
+
+  for (int key_code = max_key_code; key_code >= min_key_code; --key_code) {
+    const KeySym* syms =
+        key_syms + (key_code - min_key_code) * key_syms_per_key_code;
+    bool is_spare = true;
+    for (int i = 0; i < key_syms_per_key_code; ++i) {
+      if (syms[i] != NoSymbol) {
+        is_spare = false;
+        break;
+      }
+    }
+    if (is_spare) {
+      spare_key_codes.push_back((KeyCode)key_code);
+      if (spare_key_codes.size() == kMaxTextInputKeyCodes) {
+        break;
+      }
+    }
+  }
+  XFree(key_syms);
+
+  return spare_key_codes;
+}
+
+void KeyboardCapturer::OnMappingNotify(XMappingEvent* event) {
+  XRefreshKeyboardMapping(event);
+  if (event->request == MappingKeyboard || event->request == MappingModifier) {
+    RebuildKeyCodeCache();
+  }
+}
+
+void KeyboardCapturer::RebuildKeyCodeCache() {
+  vk_code_to_x11_key_code_.fill(0);
+  for (size_t vk_code = 0; vk_code < vkCodeToX11KeySym.size(); ++vk_code) {
+    int key_sym = vkCodeToX11KeySym[vk_code];
+    if (key_sym != kInvalidKeyCode) {
+      vk_code_to_x11_key_code_[vk_code] =
+          XKeysymToKeycode(display_, (KeySym)key_sym);
+    }
+  }
+}
+}  // namespace crossdesk
@@ -11,6 +11,10 @@
 #include <X11/extensions/XTest.h>
 #include <X11/keysym.h>
 
+#include <array>
+#include <chrono>
+#include <vector>
+
 #include "device_controller.h"
 
 namespace crossdesk {
@@ -24,11 +28,28 @@ class KeyboardCapturer : public DeviceController {
   virtual int Hook(OnKeyAction on_key_action, void* user_ptr);
   virtual int Unhook();
   virtual int SendKeyboardCommand(int key_code, bool is_down);
+  virtual int SendTextCommand(const char* text, size_t text_size);
+
+  void OnMappingNotify(XMappingEvent* event);
+
+ private:
+  void RebuildKeyCodeCache();
+  std::vector<KeyCode> FindSpareKeyCodes();
+  // blocks until clients had time to translate the last text keys
+  void WaitForTextKeys();
 
  private:
   Display* display_;
   Window root_;
   bool running_;
+  // vkCode -> X11 KeyCode, rebuilt on MappingNotify
+  std::array<KeyCode, 256> vk_code_to_x11_key_code_{};
+  // keycodes borrowed for text input and the keysym bound to each. A
+  // binding stays until a later character needs its slot, so the focused
+  // client never translates a key after it was remapped.
+  std::vector<KeyCode> text_key_codes_;
+  std::vector<KeySym> text_key_syms_;
+  std::chrono::steady_clock::time_point last_text_keys_time_;
 };
 }  // namespace crossdesk
 #endif
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include "keyboard_capturer.h"
 
+#include <vector>
+
 #include "keyboard_converter.h"
 #include "rd_log.h"
 
@@ -21,23 +23,27 @@ CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type,
   if (type == kCGEventKeyDown || type == kCGEventKeyUp) {
     CGKeyCode key_code = static_cast<CGKeyCode>(
         CGEventGetIntegerValueField(event, kCGKeyboardEventKeycode));
-    if (CGKeyCodeToVkCode.find(key_code) != CGKeyCodeToVkCode.end()) {
-      g_on_key_action(CGKeyCodeToVkCode[key_code], type == kCGEventKeyDown,
-                      g_user_ptr);
+    vk_code = LookupKeyCode(CGKeyCodeToVkCode, key_code);
+    if (vk_code != kInvalidKeyCode) {
+      g_on_key_action(vk_code, type == kCGEventKeyDown, g_user_ptr);
     }
   } else if (type == kCGEventFlagsChanged) {
     CGEventFlags current_flags = CGEventGetFlags(event);
     CGKeyCode key_code = static_cast<CGKeyCode>(
         CGEventGetIntegerValueField(event, kCGKeyboardEventKeycode));
+    vk_code = LookupKeyCode(CGKeyCodeToVkCode, key_code);
+    if (vk_code == kInvalidKeyCode) {
+      vk_code = 0;
+    }
 
     // caps lock
     bool caps_lock_state = (current_flags & kCGEventFlagMaskAlphaShift) != 0;
     if (caps_lock_state != keyboard_capturer->caps_lock_flag_) {
       keyboard_capturer->caps_lock_flag_ = caps_lock_state;
       if (keyboard_capturer->caps_lock_flag_) {
-        g_on_key_action(CGKeyCodeToVkCode[key_code], true, g_user_ptr);
+        g_on_key_action(vk_code, true, g_user_ptr);
       } else {
-        g_on_key_action(CGKeyCodeToVkCode[key_code], false, g_user_ptr);
+        g_on_key_action(vk_code, false, g_user_ptr);
       }
     }
 
@@ -46,9 +52,9 @@ CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type,
     if (shift_state != keyboard_capturer->shift_flag_) {
       keyboard_capturer->shift_flag_ = shift_state;
       if (keyboard_capturer->shift_flag_) {
-        g_on_key_action(CGKeyCodeToVkCode[key_code], true, g_user_ptr);
+        g_on_key_action(vk_code, true, g_user_ptr);
       } else {
-        g_on_key_action(CGKeyCodeToVkCode[key_code], false, g_user_ptr);
+        g_on_key_action(vk_code, false, g_user_ptr);
       }
     }
 
@@ -57,9 +63,9 @@ CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type,
     if (control_state != keyboard_capturer->control_flag_) {
       keyboard_capturer->control_flag_ = control_state;
       if (keyboard_capturer->control_flag_) {
-        g_on_key_action(CGKeyCodeToVkCode[key_code], true, g_user_ptr);
+        g_on_key_action(vk_code, true, g_user_ptr);
       } else {
-        g_on_key_action(CGKeyCodeToVkCode[key_code], false, g_user_ptr);
+        g_on_key_action(vk_code, false, g_user_ptr);
       }
     }
 
@@ -68,9 +74,9 @@ CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type,
     if (option_state != keyboard_capturer->option_flag_) {
       keyboard_capturer->option_flag_ = option_state;
       if (keyboard_capturer->option_flag_) {
-        g_on_key_action(CGKeyCodeToVkCode[key_code], true, g_user_ptr);
+        g_on_key_action(vk_code, true, g_user_ptr);
       } else {
-        g_on_key_action(CGKeyCodeToVkCode[key_code], false, g_user_ptr);
+        g_on_key_action(vk_code, false, g_user_ptr);
       }
     }
 
@@ -79,9 +85,9 @@ CGEventRef eventCallback(CGEventTapProxy proxy, CGEventType type,
     if (command_state != keyboard_capturer->command_flag_) {
       keyboard_capturer->command_flag_ = command_state;
       if (keyboard_capturer->command_flag_) {
-        g_on_key_action(CGKeyCodeToVkCode[key_code], true, g_user_ptr);
+        g_on_key_action(vk_code, true, g_user_ptr);
       } else {
-        g_on_key_action(CGKeyCodeToVkCode[key_code], false, g_user_ptr);
+        g_on_key_action(vk_code, false, g_user_ptr);
       }
     }
   }
@@ -146,8 +152,9 @@ inline bool IsFunctionKey(int key_code) {
 }
 
 int KeyboardCapturer::SendKeyboardCommand(int key_code, bool is_down) {
-  if (vkCodeToCGKeyCode.find(key_code) != vkCodeToCGKeyCode.end()) {
-    CGKeyCode cg_key_code = vkCodeToCGKeyCode[key_code];
+  int mapped_key_code = LookupKeyCode(vkCodeToCGKeyCode, key_code);
+  if (mapped_key_code != kInvalidKeyCode) {
+    CGKeyCode cg_key_code = (CGKeyCode)mapped_key_code;
     CGEventRef event = CGEventCreateKeyboardEvent(NULL, cg_key_code, is_down);
     CGEventRef clearFlags =
         CGEventCreateKeyboardEvent(NULL, (CGKeyCode)0, true);
@@ -167,4 +174,70 @@ int KeyboardCapturer::SendKeyboardCommand(int key_code, bool is_down) {
 
   return 0;
 }
+
+// type a UTF-8 run as unicode characters, independent of the keyboard layout
+int KeyboardCapturer::SendTextCommand(const char* text, size_t text_size) {
+  // CGEventKeyboardSetUnicodeString silently truncates long strings
+  constexpr size_t kMaxUnicharsPerEvent = 20;
+  constexpr CGKeyCode kReturnKeyCode = 0x24;
+  constexpr CGKeyCode kTabKeyCode = 0x30;
+
+  std::vector<uint16_t> utf16_units = Utf8ToUtf16(text, text_size);
+  std::vector<UniChar> chunk;
+  chunk.reserve(kMaxUnicharsPerEvent);
+
+  auto flush_chunk = [&chunk]() {
+    if (chunk.empty()) {
+      return;
+    }
+    CGEventRef key_down = CGEventCreateKeyboardEvent(NULL, 0, true);
+    CGEventRef key_up = CGEventCreateKeyboardEvent(NULL, 0, false);
+    CGEventSetFlags(key_down, 0);
+    CGEventSetFlags(key_up, 0);
+    CGEventKeyboardSetUnicodeString(key_down, chunk.size(), chunk.data());
+    CGEventKeyboardSetUnicodeString(key_up, chunk.size(), chunk.data());
+    CGEventPost(kCGHIDEventTap, key_down);
+    CGEventPost(kCGHIDEventTap, key_up);
+    CFRelease(key_down);
+    CFRelease(key_up);
+    chunk.clear();
+  };
+
+  for (size_t i = 0; i < utf16_units.size(); ++i) {
+    uint16_t unit = utf16_units[i];
+    // treat CRLF as a single line break
+    if (unit == '\n' && i > 0 && utf16_units[i - 1] == '\r') {
+      continue;
+    }
+
+    if (unit == '\n' || unit == '\r' || unit == '\t') {
+      flush_chunk();
+      CGKeyCode key_code = (unit == '\t') ? kTabKeyCode : kReturnKeyCode;
+      CGEventRef key_down = CGEventCreateKeyboardEvent(NULL, key_code, true);
+      CGEventRef key_up = CGEventCreateKeyboardEvent(NULL, key_code, false);
+      CGEventSetFlags(key_down, 0);
+      CGEventSetFlags(key_up, 0);
+      CGEventPost(kCGHIDEventTap, key_down);
+      CGEventPost(kCGHIDEventTap, key_up);
+      CFRelease(key_down);
+      CFRelease(key_up);
+      continue;
+    } else if (unit < 0x20 || unit == 0x7F) {
+      continue;
+    }
+
+    // never split a surrogate pair across two events
+    bool is_high_surrogate = unit >= 0xD800 && unit <= 0xDBFF;
+    if (chunk.size() + (is_high_surrogate ? 2 : 1) > kMaxUnicharsPerEvent) {
+      flush_chunk();
+    }
+    chunk.push_back(unit);
+    if (is_high_surrogate && i + 1 < utf16_units.size()) {
+      chunk.push_back(utf16_units[++i]);
+    }
+  }
+  flush_chunk();
+
+  return 0;
+}
 }  // namespace crossdesk
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "keyboard_capturer.h"
 
+#include <vector>
+
+#include "keyboard_converter.h"
 #include "rd_log.h"
 
 namespace crossdesk {
@@ -56,4 +59,45 @@ int KeyboardCapturer::SendKeyboardCommand(int key_code, bool is_down) {
 
   return 0;
 }
+
+// type a UTF-8 run as unicode characters, independent of the keyboard layout
+int KeyboardCapturer::SendTextCommand(const char* text, size_t text_size) {
+  std::vector<uint16_t> utf16_units = Utf8ToUtf16(text, text_size);
+  std::vector<INPUT> inputs;
+  inputs.reserve(utf16_units.size() * 2);
+
+  for (size_t i = 0; i < utf16_units.size(); ++i) {
+    uint16_t unit = utf16_units[i];
+    // treat CRLF as a single line break
+    if (unit == '\n' && i > 0 && utf16_units[i - 1] == '\r') {
+      continue;
+    }
+
+    INPUT input = {0};
+    input.type = INPUT_KEYBOARD;
+    if (unit == '\n' || unit == '\r' || unit == '\t') {
+      input.ki.wVk = (unit == '\t') ? VK_TAB : VK_RETURN;
+    } else if (unit < 0x20 || unit == 0x7F) {
+      continue;
+    } else {
+      input.ki.wScan = unit;
+      input.ki.dwFlags = KEYEVENTF_UNICODE;
+    }
+    inputs.push_back(input);
+    input.ki.dwFlags |= KEYEVENTF_KEYUP;
+    inputs.push_back(input);
+  }
+
+  if (inputs.empty()) {
+    return 0;
+  }
+
+  UINT sent = SendInput((UINT)inputs.size(), inputs.data(), sizeof(INPUT));
+  if (sent != inputs.size()) {
+    LOG_ERROR("SendInput injected [{}/{}] text events", sent, inputs.size());
+    return -1;
+  }
+
+  return 0;
+}
 }  // namespace crossdesk
\ No newline at end of file
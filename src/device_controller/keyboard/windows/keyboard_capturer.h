@@ -22,6 +22,7 @@ class KeyboardCapturer : public DeviceController {
   virtual int Hook(OnKeyAction on_key_action, void* user_ptr);
   virtual int Unhook();
   virtual int SendKeyboardCommand(int key_code, bool is_down);
+  virtual int SendTextCommand(const char* text, size_t text_size);
 
  private:
   HHOOK keyboard_hook_ = nullptr;
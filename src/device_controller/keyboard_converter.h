@@ -7,12 +7,22 @@
 #ifndef _KEYBOARD_CONVERTER_H_
 #define _KEYBOARD_CONVERTER_H_
 
-#include <map>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
 
 namespace crossdesk {
 
+struct KeyCodePair {
+  int from;
+  int to;
+};
+
+constexpr int kInvalidKeyCode = -1;
+
 // Windows vkCode to macOS CGKeyCode (104 keys)
-std::map<int, int> vkCodeToCGKeyCode = {
+inline constexpr KeyCodePair kVkCodeToCGKeyCodePairs[] = {
     // A-Z
     {0x41, 0x00},  // A
     {0x42, 0x0B},  // B
@@ -129,126 +139,8 @@ std::map<int, int> vkCodeToCGKeyCode = {
     {0x5C, 0x36},  // Right Command
 };
 
-// macOS CGKeyCode to Windows vkCode
-std::map<int, int> CGKeyCodeToVkCode = {
-    // A-Z
-    {0x00, 0x41},  // A
-    {0x0B, 0x42},  // B
-    {0x08, 0x43},  // C
-    {0x02, 0x44},  // D
-    {0x0E, 0x45},  // E
-    {0x03, 0x46},  // F
-    {0x05, 0x47},  // G
-    {0x04, 0x48},  // H
-    {0x22, 0x49},  // I
-    {0x26, 0x4A},  // J
-    {0x28, 0x4B},  // K
-    {0x25, 0x4C},  // L
-    {0x2E, 0x4D},  // M
-    {0x2D, 0x4E},  // N
-    {0x1F, 0x4F},  // O
-    {0x23, 0x50},  // P
-    {0x0C, 0x51},  // Q
-    {0x0F, 0x52},  // R
-    {0x01, 0x53},  // S
-    {0x11, 0x54},  // T
-    {0x20, 0x55},  // U
-    {0x09, 0x56},  // V
-    {0x0D, 0x57},  // W
-    {0x07, 0x58},  // X
-    {0x10, 0x59},  // Y
-    {0x06, 0x5A},  // Z
-
-    // 0-9
-    {0x1D, 0x30},  // 0
-    {0x12, 0x31},  // 1
-    {0x13, 0x32},  // 2
-    {0x14, 0x33},  // 3
-    {0x15, 0x34},  // 4
-    {0x17, 0x35},  // 5
-    {0x16, 0x36},  // 6
-    {0x1A, 0x37},  // 7
-    {0x1C, 0x38},  // 8
-    {0x19, 0x39},  // 9
-
-    // F1-F12
-    {0x7A, 0x70},  // F1
-    {0x78, 0x71},  // F2
-    {0x63, 0x72},  // F3
-    {0x76, 0x73},  // F4
-    {0x60, 0x74},  // F5
-    {0x61, 0x75},  // F6
-    {0x62, 0x76},  // F7
-    {0x64, 0x77},  // F8
-    {0x65, 0x78},  // F9
-    {0x6D, 0x79},  // F10
-    {0x67, 0x7A},  // F11
-    {0x6F, 0x7B},  // F12
-
-    // control keys
-    {0x35, 0x1B},  // Escape
-    {0x24, 0x0D},  // Enter
-    {0x31, 0x20},  // Space
-    {0x33, 0x08},  // Backspace
-    {0x30, 0x09},  // Tab
-    {0x74, 0x2C},  // Print Screen
-    {0x72, 0x2D},  // Insert
-    {0x75, 0x2E},  // Delete
-    {0x73, 0x24},  // Home
-    {0x77, 0x23},  // End
-    {0x79, 0x21},  // Page Up
-    {0x7A, 0x22},  // Page Down
-
-    // arrow keys
-    {0x7B, 0x25},  // Left Arrow
-    {0x7C, 0x27},  // Right Arrow
-    {0x7E, 0x26},  // Up Arrow
-    {0x7D, 0x28},  // Down Arrow
-
-    // numpad
-    {0x52, 0x60},  // Numpad 0
-    {0x53, 0x61},  // Numpad 1
-    {0x54, 0x62},  // Numpad 2
-    {0x55, 0x63},  // Numpad 3
-    {0x56, 0x64},  // Numpad 4
-    {0x57, 0x65},  // Numpad 5
-    {0x58, 0x66},  // Numpad 6
-    {0x59, 0x67},  // Numpad 7
-    {0x5B, 0x68},  // Numpad 8
-    {0x5C, 0x69},  // Numpad 9
-    {0x41, 0x6E},  // Numpad .
-    {0x4B, 0x6F},  // Numpad /
-    {0x43, 0x6A},  // Numpad *
-    {0x4E, 0x6D},  // Numpad -
-    {0x45, 0x6B},  // Numpad +
-
-    // symbol keys
-    {0x29, 0xBA},  // ; (Semicolon)
-    {0x27, 0xDE},  // ' (Quote)
-    {0x32, 0xC0},  // ` (Backtick)
-    {0x2B, 0xBC},  // , (Comma)
-    {0x2F, 0xBE},  // . (Period)
-    {0x2C, 0xBF},  // / (Slash)
-    {0x2A, 0xDC},  // \ (Backslash)
-    {0x21, 0xDB},  // [ (Left Bracket)
-    {0x1E, 0xDD},  // ] (Right Bracket)
-    {0x1B, 0xBD},  // - (Minus)
-    {0x18, 0xBB},  // = (Equals)
-
-    // modifier keys
-    {0x39, 0x14},  // Caps Lock
-    {0x38, 0xA0},  // Shift (Left)
-    {0x3C, 0xA1},  // Shift (Right)
-    {0x3B, 0xA2},  // Control (Left)
-    {0x3E, 0xA3},  // Control (Right)
-    {0x3A, 0xA4},  // Alt (Left)
-    {0x3D, 0xA5},  // Alt (Right)
-    {0x37, 0x5B},  // Left Command (Windows key)
-    {0x36, 0x5C},  // Right Command
-};
-
 // Windows vkCode to X11 KeySym
-std::map<int, int> vkCodeToX11KeySym = {
+inline constexpr KeyCodePair kVkCodeToX11KeySymPairs[] = {
     // A-Z
     {0x41, 0x0041},  // A
     {0x42, 0x0042},  // B
@@ -367,136 +259,8 @@ std::map<int, int> vkCodeToX11KeySym = {
     {0x5C, 0xFFEC},  // Right Command
 };
 
-// X11 KeySym to Windows vkCode
-// std::map<int, int> x11KeySymToVkCode = []() {
-//   std::map<int, int> result;
-//   for (const auto& pair : vkCodeToX11KeySym) {
-//     result[pair.second] = pair.first;
-//   }
-//   return result;
-// }();
-
-std::map<int, int> x11KeySymToVkCode = {
-    // A-Z
-    {0x0041, 0x41},  // A
-    {0x0042, 0x42},  // B
-    {0x0043, 0x43},  // C
-    {0x0044, 0x44},  // D
-    {0x0045, 0x45},  // E
-    {0x0046, 0x46},  // F
-    {0x0047, 0x47},  // G
-    {0x0048, 0x48},  // H
-    {0x0049, 0x49},  // I
-    {0x004A, 0x4A},  // J
-    {0x004B, 0x4B},  // K
-    {0x004C, 0x4C},  // L
-    {0x004D, 0x4D},  // M
-    {0x004E, 0x4E},  // N
-    {0x004F, 0x4F},  // O
-    {0x0050, 0x50},  // P
-    {0x0051, 0x51},  // Q
-    {0x0052, 0x52},  // R
-    {0x0053, 0x53},  // S
-    {0x0054, 0x54},  // T
-    {0x0055, 0x55},  // U
-    {0x0056, 0x56},  // V
-    {0x0057, 0x57},  // W
-    {0x0058, 0x58},  // X
-    {0x0059, 0x59},  // Y
-    {0x005A, 0x5A},  // Z
-
-    // 0-9
-    {0x0030, 0x30},  // 0
-    {0x0031, 0x31},  // 1
-    {0x0032, 0x32},  // 2
-    {0x0033, 0x33},  // 3
-    {0x0034, 0x34},  // 4
-    {0x0035, 0x35},  // 5
-    {0x0036, 0x36},  // 6
-    {0x0037, 0x37},  // 7
-    {0x0038, 0x38},  // 8
-    {0x0039, 0x39},  // 9
-
-    // F1-F12
-    {0xFFBE, 0x70},  // F1
-    {0xFFBF, 0x71},  // F2
-    {0xFFC0, 0x72},  // F3
-    {0xFFC1, 0x73},  // F4
-    {0xFFC2, 0x74},  // F5
-    {0xFFC3, 0x75},  // F6
-    {0xFFC4, 0x76},  // F7
-    {0xFFC5, 0x77},  // F8
-    {0xFFC6, 0x78},  // F9
-    {0xFFC7, 0x79},  // F10
-    {0xFFC8, 0x7A},  // F11
-    {0xFFC9, 0x7B},  // F12
-
-    // control keys
-    {0xFF1B, 0x1B},  // Escape
-    {0xFF0D, 0x0D},  // Enter
-    {0x0020, 0x20},  // Space
-    {0xFF08, 0x08},  // Backspace
-    {0xFF09, 0x09},  // Tab
-    {0xFF15, 0x2C},  // Print Screen
-    {0xFF14, 0x91},  // Scroll Lock
-    {0xFF13, 0x13},  // Pause/Break
-    {0xFF63, 0x2D},  // Insert
-    {0xFFFF, 0x2E},  // Delete
-    {0xFF50, 0x24},  // Home
-    {0xFF57, 0x23},  // End
-    {0xFF55, 0x21},  // Page Up
-    {0xFF56, 0x22},  // Page Down
-
-    // arrow keys
-    {0xFF51, 0x25},  // Left Arrow
-    {0xFF53, 0x27},  // Right Arrow
-    {0xFF52, 0x26},  // Up Arrow
-    {0xFF54, 0x28},  // Down Arrow
-
-    // numpad
-    {0x0030, 0x60},  // Numpad 0
-    {0x0031, 0x61},  // Numpad 1
-    {0x0032, 0x62},  // Numpad 2
-    {0x0033, 0x63},  // Numpad 3
-    {0x0034, 0x64},  // Numpad 4
-    {0x0035, 0x65},  // Numpad 5
-    {0x0036, 0x66},  // Numpad 6
-    {0x0037, 0x67},  // Numpad 7
-    {0x0038, 0x68},  // Numpad 8
-    {0x0039, 0x69},  // Numpad 9
-    {0x003A, 0x6E},  // Numpad .
-    {0x002F, 0x6F},  // Numpad /
-    {0x002A, 0x6A},  // Numpad *
-    {0x002D, 0x6D},  // Numpad -
-    {0x002B, 0x6B},  // Numpad +
-
-    // symbol keys
-    {0x003B, 0xBA},  // ; (Semicolon)
-    {0x0027, 0xDE},  // ' (Quote)
-    {0x007E, 0xC0},  // ` (Grave)
-    {0x002C, 0xBC},  // , (Comma)
-    {0x002E, 0xBE},  // . (Period)
-    {0x002F, 0xBF},  // / (Slash)
-    {0x005C, 0xDC},  // \ (Backslash)
-    {0x005B, 0xDB},  // [ (Left Bracket)
-    {0x005D, 0xDD},  // ] (Right Bracket)
-    {0x002D, 0xBD},  // - (Minus)
-    {0x003D, 0xBB},  // = (Equals)
-
-    // modifier keys
-    {0xFFE5, 0x14},  // Caps Lock
-    {0xFFE1, 0xA0},  // Shift (Left)
-    {0xFFE2, 0xA1},  // Shift (Right)
-    {0xFFE3, 0xA2},  // Ctrl (Left)
-    {0xFFE4, 0xA3},  // Ctrl (Right)
-    {0xFFE9, 0xA4},  // Alt (Left)
-    {0xFFEA, 0xA5},  // Alt (Right)
-    {0xFFEB, 0x5B},  // Left Command (Windows key)
-    {0xFFEC, 0x5C},  // Right Command
-};
-
 // macOS CGKeyCode to X11 KeySym
-std::map<int, int> cgKeyCodeToX11KeySym = {
+inline constexpr KeyCodePair kCGKeyCodeToX11KeySymPairs[] = {
     // A-Z
     {0x00, 0x0041},  // A
     {0x0B, 0x0042},  // B
@@ -613,130 +377,142 @@ std::map<int, int> cgKeyCodeToX11KeySym = {
     {0x36, 0xFFEC},  // Right Command
 };
 
-// X11 KeySym to macOS CGKeyCode
-// std::map<int, int> x11KeySymToCgKeyCode = []() {
-//   std::map<int, int> result;
-//   for (const auto& pair : cgKeyCodeToX11KeySym) {
-//     result[pair.second] = pair.first;
-//   }
-//   return result;
-// }();
-
-std::map<int, int> x11KeySymToCgKeyCode = {
-    // A-Z
-    {0x0041, 0x00},  // A
-    {0x0042, 0x0B},  // B
-    {0x0043, 0x08},  // C
-    {0x0044, 0x02},  // D
-    {0x0045, 0x0E},  // E
-    {0x0046, 0x03},  // F
-    {0x0047, 0x05},  // G
-    {0x0048, 0x04},  // H
-    {0x0049, 0x22},  // I
-    {0x004A, 0x26},  // J
-    {0x004B, 0x28},  // K
-    {0x004C, 0x25},  // L
-    {0x004D, 0x2E},  // M
-    {0x004E, 0x2D},  // N
-    {0x004F, 0x1F},  // O
-    {0x0050, 0x23},  // P
-    {0x0051, 0x0C},  // Q
-    {0x0052, 0x0F},  // R
-    {0x0053, 0x01},  // S
-    {0x0054, 0x11},  // T
-    {0x0055, 0x20},  // U
-    {0x0056, 0x09},  // V
-    {0x0057, 0x0D},  // W
-    {0x0058, 0x07},  // X
-    {0x0059, 0x10},  // Y
-    {0x005A, 0x06},  // Z
-
-    // 0-9
-    {0x0030, 0x1D},  // 0
-    {0x0031, 0x12},  // 1
-    {0x0032, 0x13},  // 2
-    {0x0033, 0x14},  // 3
-    {0x0034, 0x15},  // 4
-    {0x0035, 0x17},  // 5
-    {0x0036, 0x16},  // 6
-    {0x0037, 0x1A},  // 7
-    {0x0038, 0x1C},  // 8
-    {0x0039, 0x19},  // 9
-
-    // F1-F12
-    {0xFFBE, 0x7A},  // F1
-    {0xFFBF, 0x78},  // F2
-    {0xFFC0, 0x63},  // F3
-    {0xFFC1, 0x76},  // F4
-    {0xFFC2, 0x60},  // F5
-    {0xFFC3, 0x61},  // F6
-    {0xFFC4, 0x62},  // F7
-    {0xFFC5, 0x64},  // F8
-    {0xFFC6, 0x65},  // F9
-    {0xFFC7, 0x6D},  // F10
-    {0xFFC8, 0x67},  // F11
-    {0xFFC9, 0x6F},  // F12
-
-    // control keys
-    {0xFF1B, 0x35},  // Escape
-    {0xFF0D, 0x24},  // Enter
-    {0x0020, 0x31},  // Space
-    {0xFF08, 0x33},  // Backspace
-    {0xFF09, 0x30},  // Tab
-    {0xFF15, 0x74},  // Print Screen
-    {0xFF63, 0x72},  // Insert
-    {0xFFFF, 0x75},  // Delete
-    {0xFF50, 0x73},  // Home
-    {0xFF57, 0x77},  // End
-    {0xFF55, 0x79},  // Page Up
-    {0xFF56, 0x7A},  // Page Down
-
-    // arrow keys
-    {0xFF51, 0x7B},  // Left Arrow
-    {0xFF53, 0x7C},  // Right Arrow
-    {0xFF52, 0x7E},  // Up Arrow
-    {0xFF54, 0x7D},  // Down Arrow
-
-    // numpad
-    {0x0030, 0x52},  // Numpad 0
-    {0x0031, 0x53},  // Numpad 1
-    {0x0032, 0x54},  // Numpad 2
-    {0x0033, 0x55},  // Numpad 3
-    {0x0034, 0x56},  // Numpad 4
-    {0x0035, 0x57},  // Numpad 5
-    {0x0036, 0x58},  // Numpad 6
-    {0x0037, 0x59},  // Numpad 7
-    {0x0038, 0x5B},  // Numpad 8
-    {0x0039, 0x5C},  // Numpad 9
-    {0x003A, 0x41},  // Numpad .
-    {0x002F, 0x4B},  // Numpad /
-    {0x002A, 0x43},  // Numpad *
-    {0x002D, 0x4E},  // Numpad -
-    {0x002B, 0x45},  // Numpad +
-
-    // symbol keys
-    {0x003B, 0x29},  // ; (Semicolon)
-    {0x0027, 0x27},  // ' (Quote)
-    {0x007E, 0x32},  // ` (Backtick)
-    {0x002C, 0x2B},  // , (Comma)
-    {0x002E, 0x2F},  // . (Period)
-    {0x002F, 0x2C},  // / (Slash)
-    {0x005C, 0x2A},  // \ (Backslash)
-    {0x005B, 0x21},  // [ (Left Bracket)
-    {0x005D, 0x1E},  // ] (Right Bracket)
-    {0x002D, 0x1B},  // - (Minus)
-    {0x003D, 0x18},  // = (Equals)
-
-    // modifier keys
-    {0xFFE5, 0x39},  // Caps Lock
-    {0xFFE1, 0x38},  // Shift (Left)
-    {0xFFE2, 0x3C},  // Shift (Right)
-    {0xFFE3, 0x3B},  // Control (Left)
-    {0xFFE4, 0x3E},  // Control (Right)
-    {0xFFE9, 0x3A},  // Alt (Left)
-    {0xFFEA, 0x3D},  // Alt (Right)
-    {0xFFEB, 0x37},  // Left Command
-    {0xFFEC, 0x36},  // Right Command
-};
+// Dense lookup tables, indexed by the source key code and filled with
+// kInvalidKeyCode where no mapping exists. When a source key code appears
+// more than once, the first entry wins.
+constexpr size_t kVkCodeTableSize = 256;
+constexpr size_t kCGKeyCodeTableSize = 128;
+// Latin-1 keysyms (0x0000-0x00FF) and function keysyms (0xFF00-0xFFFF) are
+// folded into a single 512-entry table, see X11KeySymToIndex().
+constexpr size_t kX11KeySymTableSize = 512;
+
+constexpr int KeyCodeToIndex(int key_code) { return key_code; }
+
+constexpr int X11KeySymToIndex(int key_sym) {
+  if (key_sym >= 0x0000 && key_sym <= 0x00FF) {
+    return key_sym;
+  }
+  if (key_sym >= 0xFF00 && key_sym <= 0xFFFF) {
+    return 0x100 + (key_sym & 0xFF);
+  }
+  return kInvalidKeyCode;
+}
+
+template <size_t N, int (*ToIndex)(int), size_t M>
+constexpr std::array<int, N> BuildKeyCodeTable(const KeyCodePair (&pairs)[M],
+                                               bool reverse) {
+  std::array<int, N> table{};
+  for (size_t i = 0; i < N; ++i) {
+    table[i] = kInvalidKeyCode;
+  }
+  for (size_t i = 0; i < M; ++i) {
+    int key = reverse ? pairs[i].to : pairs[i].from;
+    int value = reverse ? pairs[i].from : pairs[i].to;
+    int index = ToIndex(key);
+    if (index >= 0 && index < (int)N && table[index] == kInvalidKeyCode) {
+      table[index] = value;
+    }
+  }
+  return table;
+}
+
+template <size_t N>
+constexpr int LookupKeyCode(const std::array<int, N>& table, int index) {
+  return (index >= 0 && index < (int)N) ? table[index] : kInvalidKeyCode;
+}
+
+inline constexpr std::array<int, kVkCodeTableSize> vkCodeToCGKeyCode =
+    BuildKeyCodeTable<kVkCodeTableSize, KeyCodeToIndex>(
+        kVkCodeToCGKeyCodePairs, false);
+
+inline constexpr std::array<int, kCGKeyCodeTableSize> CGKeyCodeToVkCode =
+    BuildKeyCodeTable<kCGKeyCodeTableSize, KeyCodeToIndex>(
+        kVkCodeToCGKeyCodePairs, true);
+
+inline constexpr std::array<int, kVkCodeTableSize> vkCodeToX11KeySym =
+    BuildKeyCodeTable<kVkCodeTableSize, KeyCodeToIndex>(
+        kVkCodeToX11KeySymPairs, false);
+
+// index with X11KeySymToIndex()
+inline constexpr std::array<int, kX11KeySymTableSize> x11KeySymToVkCode =
+    BuildKeyCodeTable<kX11KeySymTableSize, X11KeySymToIndex>(
+        kVkCodeToX11KeySymPairs, true);
+
+inline constexpr std::array<int, kCGKeyCodeTableSize> cgKeyCodeToX11KeySym =
+    BuildKeyCodeTable<kCGKeyCodeTableSize, KeyCodeToIndex>(
+        kCGKeyCodeToX11KeySymPairs, false);
+
+// index with X11KeySymToIndex()
+inline constexpr std::array<int, kX11KeySymTableSize> x11KeySymToCgKeyCode =
+    BuildKeyCodeTable<kX11KeySymTableSize, X11KeySymToIndex>(
+        kCGKeyCodeToX11KeySymPairs, true);
+
+static_assert(vkCodeToCGKeyCode[0x41] == 0x00, "vkCode A -> CGKeyCode");
+static_assert(CGKeyCodeToVkCode[0x00] == 0x41, "CGKeyCode A -> vkCode");
+static_assert(vkCodeToX11KeySym[0x2E] == 0xFFFF, "vkCode Delete -> KeySym");
+static_assert(x11KeySymToVkCode[X11KeySymToIndex(0x0030)] == 0x30,
+              "KeySym 0 -> vkCode 0 rather than Numpad 0");
+static_assert(x11KeySymToCgKeyCode[X11KeySymToIndex(0xFFBE)] == 0x7A,
+              "KeySym F1 -> CGKeyCode");
+
+// Decodes a UTF-8 run into code points, invalid sequences become U+FFFD
+inline std::vector<uint32_t> Utf8ToCodePoints(const char* text, size_t size) {
+  std::vector<uint32_t> code_points;
+  code_points.reserve(size);
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(text);
+  size_t i = 0;
+  while (i < size) {
+    unsigned char c = p[i];
+    uint32_t code_point = 0xFFFD;
+    size_t len = 1;
+    if (c < 0x80) {
+      code_point = c;
+    } else if ((c & 0xE0) == 0xC0) {
+      len = 2;
+      code_point = c & 0x1F;
+    } else if ((c & 0xF0) == 0xE0) {
+      len = 3;
+      code_point = c & 0x0F;
+    } else if ((c & 0xF8) == 0xF0) {
+      len = 4;
+      code_point = c & 0x07;
+    }
+
+    if (len > 1) {
+      if (i + len > size) {
+        len = size - i;
+        code_point = 0xFFFD;
+      } else {
+        for (size_t j = 1; j < len; ++j) {
+          if ((p[i + j] & 0xC0) != 0x80) {
+            len = j;
+            code_point = 0xFFFD;
+            break;
+          }
+          code_point = (code_point << 6) | (p[i + j] & 0x3F);
+        }
+      }
+    }
+
+    code_points.push_back(code_point);
+    i += len;
+  }
+  return code_points;
+}
+
+inline std::vector<uint16_t> Utf8ToUtf16(const char* text, size_t size) {
+  std::vector<uint16_t> utf16;
+  utf16.reserve(size);
+  for (uint32_t code_point : Utf8ToCodePoints(text, size)) {
+    if (code_point >= 0x10000) {
+      code_point -= 0x10000;
+      utf16.push_back((uint16_t)(0xD800 + (code_point >> 10)));
+      utf16.push_back((uint16_t)(0xDC00 + (code_point & 0x3FF)));
+    } else {
+      utf16.push_back((uint16_t)code_point);
+    }
+  }
+  return utf16;
+}
 }  // namespace crossdesk
-#endif
\ No newline at end of file
+#endif
@@ -25,13 +25,25 @@ int MouseController::Init(std::vector<DisplayInfo> display_info_list) {
                            &minor_version)) {
     LOG_ERROR("XTest extension not available");
     XCloseDisplay(display_);
+    display_ = nullptr;
     return -2;
   }
 
+  cursor_display_ = XOpenDisplay(NULL);
+  if (!cursor_display_) {
+    LOG_WARN("Cannot open X connection for cursor queries");
+  } else {
+    cursor_root_ = DefaultRootWindow(cursor_display_);
+  }
+
   return 0;
 }
 
 int MouseController::Destroy() {
+  if (cursor_display_) {
+    XCloseDisplay(cursor_display_);
+    cursor_display_ = nullptr;
+  }
   if (display_) {
     XCloseDisplay(display_);
     display_ = nullptr;
@@ -102,6 +114,31 @@ int MouseController::SendMouseCommand(RemoteAction remote_action,
   return 0;
 }
 
+// XFixes is not linked, so the style is always reported as an arrow
+int MouseController::GetCursorState(int display_index,
+                                    CursorInfo* cursor_info) {
+  if (!cursor_display_ || display_index < 0 ||
+      display_index >= (int)display_info_list_.size()) {
+    return -1;
+  }
+
+  Window root_return, child_return;
+  int root_x, root_y, win_x, win_y;
+  unsigned int mask;
+  if (!XQueryPointer(cursor_display_, cursor_root_, &root_return,
+                     &child_return, &root_x, &root_y, &win_x, &win_y,
+                     &mask)) {
+    return -1;
+  }
+
+  const DisplayInfo& display_info = display_info_list_[display_index];
+  cursor_info->x = (float)(root_x - display_info.left) / display_info.width;
+  cursor_info->y = (float)(root_y - display_info.top) / display_info.height;
+  cursor_info->style = CursorStyle::cursor_arrow;
+
+  return 0;
+}
+
 void MouseController::SetMousePosition(int x, int y) {
   XWarpPointer(display_, None, root_, 0, 0, 0, 0, x, y);
   XFlush(display_);
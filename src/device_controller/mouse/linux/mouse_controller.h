@@ -26,6 +26,7 @@ class MouseController : public DeviceController {
   virtual int Init(std::vector<DisplayInfo> display_info_list);
   virtual int Destroy();
   virtual int SendMouseCommand(RemoteAction remote_action, int display_index);
+  virtual int GetCursorState(int display_index, CursorInfo* cursor_info);
 
  private:
   void SimulateKeyDown(int kval);
@@ -33,7 +34,12 @@ class MouseController : public DeviceController {
   void SetMousePosition(int x, int y);
   void SimulateMouseWheel(int direction_button, int count);
 
+  // Xlib is not thread safe without XInitThreads. Commands arrive on the
+  // network thread and cursor queries on the UI thread, so each thread
+  // gets a connection of its own.
   Display* display_ = nullptr;
+  Display* cursor_display_ = nullptr;
+  Window cursor_root_ = 0;
   Window root_ = 0;
   std::vector<DisplayInfo> display_info_list_;
   int screen_width_ = 0;
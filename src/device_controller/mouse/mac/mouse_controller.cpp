@@ -101,4 +101,26 @@ int MouseController::SendMouseCommand(RemoteAction remote_action,
 
   return 0;
 }
+
+// NSCursor is not reachable from here, so the style is always an arrow
+int MouseController::GetCursorState(int display_index,
+                                    CursorInfo* cursor_info) {
+  if (display_index < 0 || display_index >= (int)display_info_list_.size()) {
+    return -1;
+  }
+
+  CGEventRef event = CGEventCreate(NULL);
+  if (!event) {
+    return -1;
+  }
+  CGPoint location = CGEventGetLocation(event);
+  CFRelease(event);
+
+  const DisplayInfo& display_info = display_info_list_[display_index];
+  cursor_info->x = (float)(location.x - display_info.left) / display_info.width;
+  cursor_info->y = (float)(location.y - display_info.top) / display_info.height;
+  cursor_info->style = CursorStyle::cursor_arrow;
+
+  return 0;
+}
 }  // namespace crossdesk
\ No newline at end of file
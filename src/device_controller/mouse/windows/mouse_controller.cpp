@@ -72,4 +72,56 @@ int MouseController::SendMouseCommand(RemoteAction remote_action,
 
   return 0;
 }
+
+int MouseController::GetCursorState(int display_index,
+                                    CursorInfo* cursor_info) {
+  if (display_index < 0 || display_index >= (int)display_info_list_.size()) {
+    return -1;
+  }
+
+  CURSORINFO ci = {0};
+  ci.cbSize = sizeof(CURSORINFO);
+  if (!GetCursorInfo(&ci)) {
+    return -1;
+  }
+
+  const DisplayInfo& display_info = display_info_list_[display_index];
+  cursor_info->x =
+      (float)(ci.ptScreenPos.x - display_info.left) / display_info.width;
+  cursor_info->y =
+      (float)(ci.ptScreenPos.y - display_info.top) / display_info.height;
+
+  // shared system cursors keep the same handle for the whole session
+  static const struct {
+    HCURSOR cursor;
+    CursorStyle style;
+  } kSystemCursors[] = {
+      {LoadCursor(nullptr, IDC_ARROW), CursorStyle::cursor_arrow},
+      {LoadCursor(nullptr, IDC_IBEAM), CursorStyle::cursor_ibeam},
+      {LoadCursor(nullptr, IDC_HAND), CursorStyle::cursor_hand},
+      {LoadCursor(nullptr, IDC_WAIT), CursorStyle::cursor_wait},
+      {LoadCursor(nullptr, IDC_APPSTARTING), CursorStyle::cursor_wait},
+      {LoadCursor(nullptr, IDC_CROSS), CursorStyle::cursor_crosshair},
+      {LoadCursor(nullptr, IDC_SIZEALL), CursorStyle::cursor_size_all},
+      {LoadCursor(nullptr, IDC_SIZENS), CursorStyle::cursor_size_ns},
+      {LoadCursor(nullptr, IDC_SIZEWE), CursorStyle::cursor_size_we},
+      {LoadCursor(nullptr, IDC_SIZENWSE), CursorStyle::cursor_size_nwse},
+      {LoadCursor(nullptr, IDC_SIZENESW), CursorStyle::cursor_size_nesw},
+      {LoadCursor(nullptr, IDC_NO), CursorStyle::cursor_not_allowed},
+  };
+
+  cursor_info->style = CursorStyle::cursor_arrow;
+  if (!(ci.flags & CURSOR_SHOWING) || !ci.hCursor) {
+    cursor_info->style = CursorStyle::cursor_hidden;
+  } else {
+    for (const auto& system_cursor : kSystemCursors) {
+      if (system_cursor.cursor == ci.hCursor) {
+        cursor_info->style = system_cursor.style;
+        break;
+      }
+    }
+  }
+
+  return 0;
+}
 }  // namespace crossdesk
\ No newline at end of file
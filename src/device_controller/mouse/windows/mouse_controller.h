@@ -22,6 +22,7 @@ class MouseController : public DeviceController {
   virtual int Init(std::vector<DisplayInfo> display_info_list);
   virtual int Destroy();
   virtual int SendMouseCommand(RemoteAction remote_action, int display_index);
+  virtual int GetCursorState(int display_index, CursorInfo* cursor_info);
 
  private:
   std::vector<DisplayInfo> display_info_list_;
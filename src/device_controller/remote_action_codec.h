@@ -0,0 +1,31 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _REMOTE_ACTION_CODEC_H_
+#define _REMOTE_ACTION_CODEC_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "device_controller.h"
+
+namespace crossdesk {
+
+// Host info and text runs carry pointers, so they go out serialized: a one
+// byte type followed by sizes and payload. Every other action is sent as
+// the raw struct, whose enum type starts with the same byte on the little
+// endian targets we build for. The first byte therefore identifies every
+// data channel message, while the full enum of a serialized message does
+// not. |data| holds at least one byte.
+ControlType GetControlType(const char* data);
+
+std::vector<char> SerializeRemoteAction(const RemoteAction& action);
+// the pointers in |out| are allocated, release them with FreeRemoteAction
+bool DeserializeRemoteAction(const char* data, size_t size,
+                             RemoteAction& out);
+void FreeRemoteAction(RemoteAction& action);
+}  // namespace crossdesk
+#endif
@@ -21,11 +21,11 @@
 #define SETTINGS_WINDOW_WIDTH_CN 202
 #define SETTINGS_WINDOW_WIDTH_EN 248
 #if _WIN32
+#define SETTINGS_WINDOW_HEIGHT_CN 375
+#define SETTINGS_WINDOW_HEIGHT_EN 375
+#else
 #define SETTINGS_WINDOW_HEIGHT_CN 345
 #define SETTINGS_WINDOW_HEIGHT_EN 345
-#else
-#define SETTINGS_WINDOW_HEIGHT_CN 315
-#define SETTINGS_WINDOW_HEIGHT_EN 315
 #endif
 #define SELF_HOSTED_SERVER_CONFIG_WINDOW_WIDTH_CN 228
 #define SELF_HOSTED_SERVER_CONFIG_WINDOW_WIDTH_EN 275
@@ -37,6 +37,8 @@
 #define VIDEO_QUALITY_SELECT_WINDOW_PADDING_EN 167
 #define VIDEO_FRAME_RATE_SELECT_WINDOW_PADDING_CN 120
 #define VIDEO_FRAME_RATE_SELECT_WINDOW_PADDING_EN 167
+#define MAX_CAPTURE_RESOLUTION_SELECT_WINDOW_PADDING_CN 120
+#define MAX_CAPTURE_RESOLUTION_SELECT_WINDOW_PADDING_EN 167
 #define VIDEO_ENCODE_FORMAT_SELECT_WINDOW_PADDING_CN 120
 #define VIDEO_ENCODE_FORMAT_SELECT_WINDOW_PADDING_EN 167
 #define ENABLE_HARDWARE_VIDEO_CODEC_CHECKBOX_PADDING_CN 171
@@ -52,6 +52,12 @@ static std::vector<std::string> data = {reinterpret_cast<const char*>(u8"数据"
                                         "Data"};
 static std::vector<std::string> total = {
     reinterpret_cast<const char*>(u8"总计"), "Total"};
+static std::vector<std::string> latency = {
+    reinterpret_cast<const char*>(u8"延迟"), "Latency"};
+static std::vector<std::string> input_to_inject = {
+    reinterpret_cast<const char*>(u8"输入"), "Input"};
+static std::vector<std::string> inject_to_display = {
+    reinterpret_cast<const char*>(u8"显示"), "Display"};
 static std::vector<std::string> in = {reinterpret_cast<const char*>(u8"输入"),
                                       "In"};
 static std::vector<std::string> out = {reinterpret_cast<const char*>(u8"输出"),
@@ -64,10 +70,18 @@ static std::vector<std::string> control_mouse = {
     reinterpret_cast<const char*>(u8"控制"), "Control"};
 static std::vector<std::string> release_mouse = {
     reinterpret_cast<const char*>(u8"释放"), "Release"};
+static std::vector<std::string> type_clipboard = {
+    reinterpret_cast<const char*>(u8"输入剪贴板文本"), "Type Clipboard Text"};
 static std::vector<std::string> audio_capture = {
     reinterpret_cast<const char*>(u8"声音"), "Audio"};
 static std::vector<std::string> mute = {
     reinterpret_cast<const char*>(u8" 静音"), " Mute"};
+static std::vector<std::string> volume = {
+    reinterpret_cast<const char*>(u8"音量"), "Volume"};
+static std::vector<std::string> mute_playback = {
+    reinterpret_cast<const char*>(u8"静音此会话"), "Mute This Session"};
+static std::vector<std::string> mute_background_tabs = {
+    reinterpret_cast<const char*>(u8"后台标签页静音"), "Mute Background Tabs"};
 static std::vector<std::string> settings = {
     reinterpret_cast<const char*>(u8"设置"), "Settings"};
 static std::vector<std::string> language = {
@@ -81,6 +95,11 @@ static std::vector<std::string> video_quality = {
 static std::vector<std::string> video_frame_rate = {
     reinterpret_cast<const char*>(u8"画面采集帧率:"),
     "Video Capture Frame Rate:"};
+static std::vector<std::string> max_capture_resolution = {
+    reinterpret_cast<const char*>(u8"最大采集分辨率:"),
+    "Max Capture Resolution:"};
+static std::vector<std::string> native_resolution = {
+    reinterpret_cast<const char*>(u8"原始"), "Native"};
 static std::vector<std::string> video_quality_high = {
     reinterpret_cast<const char*>(u8"高"), "High"};
 static std::vector<std::string> video_quality_medium = {
@@ -0,0 +1,159 @@
+#include "audio_fanout_sender.h"
+
+#include <algorithm>
+
+#include "rd_log.h"
+#include "trace.h"
+
+namespace crossdesk {
+
+constexpr size_t kRingFrames = 32;
+
+AudioFanoutSender::AudioFanoutSender()
+    : ring_(kRingFrames * kFrameBytes),
+      targets_(std::make_shared<const Targets>()) {}
+
+AudioFanoutSender::~AudioFanoutSender() { Stop(); }
+
+int AudioFanoutSender::Start(const std::string& label) {
+  if (running_) {
+    return 0;
+  }
+
+  label_ = label;
+  ring_.Reset();
+  dropped_bytes_ = 0;
+  data_pending_ = false;
+  running_ = true;
+  thread_ = std::thread(&AudioFanoutSender::SenderLoop, this);
+  return 0;
+}
+
+void AudioFanoutSender::Stop() {
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    if (!running_) {
+      return;
+    }
+    running_ = false;
+  }
+  wake_cv_.notify_one();
+  if (thread_.joinable()) {
+    thread_.join();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    retired_.clear();
+  }
+
+  uint64_t dropped_bytes = GetDroppedBytes();
+  if (dropped_bytes > 0) {
+    LOG_WARN("Audio fan-out dropped [{}] bytes", dropped_bytes);
+  }
+}
+
+void AudioFanoutSender::Push(const unsigned char* data, size_t size) {
+  size_t written = ring_.Write(data, size);
+  if (written < size) {
+    dropped_bytes_.fetch_add(size - written, std::memory_order_relaxed);
+  }
+  if (written > 0) {
+    // not under wake_mutex_: a wakeup lost to the sender just going to
+    // sleep is made up by the next Push, one frame later
+    data_pending_.store(true, std::memory_order_release);
+    wake_cv_.notify_one();
+  }
+}
+
+void AudioFanoutSender::SetTargets(Targets targets) {
+  std::shared_ptr<const Targets> next =
+      std::make_shared<const Targets>(std::move(targets));
+  std::shared_ptr<const Targets> prev =
+      std::atomic_exchange(&targets_, std::move(next));
+  uint64_t version =
+      targets_version_.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+    if (running_) {
+      retired_.emplace_back(version, std::move(prev));
+    }
+    ReleaseRetiredLocked();
+  }
+  wake_cv_.notify_one();
+}
+
+void AudioFanoutSender::RemoveTarget(PeerPtr* peer) {
+  Targets targets = *GetTargets();
+  auto it = std::remove(targets.begin(), targets.end(), peer);
+  if (it == targets.end()) {
+    return;
+  }
+  targets.erase(it, targets.end());
+  SetTargets(std::move(targets));
+
+  uint64_t version = targets_version_.load(std::memory_order_acquire);
+  std::unique_lock<std::mutex> lock(wake_mutex_);
+  done_cv_.wait(lock, [this, version]() {
+    return !running_ || done_version_ >= version;
+  });
+  ReleaseRetiredLocked();
+}
+
+void AudioFanoutSender::ReleaseRetiredLocked() {
+  if (!running_) {
+    retired_.clear();
+    return;
+  }
+  retired_.erase(
+      std::remove_if(retired_.begin(), retired_.end(),
+                     [this](const auto& retired) {
+                       return retired.first <= done_version_;
+                     }),
+      retired_.end());
+}
+
+void AudioFanoutSender::SenderLoop() {
+  uint64_t version = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> lock(wake_mutex_);
+      wake_cv_.wait(lock, [this, &version]() {
+        return !running_ || data_pending_.load(std::memory_order_acquire) ||
+               targets_version_.load(std::memory_order_acquire) != version;
+      });
+      if (!running_) {
+        break;
+      }
+    }
+
+    data_pending_.store(false, std::memory_order_release);
+    // the list loaded next is at least this new
+    version = targets_version_.load(std::memory_order_acquire);
+    std::shared_ptr<const Targets> targets = std::atomic_load(&targets_);
+    if (targets->empty()) {
+      // nobody to send to, discard whole frames to keep the ring aligned
+      size_t buffered = ring_.Size();
+      ring_.Consume(buffered - buffered % kFrameBytes);
+    } else {
+      const uint8_t* frame = nullptr;
+      while ((frame = ring_.Peek(kFrameBytes))) {
+        for (PeerPtr* peer : *targets) {
+          SendAudioFrame(peer, (const char*)frame, kFrameBytes,
+                         label_.c_str());
+          TraceRecordEvent(TraceEvent::send_audio, kFrameBytes);
+        }
+        ring_.Consume(kFrameBytes);
+      }
+    }
+    targets.reset();
+
+    {
+      std::lock_guard<std::mutex> lock(wake_mutex_);
+      done_version_ = version;
+    }
+    done_cv_.notify_all();
+  }
+}
+}  // namespace crossdesk
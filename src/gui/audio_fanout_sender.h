@@ -0,0 +1,93 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _AUDIO_FANOUT_SENDER_H_
+#define _AUDIO_FANOUT_SENDER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "minirtc.h"
+#include "spsc_ring_buffer.h"
+
+namespace crossdesk {
+
+// Sends captured audio to every connected peer from a thread of its own.
+// The audio thread only copies into a lock free ring and wakes the sender,
+// which otherwise sleeps. The peers to send to are an immutable list that
+// is replaced as a whole, read-copy-update style, so the sender never sees
+// a list while it changes. Start it together with the capture source that
+// feeds Push.
+class AudioFanoutSender {
+ public:
+  // 10 ms of 48 kHz mono S16
+  static constexpr size_t kFrameBytes = 960;
+
+  typedef std::vector<PeerPtr*> Targets;
+
+ public:
+  AudioFanoutSender();
+  ~AudioFanoutSender();
+
+ public:
+  int Start(const std::string& label);
+  void Stop();
+
+  // audio thread: never blocks or allocates, drops what does not fit
+  void Push(const unsigned char* data, size_t size);
+
+  // UI thread: publishes a new target list without waiting for the sender.
+  // Replaced lists are kept until the sender has moved past them.
+  void SetTargets(Targets targets);
+  // UI thread: once it returns the sender no longer uses |peer|, so it may
+  // be destroyed. Waits for at most one send pass.
+  void RemoveTarget(PeerPtr* peer);
+  std::shared_ptr<const Targets> GetTargets() const {
+    return std::atomic_load(&targets_);
+  }
+
+  uint64_t GetDroppedBytes() const {
+    return dropped_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  void SenderLoop();
+  // caller holds wake_mutex_, drops the lists the sender is done with
+  void ReleaseRetiredLocked();
+
+ private:
+  std::string label_;
+  SpscRingBuffer ring_;
+  std::atomic<uint64_t> dropped_bytes_{0};
+
+  // read with std::atomic_load, replaced with std::atomic_store
+  std::shared_ptr<const Targets> targets_;
+  // bumped after every new targets_
+  std::atomic<uint64_t> targets_version_{0};
+
+  std::thread thread_;
+  std::atomic<bool> running_{false};
+  // set by Push, cleared by the sender before it drains the ring
+  std::atomic<bool> data_pending_{false};
+  // only the UI and sender threads lock this, never the audio thread
+  std::mutex wake_mutex_;
+  std::condition_variable wake_cv_;
+  // the newest targets_version_ the sender finished a pass with
+  uint64_t done_version_ = 0;
+  std::condition_variable done_cv_;
+  // replaced lists with the version that replaced them
+  std::vector<std::pair<uint64_t, std::shared_ptr<const Targets>>> retired_;
+};
+}  // namespace crossdesk
+#endif
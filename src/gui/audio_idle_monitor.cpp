@@ -0,0 +1,82 @@
+#include "audio_idle_monitor.h"
+
+#include "rd_log.h"
+
+namespace crossdesk {
+
+AudioIdleMonitor::AudioIdleMonitor(const std::string& name,
+                                   std::chrono::milliseconds grace_period,
+                                   State state, device_cb suspend,
+                                   device_cb resume)
+    : name_(name),
+      grace_period_ms_(grace_period.count()),
+      suspend_(std::move(suspend)),
+      resume_(std::move(resume)),
+      state_(state),
+      last_demand_ms_(NowMs()) {}
+
+AudioIdleMonitor::~AudioIdleMonitor() {}
+
+int64_t AudioIdleMonitor::NowMs() const {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void AudioIdleMonitor::Touch() {
+  // seq_cst pairs with Poll, which switches state_ and then re-reads the
+  // demand: either Poll sees this store or this load sees suspended
+  last_demand_ms_.store(NowMs());
+  if (state_.load() == State::running) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (state_.load() != State::suspended) {
+    return;
+  }
+  if (0 != resume_()) {
+    LOG_ERROR("Failed to resume [{}] audio device", name_);
+    return;
+  }
+  state_ = State::running;
+  resume_count_++;
+  wakeups_at_resume_ = GetWakeups();
+  LOG_INFO("[{}] audio device resumed", name_);
+}
+
+void AudioIdleMonitor::Poll(bool has_consumers) {
+  if (has_consumers) {
+    Touch();
+    return;
+  }
+  if (state_.load() != State::running ||
+      NowMs() - last_demand_ms_.load(std::memory_order_relaxed) <
+          grace_period_ms_) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // switch first. A Touch that still saw running has stored its demand by
+  // now and is caught by the check below, one that saw suspended waits for
+  // the lock and resumes the device right after.
+  State expected = State::running;
+  if (!state_.compare_exchange_strong(expected, State::suspended)) {
+    return;
+  }
+  if (NowMs() - last_demand_ms_.load() < grace_period_ms_) {
+    state_ = State::running;
+    return;
+  }
+  if (0 != suspend_()) {
+    LOG_ERROR("Failed to suspend [{}] audio device", name_);
+    state_ = State::running;
+    last_demand_ms_.store(NowMs(), std::memory_order_relaxed);
+    return;
+  }
+  suspend_count_++;
+  LOG_INFO("[{}] audio device suspended after [{}] idle ms, [{}] wakeups "
+           "while running",
+           name_, grace_period_ms_, GetWakeups() - wakeups_at_resume_);
+}
+}  // namespace crossdesk
@@ -0,0 +1,70 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _AUDIO_IDLE_MONITOR_H_
+#define _AUDIO_IDLE_MONITOR_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+
+namespace crossdesk {
+
+// Suspends one audio device once nothing has needed it for a grace period
+// and resumes it on the next demand. Touch may be called from any thread
+// and resumes the device before it returns. Poll runs on the UI thread.
+class AudioIdleMonitor {
+ public:
+  enum class State { running = 0, suspended };
+
+  typedef std::function<int()> device_cb;
+
+ public:
+  AudioIdleMonitor(const std::string& name,
+                   std::chrono::milliseconds grace_period, State state,
+                   device_cb suspend, device_cb resume);
+  ~AudioIdleMonitor();
+
+ public:
+  // a consumer needs the device now
+  void Touch();
+  // |has_consumers| counts as a Touch, otherwise the device is suspended
+  // once the grace period has passed
+  void Poll(bool has_consumers);
+
+  // device callback, counted to verify that a suspended device is quiet
+  void OnWakeup() { wakeups_.fetch_add(1, std::memory_order_relaxed); }
+
+  State GetState() const { return state_.load(); }
+  uint64_t GetWakeups() const {
+    return wakeups_.load(std::memory_order_relaxed);
+  }
+  uint64_t GetSuspendCount() const { return suspend_count_.load(); }
+  uint64_t GetResumeCount() const { return resume_count_.load(); }
+
+ private:
+  int64_t NowMs() const;
+
+ private:
+  const std::string name_;
+  const int64_t grace_period_ms_;
+  device_cb suspend_;
+  device_cb resume_;
+
+  // serialises the device calls, state_ is read without it
+  std::mutex mutex_;
+  std::atomic<State> state_;
+  std::atomic<int64_t> last_demand_ms_;
+  std::atomic<uint64_t> wakeups_{0};
+  std::atomic<uint64_t> suspend_count_{0};
+  std::atomic<uint64_t> resume_count_{0};
+  uint64_t wakeups_at_resume_ = 0;
+};
+}  // namespace crossdesk
+#endif
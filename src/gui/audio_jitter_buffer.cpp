@@ -0,0 +1,193 @@
+#include "audio_jitter_buffer.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace crossdesk {
+
+// one second of audio, far above any target depth
+constexpr int kRingSeconds = 1;
+constexpr float kMinTargetMs = 20.0f;
+constexpr float kMaxTargetMs = 200.0f;
+// depth above this multiple of the target is dropped at once
+constexpr float kMaxDepthRatio = 3.0f;
+// +-0.5% playout rate, inaudible but enough for any real clock drift
+constexpr double kMaxRateAdjust = 0.005;
+constexpr double kRateGain = 0.01;
+
+AudioJitterBuffer::AudioJitterBuffer(int sample_rate)
+    : sample_rate_(sample_rate),
+      frame_samples_(sample_rate / 100),
+      ring_(kRingSeconds * sample_rate * sizeof(int16_t)),
+      history_(sample_rate / 100, 0) {
+  target_samples_ = kMinTargetMs * sample_rate_ / 1000.0f;
+}
+
+AudioJitterBuffer::~AudioJitterBuffer() {}
+
+void AudioJitterBuffer::Push(const int16_t* samples, size_t count) {
+  auto now = std::chrono::steady_clock::now();
+  if (silence_.exchange(false, std::memory_order_relaxed)) {
+    has_last_arrival_ = false;
+  }
+  if (has_last_arrival_) {
+    // deviation of the arrival gap from the audio duration it carried
+    float gap_us =
+        std::chrono::duration<float, std::micro>(now - last_arrival_).count();
+    float expected_us = last_arrival_samples_ * 1000000.0f / sample_rate_;
+    float deviation_us = std::fabs(gap_us - expected_us);
+    float jitter_us = jitter_us_.load(std::memory_order_relaxed);
+    jitter_us += (deviation_us - jitter_us) / 16.0f;
+    jitter_us_.store(jitter_us, std::memory_order_relaxed);
+
+    float target_ms = std::clamp(
+        2 * 1000.0f * frame_samples_ / sample_rate_ + 4 * jitter_us / 1000.0f,
+        kMinTargetMs, kMaxTargetMs);
+    target_samples_.store(target_ms * sample_rate_ / 1000.0f,
+                          std::memory_order_relaxed);
+  }
+  last_arrival_ = now;
+  last_arrival_samples_ = count;
+  has_last_arrival_ = true;
+
+  size_t bytes = count * sizeof(int16_t);
+  size_t written = ring_.Write((const uint8_t*)samples, bytes);
+  received_samples_.fetch_add(written / sizeof(int16_t),
+                              std::memory_order_relaxed);
+  if (written < bytes) {
+    dropped_samples_.fetch_add((bytes - written) / sizeof(int16_t),
+                               std::memory_order_relaxed);
+  }
+}
+
+void AudioJitterBuffer::MarkSilence() {
+  silence_.store(true, std::memory_order_relaxed);
+}
+
+void AudioJitterBuffer::SetCaptureAnchor(int64_t timestamp,
+                                         size_t frame_samples) {
+  uint64_t received = received_samples_.load(std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(anchor_mutex_);
+  anchor_timestamp_ = timestamp;
+  anchor_samples_ = received > frame_samples ? received - frame_samples : 0;
+  has_anchor_ = true;
+}
+
+bool AudioJitterBuffer::GetPlayoutTimestamp(int64_t* timestamp) {
+  if (!playing_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  int64_t played = (int64_t)played_samples_.load(std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(anchor_mutex_);
+  if (!has_anchor_) {
+    return false;
+  }
+  *timestamp = anchor_timestamp_ +
+               (played - (int64_t)anchor_samples_) * 1000000 / sample_rate_;
+  return true;
+}
+
+void AudioJitterBuffer::Pull(int16_t* out, size_t count) {
+  size_t depth = ring_.Size() / sizeof(int16_t);
+  float target = target_samples_.load(std::memory_order_relaxed);
+
+  if (buffering_) {
+    if (depth < target) {
+      Conceal(out, count);
+      return;
+    }
+    buffering_ = false;
+    playing_.store(true, std::memory_order_relaxed);
+    phase_ = 0;
+    ReadSample(current_sample_);
+    ReadSample(next_sample_);
+  }
+
+  // a burst after a stall would otherwise stay as added latency
+  if (depth > target * kMaxDepthRatio) {
+    size_t excess = depth - (size_t)target;
+    ring_.Consume(excess * sizeof(int16_t));
+    played_samples_.fetch_add(excess, std::memory_order_relaxed);
+    dropped_samples_.fetch_add(excess, std::memory_order_relaxed);
+    depth -= excess;
+  }
+
+  // read faster when above the target and slower when below it
+  double error = (depth - target) / target;
+  double ratio = 1.0 + std::clamp(error * kRateGain, -kMaxRateAdjust,
+                                  kMaxRateAdjust);
+  drift_ppm_.store((float)((ratio - 1.0) * 1e6), std::memory_order_relaxed);
+
+  for (size_t i = 0; i < count; ++i) {
+    int16_t sample = (int16_t)std::lround(
+        current_sample_ + (next_sample_ - current_sample_) * phase_);
+    out[i] = sample;
+    history_[history_pos_] = sample;
+    history_pos_ = (history_pos_ + 1) % history_.size();
+
+    phase_ += ratio;
+    while (phase_ >= 1.0) {
+      phase_ -= 1.0;
+      current_sample_ = next_sample_;
+      if (!ReadSample(next_sample_)) {
+        if (!silence_.load(std::memory_order_relaxed)) {
+          underruns_.fetch_add(1, std::memory_order_relaxed);
+        }
+        buffering_ = true;
+        playing_.store(false, std::memory_order_relaxed);
+        conceal_pos_ = 0;
+        conceal_gain_ = 1.0f;
+        Conceal(out + i + 1, count - i - 1);
+        return;
+      }
+    }
+  }
+  conceal_gain_ = 0;
+}
+
+AudioJitterBuffer::Stats AudioJitterBuffer::GetStats() const {
+  Stats stats;
+  float samples_per_ms = sample_rate_ / 1000.0f;
+  stats.depth_ms = ring_.Size() / sizeof(int16_t) / samples_per_ms;
+  stats.target_ms =
+      target_samples_.load(std::memory_order_relaxed) / samples_per_ms;
+  stats.jitter_ms = jitter_us_.load(std::memory_order_relaxed) / 1000.0f;
+  stats.drift_ppm = drift_ppm_.load(std::memory_order_relaxed);
+  stats.underruns = underruns_.load(std::memory_order_relaxed);
+  stats.concealed_ms = (uint64_t)(
+      concealed_samples_.load(std::memory_order_relaxed) / samples_per_ms);
+  stats.dropped_ms = (uint64_t)(
+      dropped_samples_.load(std::memory_order_relaxed) / samples_per_ms);
+  return stats;
+}
+
+bool AudioJitterBuffer::ReadSample(int16_t& sample) {
+  const uint8_t* data = ring_.Peek(sizeof(int16_t));
+  if (!data) {
+    return false;
+  }
+  memcpy(&sample, data, sizeof(int16_t));
+  ring_.Consume(sizeof(int16_t));
+  played_samples_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+// replay the last frame with a fade so a gap neither clicks nor drones
+void AudioJitterBuffer::Conceal(int16_t* out, size_t count) {
+  size_t frame = history_.size();
+  // the 10 ms frame plays twice, reaching silence after 20 ms
+  constexpr float kFadeFrames = 2.0f;
+  float fade_per_sample = 1.0f / (kFadeFrames * frame);
+  for (size_t i = 0; i < count; ++i) {
+    if (conceal_gain_ <= 0) {
+      std::fill(out + i, out + count, 0);
+      return;
+    }
+    size_t pos = (history_pos_ + conceal_pos_) % frame;
+    out[i] = (int16_t)(history_[pos] * conceal_gain_);
+    conceal_pos_++;
+    conceal_gain_ -= fade_per_sample;
+    concealed_samples_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+}  // namespace crossdesk
@@ -0,0 +1,103 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _AUDIO_JITTER_BUFFER_H_
+#define _AUDIO_JITTER_BUFFER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "spsc_ring_buffer.h"
+
+namespace crossdesk {
+
+// Playout buffer for one remote mono S16 stream. Push runs on the network
+// thread and Pull on the audio device thread; they only share a lock-free
+// ring and a few atomics.
+//
+// The target depth follows the measured arrival jitter. The reader runs a
+// slightly faster or slower linear resampler to pull the depth back to the
+// target, which also absorbs sender/receiver clock drift. When the buffer
+// runs dry it loops the last 10 ms of audio while fading it out over 20 ms.
+class AudioJitterBuffer {
+ public:
+  struct Stats {
+    float depth_ms = 0;
+    float target_ms = 0;
+    float jitter_ms = 0;
+    float drift_ppm = 0;
+    uint64_t underruns = 0;
+    uint64_t concealed_ms = 0;
+    uint64_t dropped_ms = 0;
+  };
+
+ public:
+  explicit AudioJitterBuffer(int sample_rate);
+  ~AudioJitterBuffer();
+
+ public:
+  void Push(const int16_t* samples, size_t count);
+
+  // no audio follows until the next Push; running dry is then expected
+  // and the gap must not count as jitter
+  void MarkSilence();
+
+  // the frame of |frame_samples| pushed last was captured at |timestamp|
+  void SetCaptureAnchor(int64_t timestamp, size_t frame_samples);
+  // capture timestamp of the sample being played now
+  bool GetPlayoutTimestamp(int64_t* timestamp);
+
+  // always fills |count| samples, with concealment or silence if needed
+  void Pull(int16_t* out, size_t count);
+
+  Stats GetStats() const;
+
+ private:
+  bool ReadSample(int16_t& sample);
+  void Conceal(int16_t* out, size_t count);
+
+ private:
+  const int sample_rate_;
+  const size_t frame_samples_;
+  SpscRingBuffer ring_;
+
+  // network thread
+  std::chrono::steady_clock::time_point last_arrival_;
+  bool has_last_arrival_ = false;
+  size_t last_arrival_samples_ = 0;
+
+  // audio thread
+  bool buffering_ = true;
+  double phase_ = 0;
+  int16_t current_sample_ = 0;
+  int16_t next_sample_ = 0;
+  std::vector<int16_t> history_;
+  size_t history_pos_ = 0;
+  size_t conceal_pos_ = 0;
+  float conceal_gain_ = 0;
+
+  std::atomic<bool> silence_{false};
+  std::atomic<bool> playing_{false};
+  std::atomic<uint64_t> received_samples_{0};
+  std::atomic<uint64_t> played_samples_{0};
+
+  std::mutex anchor_mutex_;
+  bool has_anchor_ = false;
+  int64_t anchor_timestamp_ = 0;
+  uint64_t anchor_samples_ = 0;
+
+  std::atomic<float> jitter_us_{0};
+  std::atomic<float> target_samples_{0};
+  std::atomic<float> drift_ppm_{0};
+  std::atomic<uint64_t> underruns_{0};
+  std::atomic<uint64_t> concealed_samples_{0};
+  std::atomic<uint64_t> dropped_samples_{0};
+};
+}  // namespace crossdesk
+#endif
@@ -0,0 +1,245 @@
+#include "audio_latency_probe.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+#include "rd_log.h"
+
+namespace crossdesk {
+
+constexpr double kPi = 3.14159265358979323846;
+// high enough to stand out from speech, low enough to survive the codec
+constexpr int kToneFrequency = 3000;
+constexpr int kToneAmplitude = 16384;
+// bursts are a second apart, anything further off belongs to another one
+constexpr int64_t kMatchWindowUs = 500000;
+// the burst spans up to two packets or device reads
+constexpr int64_t kRefractoryUs = 500000;
+constexpr size_t kMaxPending = 8;
+constexpr size_t kMaxSamples = 100;
+constexpr size_t kSummaryInterval = 10;
+
+AudioLatencyProbe::AudioLatencyProbe(const std::string& name, int sample_rate)
+    : name_(name), sample_rate_(sample_rate) {}
+
+AudioLatencyProbe::~AudioLatencyProbe() {}
+
+void AudioLatencyProbe::FillTone(int16_t* samples, size_t count,
+                                 int sample_rate) {
+  // 1 ms ramps keep the codec from smearing the edges
+  size_t ramp = (size_t)std::max(1, sample_rate / 1000);
+  for (size_t i = 0; i < count; ++i) {
+    size_t edge = std::min(i, count - 1 - i);
+    double envelope = std::min(1.0, (double)edge / ramp);
+    double phase = 2 * kPi * kToneFrequency * i / sample_rate;
+    samples[i] = (int16_t)(kToneAmplitude * envelope * std::sin(phase));
+  }
+}
+
+int AudioLatencyProbe::Detect(const int16_t* samples, size_t count) const {
+  if (count == 0) {
+    return -1;
+  }
+
+  // Goertzel filter on the tone frequency
+  double coeff = 2 * std::cos(2 * kPi * kToneFrequency / sample_rate_);
+  double s1 = 0;
+  double s2 = 0;
+  double energy = 0;
+  for (size_t i = 0; i < count; ++i) {
+    double x = samples[i];
+    double s0 = x + coeff * s1 - s2;
+    s2 = s1;
+    s1 = s0;
+    energy += x * x;
+  }
+  double power = s1 * s1 + s2 * s2 - coeff * s1 * s2;
+
+  // a burst filling the whole block gives power == energy * count / 2
+  double min_energy = (double)kToneAmplitude * kToneAmplitude / 128;
+  if (energy / count < min_energy || power < 0.3 * energy * count / 2) {
+    return -1;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    if (std::abs(samples[i]) > kToneAmplitude / 4) {
+      return (int)i;
+    }
+  }
+  return 0;
+}
+
+int64_t AudioLatencyProbe::SteadyMicros() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void AudioLatencyProbe::OnProbeSent(uint32_t seq, int64_t send_timestamp) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sent_.push_back({seq, send_timestamp});
+}
+
+void AudioLatencyProbe::OnReceived(const int16_t* samples, size_t count,
+                                   int64_t timestamp) {
+  int64_t now = SteadyMicros();
+  if (now - last_arrival_us_ < kRefractoryUs || Detect(samples, count) < 0) {
+    return;
+  }
+  last_arrival_us_ = now;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  arrivals_.push_back({timestamp, now});
+}
+
+void AudioLatencyProbe::OnPlayout(const int16_t* samples, size_t count,
+                                  int64_t output_queue_us) {
+  int64_t now = SteadyMicros();
+  if (now - last_playout_us_ < kRefractoryUs) {
+    return;
+  }
+  int index = Detect(samples, count);
+  if (index < 0) {
+    return;
+  }
+  last_playout_us_ = now;
+
+  uint32_t head = playout_head_.load(std::memory_order_relaxed);
+  if (head - playout_tail_.load(std::memory_order_acquire) >= kPlayoutSlots) {
+    // Process fell behind, a burst a second cannot fill the ring otherwise
+    return;
+  }
+  playout_slots_[head % kPlayoutSlots] = {
+      now + (int64_t)index * 1000000 / sample_rate_, output_queue_us};
+  playout_head_.store(head + 1, std::memory_order_release);
+}
+
+void AudioLatencyProbe::Process() {
+  uint32_t tail = playout_tail_.load(std::memory_order_relaxed);
+  uint32_t head = playout_head_.load(std::memory_order_acquire);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  for (; tail != head; ++tail) {
+    playouts_.push_back(playout_slots_[tail % kPlayoutSlots]);
+  }
+  playout_tail_.store(tail, std::memory_order_release);
+  Match();
+}
+
+void AudioLatencyProbe::Match() {
+  while (!sent_.empty() && !arrivals_.empty() && !playouts_.empty()) {
+    const Sent& sent = sent_.front();
+    const Arrival& arrival = arrivals_.front();
+    const Playout& playout = playouts_.front();
+
+    Sample sample;
+    sample.network_us = arrival.timestamp - sent.timestamp;
+    sample.jitter_buffer_us = playout.steady_us - arrival.steady_us;
+    sample.output_queue_us = playout.output_queue_us;
+
+    if (sample.network_us < -kMatchWindowUs) {
+      // a burst whose announcement got lost
+      arrivals_.pop_front();
+      lost_++;
+      continue;
+    }
+    if (sample.network_us > kMatchWindowUs) {
+      // an announced burst that never arrived
+      sent_.pop_front();
+      lost_++;
+      continue;
+    }
+    if (sample.jitter_buffer_us < 0) {
+      playouts_.pop_front();
+      continue;
+    }
+    if (sample.jitter_buffer_us > kMatchWindowUs) {
+      // dropped or concealed by the jitter buffer
+      sent_.pop_front();
+      arrivals_.pop_front();
+      lost_++;
+      continue;
+    }
+
+    Report(sent, sample);
+    sent_.pop_front();
+    arrivals_.pop_front();
+    playouts_.pop_front();
+  }
+
+  // one side may never show up, e.g. while the session is muted
+  while (sent_.size() > kMaxPending) {
+    sent_.pop_front();
+    lost_++;
+  }
+  while (arrivals_.size() > kMaxPending) {
+    arrivals_.pop_front();
+  }
+  while (playouts_.size() > kMaxPending) {
+    playouts_.pop_front();
+  }
+}
+
+void AudioLatencyProbe::Report(const Sent& sent, const Sample& sample) {
+  samples_.push_back(sample);
+  if (samples_.size() > kMaxSamples) {
+    samples_.pop_front();
+  }
+
+  LOG_INFO(
+      "[{}] audio probe [{}]: network [{:.1f}] ms, jitter buffer [{:.1f}] "
+      "ms, output queue [{:.1f}] ms",
+      name_, sent.seq, sample.network_us / 1000.0,
+      sample.jitter_buffer_us / 1000.0, sample.output_queue_us / 1000.0);
+
+  if (sent.seq % kSummaryInterval != 0) {
+    return;
+  }
+
+  Summary summary = Summarize();
+  LOG_INFO(
+      "[{}] audio latency p50: network [{:.1f}] jitter buffer [{:.1f}] "
+      "output queue [{:.1f}] total [{:.1f}] ms, total p99 [{:.1f}] ms, "
+      "[{}] samples, [{}] lost",
+      name_, summary.network_p50_ms, summary.jitter_buffer_p50_ms,
+      summary.output_queue_p50_ms, summary.total_p50_ms, summary.total_p99_ms,
+      summary.samples, summary.lost);
+}
+
+double AudioLatencyProbe::Percentile(std::vector<int64_t> values,
+                                     double ratio) {
+  if (values.empty()) {
+    return 0;
+  }
+  size_t index = (size_t)(ratio * (values.size() - 1) + 0.5);
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return (double)values[index];
+}
+
+AudioLatencyProbe::Summary AudioLatencyProbe::GetSummary() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return Summarize();
+}
+
+AudioLatencyProbe::Summary AudioLatencyProbe::Summarize() const {
+  Summary summary;
+  summary.samples = samples_.size();
+  summary.lost = lost_;
+
+  std::vector<int64_t> network, jitter_buffer, output_queue, total;
+  for (const auto& s : samples_) {
+    network.push_back(s.network_us);
+    jitter_buffer.push_back(s.jitter_buffer_us);
+    output_queue.push_back(s.output_queue_us);
+    total.push_back(s.network_us + s.jitter_buffer_us + s.output_queue_us);
+  }
+  summary.network_p50_ms = Percentile(network, 0.5) / 1000.0;
+  summary.jitter_buffer_p50_ms = Percentile(jitter_buffer, 0.5) / 1000.0;
+  summary.output_queue_p50_ms = Percentile(output_queue, 0.5) / 1000.0;
+  summary.total_p50_ms = Percentile(total, 0.5) / 1000.0;
+  summary.total_p99_ms = Percentile(total, 0.99) / 1000.0;
+  return summary;
+}
+}  // namespace crossdesk
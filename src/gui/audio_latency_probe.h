@@ -0,0 +1,115 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _AUDIO_LATENCY_PROBE_H_
+#define _AUDIO_LATENCY_PROBE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace crossdesk {
+
+// Diagnostics for the audio path of one session. The host replaces one
+// speaker frame per second with a tone burst and announces its send time
+// on the data channel. The viewer detects the burst when the packet
+// arrives and again when it leaves the jitter buffer, which splits the
+// delay into network (encode, transport, decode), jitter buffer and
+// output queue. Send and arrival times are GetSystemTimeMicros() values.
+// The callbacks only record, Process matches and reports.
+class AudioLatencyProbe {
+ public:
+  // speaker frames between two bursts
+  static constexpr int kInterval = 100;
+
+  struct Summary {
+    size_t samples = 0;
+    uint64_t lost = 0;
+    double network_p50_ms = 0;
+    double jitter_buffer_p50_ms = 0;
+    double output_queue_p50_ms = 0;
+    double total_p50_ms = 0;
+    double total_p99_ms = 0;
+  };
+
+ public:
+  AudioLatencyProbe(const std::string& name, int sample_rate);
+  ~AudioLatencyProbe();
+
+ public:
+  // host: overwrites |samples| with the burst
+  static void FillTone(int16_t* samples, size_t count, int sample_rate);
+
+  // data channel: the host sent a burst at |send_timestamp|
+  void OnProbeSent(uint32_t seq, int64_t send_timestamp);
+  // network thread, before the jitter buffer
+  void OnReceived(const int16_t* samples, size_t count, int64_t timestamp);
+  // audio thread, after the jitter buffer. |output_queue_us| is what the
+  // device still has to play before these samples. Neither locks nor
+  // allocates.
+  void OnPlayout(const int16_t* samples, size_t count,
+                 int64_t output_queue_us);
+  // render thread, matches what was recorded since the last call
+  void Process();
+
+  Summary GetSummary();
+
+ private:
+  struct Sent {
+    uint32_t seq;
+    int64_t timestamp;
+  };
+  struct Arrival {
+    int64_t timestamp;
+    int64_t steady_us;
+  };
+  struct Playout {
+    int64_t steady_us;
+    int64_t output_queue_us;
+  };
+  struct Sample {
+    int64_t network_us;
+    int64_t jitter_buffer_us;
+    int64_t output_queue_us;
+  };
+
+  // index of the first burst sample in |samples|, or -1
+  int Detect(const int16_t* samples, size_t count) const;
+  static int64_t SteadyMicros();
+  static double Percentile(std::vector<int64_t> values, double ratio);
+
+  void Match();
+  void Report(const Sent& sent, const Sample& sample);
+  // caller holds mutex_
+  Summary Summarize() const;
+
+ private:
+  const std::string name_;
+  const int sample_rate_;
+
+  std::mutex mutex_;
+  std::deque<Sent> sent_;
+  std::deque<Arrival> arrivals_;
+  std::deque<Playout> playouts_;
+  std::deque<Sample> samples_;
+  uint64_t lost_ = 0;
+
+  // single producer ring from OnPlayout to Process
+  static constexpr uint32_t kPlayoutSlots = 8;
+  Playout playout_slots_[kPlayoutSlots];
+  std::atomic<uint32_t> playout_head_{0};
+  std::atomic<uint32_t> playout_tail_{0};
+
+  // each touched by one thread only
+  int64_t last_arrival_us_ = 0;
+  int64_t last_playout_us_ = 0;
+};
+}  // namespace crossdesk
+#endif
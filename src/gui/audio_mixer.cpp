@@ -0,0 +1,194 @@
+#include "audio_mixer.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CROSSDESK_AUDIO_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define CROSSDESK_AUDIO_NEON
+#endif
+
+namespace crossdesk {
+
+void MixSaturateS16(int16_t* dst, const int16_t* src, size_t count) {
+  size_t i = 0;
+#if defined(CROSSDESK_AUDIO_SSE2)
+  for (; i + 8 <= count; i += 8) {
+    __m128i a = _mm_loadu_si128((const __m128i*)(dst + i));
+    __m128i b = _mm_loadu_si128((const __m128i*)(src + i));
+    _mm_storeu_si128((__m128i*)(dst + i), _mm_adds_epi16(a, b));
+  }
+#elif defined(CROSSDESK_AUDIO_NEON)
+  for (; i + 8 <= count; i += 8) {
+    vst1q_s16(dst + i, vqaddq_s16(vld1q_s16(dst + i), vld1q_s16(src + i)));
+  }
+#endif
+  for (; i < count; ++i) {
+    dst[i] = (int16_t)std::clamp<int32_t>((int32_t)dst[i] + src[i], INT16_MIN,
+                                          INT16_MAX);
+  }
+}
+
+void ScaleS16(int16_t* samples, size_t count, float gain) {
+  // Q15 gain, so the product never overflows
+  int16_t q15 = (int16_t)(std::clamp(gain, 0.0f, 1.0f) * INT16_MAX);
+  size_t i = 0;
+#if defined(CROSSDESK_AUDIO_SSE2)
+  __m128i g = _mm_set1_epi16(q15);
+  for (; i + 8 <= count; i += 8) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(samples + i));
+    // (x * g) >> 16, then one more bit back for Q15
+    x = _mm_slli_epi16(_mm_mulhi_epi16(x, g), 1);
+    _mm_storeu_si128((__m128i*)(samples + i), x);
+  }
+#elif defined(CROSSDESK_AUDIO_NEON)
+  for (; i + 8 <= count; i += 8) {
+    vst1q_s16(samples + i, vqdmulhq_n_s16(vld1q_s16(samples + i), q15));
+  }
+#endif
+  for (; i < count; ++i) {
+    samples[i] = (int16_t)(((int32_t)samples[i] * q15) >> 15);
+  }
+}
+
+AudioMixer::AudioMixer(int sample_rate)
+    : sample_rate_(sample_rate), mix_list_(std::make_shared<MixList>()) {}
+
+AudioMixer::~AudioMixer() {}
+
+std::shared_ptr<AudioMixer::Session> AudioMixer::GetOrCreateSession(
+    const std::string& session_id) {
+  std::lock_guard<std::mutex> lock(sessions_mutex_);
+  auto& session = sessions_[session_id];
+  if (!session) {
+    session = std::make_shared<Session>(sample_rate_);
+    std::shared_ptr<Session> created = session;
+    PublishLocked();
+    return created;
+  }
+  return session;
+}
+
+void AudioMixer::PublishLocked() {
+  std::shared_ptr<MixList> next = std::make_shared<MixList>();
+  next->reserve(sessions_.size());
+  for (const auto& [session_id, session] : sessions_) {
+    next->push_back({session, session->latency_probe});
+  }
+
+  std::shared_ptr<const MixList> prev =
+      std::atomic_exchange(&mix_list_, std::shared_ptr<const MixList>(next));
+  retired_.emplace_back(mix_epoch_.load(), std::move(prev));
+  ReleaseRetiredLocked();
+}
+
+void AudioMixer::ReleaseRetiredLocked() {
+  uint64_t epoch = mix_epoch_.load();
+  // a use count of one means Mix holds no copy, e.g. no device is open
+  retired_.erase(std::remove_if(retired_.begin(), retired_.end(),
+                                [epoch](const auto& retired) {
+                                  return retired.first < epoch ||
+                                         retired.second.use_count() == 1;
+                                }),
+                 retired_.end());
+}
+
+bool AudioMixer::Push(const std::string& session_id, const int16_t* samples,
+                      size_t count) {
+  std::shared_ptr<Session> session = GetOrCreateSession(session_id);
+  session->jitter_buffer.Push(samples, count);
+  return session->gain.load(std::memory_order_relaxed) > 0.0f;
+}
+
+void AudioMixer::RemoveSession(const std::string& session_id) {
+  std::lock_guard<std::mutex> lock(sessions_mutex_);
+  if (sessions_.erase(session_id) > 0) {
+    PublishLocked();
+  }
+}
+
+void AudioMixer::MarkSilence(const std::string& session_id) {
+  std::lock_guard<std::mutex> lock(sessions_mutex_);
+  auto it = sessions_.find(session_id);
+  if (it != sessions_.end()) {
+    it->second->jitter_buffer.MarkSilence();
+  }
+}
+
+void AudioMixer::SetCaptureAnchor(const std::string& session_id,
+                                  int64_t timestamp) {
+  std::lock_guard<std::mutex> lock(sessions_mutex_);
+  auto it = sessions_.find(session_id);
+  if (it != sessions_.end()) {
+    it->second->jitter_buffer.SetCaptureAnchor(timestamp,
+                                               (size_t)sample_rate_ / 100);
+  }
+}
+
+int AudioMixer::GetPlayoutTimestamp(const std::string& session_id,
+                                    int64_t* timestamp) {
+  std::lock_guard<std::mutex> lock(sessions_mutex_);
+  auto it = sessions_.find(session_id);
+  if (it == sessions_.end() || it->second->gain.load() <= 0.0f ||
+      !it->second->jitter_buffer.GetPlayoutTimestamp(timestamp)) {
+    return -1;
+  }
+  return 0;
+}
+
+void AudioMixer::SetLatencyProbe(const std::string& session_id,
+                                 std::shared_ptr<AudioLatencyProbe> probe) {
+  std::shared_ptr<Session> session = GetOrCreateSession(session_id);
+  std::lock_guard<std::mutex> lock(sessions_mutex_);
+  session->latency_probe = std::move(probe);
+  PublishLocked();
+}
+
+void AudioMixer::SetGain(const std::string& session_id, float gain) {
+  GetOrCreateSession(session_id)->gain.store(gain, std::memory_order_relaxed);
+}
+
+int AudioMixer::GetStats(const std::string& session_id,
+                         AudioJitterBuffer::Stats* stats) {
+  std::lock_guard<std::mutex> lock(sessions_mutex_);
+  auto it = sessions_.find(session_id);
+  if (it == sessions_.end()) {
+    return -1;
+  }
+  *stats = it->second->jitter_buffer.GetStats();
+  return 0;
+}
+
+void AudioMixer::Mix(int16_t* out, size_t count, int64_t output_queue_us) {
+  if (pull_buffer_.size() < count) {
+    pull_buffer_.resize(count);
+  }
+  std::fill(out, out + count, 0);
+
+  std::shared_ptr<const MixList> list = std::atomic_load(&mix_list_);
+  for (const MixEntry& entry : *list) {
+    Session* session = entry.session.get();
+    // muted sessions keep draining so they resume in sync
+    session->jitter_buffer.Pull(pull_buffer_.data(), count);
+    if (entry.latency_probe) {
+      entry.latency_probe->OnPlayout(pull_buffer_.data(), count,
+                                     output_queue_us);
+    }
+    float gain = session->gain.load(std::memory_order_relaxed);
+    if (gain <= 0.0f) {
+      continue;
+    }
+    if (gain < 1.0f) {
+      ScaleS16(pull_buffer_.data(), count, gain);
+    }
+    MixSaturateS16(out, pull_buffer_.data(), count);
+  }
+
+  // the writers free |list| once the epoch has moved on
+  list.reset();
+  mix_epoch_.fetch_add(1);
+}
+}  // namespace crossdesk
@@ -0,0 +1,96 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _AUDIO_MIXER_H_
+#define _AUDIO_MIXER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "audio_jitter_buffer.h"
+#include "audio_latency_probe.h"
+
+namespace crossdesk {
+
+// Mixes the playout buffers of all remote sessions into one mono S16
+// stream. Push and the setters run on the network and UI threads, Mix on the
+// audio device thread. Mix never takes sessions_mutex_: it reads an
+// immutable session list published by pointer swap, and the writers free
+// old lists once Mix has moved past them, so the audio thread never drops
+// the last reference to a session.
+class AudioMixer {
+ public:
+  explicit AudioMixer(int sample_rate);
+  ~AudioMixer();
+
+ public:
+  // false if the session is muted and nothing of it will be heard
+  bool Push(const std::string& session_id, const int16_t* samples,
+            size_t count);
+  void RemoveSession(const std::string& session_id);
+  // the sender stopped sending because its input is silent
+  void MarkSilence(const std::string& session_id);
+  void SetCaptureAnchor(const std::string& session_id, int64_t timestamp);
+  // diagnostics, watches what leaves the session's jitter buffer
+  void SetLatencyProbe(const std::string& session_id,
+                       std::shared_ptr<AudioLatencyProbe> probe);
+  int GetPlayoutTimestamp(const std::string& session_id, int64_t* timestamp);
+
+  // 0 mutes the session, 1 plays it unchanged
+  void SetGain(const std::string& session_id, float gain);
+  int GetStats(const std::string& session_id, AudioJitterBuffer::Stats* stats);
+
+  // |output_queue_us| is what the device has queued before |out|
+  void Mix(int16_t* out, size_t count, int64_t output_queue_us);
+
+ private:
+  struct Session {
+    explicit Session(int sample_rate) : jitter_buffer(sample_rate) {}
+    AudioJitterBuffer jitter_buffer;
+    std::atomic<float> gain{1.0f};
+    // guarded by sessions_mutex_, Mix sees it through MixEntry
+    std::shared_ptr<AudioLatencyProbe> latency_probe;
+  };
+
+  struct MixEntry {
+    std::shared_ptr<Session> session;
+    std::shared_ptr<AudioLatencyProbe> latency_probe;
+  };
+  typedef std::vector<MixEntry> MixList;
+
+  std::shared_ptr<Session> GetOrCreateSession(const std::string& session_id);
+  // caller holds sessions_mutex_
+  void PublishLocked();
+  void ReleaseRetiredLocked();
+
+ private:
+  const int sample_rate_;
+  std::mutex sessions_mutex_;
+  std::unordered_map<std::string, std::shared_ptr<Session>> sessions_;
+  // snapshot of sessions_ for Mix, only accessed with std::atomic_load and
+  // std::atomic_exchange
+  std::shared_ptr<const MixList> mix_list_;
+  // bumped after every Mix pass, once it let go of its list
+  std::atomic<uint64_t> mix_epoch_{0};
+  // replaced lists and the epoch they were replaced in, Mix may still be
+  // reading one until mix_epoch_ moves past it
+  std::vector<std::pair<uint64_t, std::shared_ptr<const MixList>>> retired_;
+  // audio thread
+  std::vector<int16_t> pull_buffer_;
+};
+
+// dst[i] = saturate(dst[i] + src[i])
+void MixSaturateS16(int16_t* dst, const int16_t* src, size_t count);
+// samples[i] *= gain, gain in [0, 1]
+void ScaleS16(int16_t* samples, size_t count, float gain);
+}  // namespace crossdesk
+#endif
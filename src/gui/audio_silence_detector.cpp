@@ -0,0 +1,91 @@
+#include "audio_silence_detector.h"
+
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CROSSDESK_AUDIO_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define CROSSDESK_AUDIO_NEON
+#endif
+
+namespace crossdesk {
+
+int PeakS16(const int16_t* samples, size_t count) {
+  int16_t max_sample = 0;
+  int16_t min_sample = 0;
+  size_t i = 0;
+  // track max and min separately, |INT16_MIN| does not fit in int16
+#if defined(CROSSDESK_AUDIO_SSE2)
+  __m128i max_v = _mm_setzero_si128();
+  __m128i min_v = _mm_setzero_si128();
+  for (; i + 8 <= count; i += 8) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(samples + i));
+    max_v = _mm_max_epi16(max_v, x);
+    min_v = _mm_min_epi16(min_v, x);
+  }
+  int16_t max_lanes[8];
+  int16_t min_lanes[8];
+  _mm_storeu_si128((__m128i*)max_lanes, max_v);
+  _mm_storeu_si128((__m128i*)min_lanes, min_v);
+  max_sample = *std::max_element(max_lanes, max_lanes + 8);
+  min_sample = *std::min_element(min_lanes, min_lanes + 8);
+#elif defined(CROSSDESK_AUDIO_NEON)
+  int16x8_t max_v = vdupq_n_s16(0);
+  int16x8_t min_v = vdupq_n_s16(0);
+  for (; i + 8 <= count; i += 8) {
+    int16x8_t x = vld1q_s16(samples + i);
+    max_v = vmaxq_s16(max_v, x);
+    min_v = vminq_s16(min_v, x);
+  }
+  int16_t max_lanes[8];
+  int16_t min_lanes[8];
+  vst1q_s16(max_lanes, max_v);
+  vst1q_s16(min_lanes, min_v);
+  max_sample = *std::max_element(max_lanes, max_lanes + 8);
+  min_sample = *std::min_element(min_lanes, min_lanes + 8);
+#endif
+  for (; i < count; ++i) {
+    max_sample = std::max(max_sample, samples[i]);
+    min_sample = std::min(min_sample, samples[i]);
+  }
+  return std::max((int)max_sample, -(int)min_sample);
+}
+
+AudioSilenceDetector::AudioSilenceDetector(int peak_threshold,
+                                           int hangover_frames)
+    : peak_threshold_(peak_threshold), hangover_frames_(hangover_frames) {}
+
+AudioSilenceDetector::~AudioSilenceDetector() {}
+
+bool AudioSilenceDetector::Process(const int16_t* samples, size_t count) {
+  total_frames_++;
+
+  if (PeakS16(samples, count) >= peak_threshold_) {
+    silent_frames_ = 0;
+    in_dtx_ = false;
+    return true;
+  }
+
+  if (silent_frames_ < hangover_frames_) {
+    silent_frames_++;
+    return true;
+  }
+
+  in_dtx_ = true;
+  suppressed_frames_++;
+  suppressed_bytes_ += count * sizeof(int16_t);
+  return false;
+}
+
+void AudioSilenceDetector::Reset() {
+  silent_frames_ = 0;
+  in_dtx_ = false;
+  total_frames_ = 0;
+  suppressed_frames_ = 0;
+  suppressed_bytes_ = 0;
+  send_time_ns_ = 0;
+}
+}  // namespace crossdesk
@@ -0,0 +1,54 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _AUDIO_SILENCE_DETECTOR_H_
+#define _AUDIO_SILENCE_DETECTOR_H_
+
+#include <cstddef>
+#include <cstdint>
+
+namespace crossdesk {
+
+// Decides per captured frame whether it has to be sent. A frame is silent
+// when its peak stays below the threshold; sending stops only after a
+// hangover of silent frames, so word endings and short pauses go through.
+class AudioSilenceDetector {
+ public:
+  // -54 dBFS and 300 ms of 10 ms frames
+  AudioSilenceDetector(int peak_threshold = 64, int hangover_frames = 30);
+  ~AudioSilenceDetector();
+
+ public:
+  // returns true if the frame should be sent
+  bool Process(const int16_t* samples, size_t count);
+  bool InDtx() const { return in_dtx_; }
+  void Reset();
+
+  uint64_t GetTotalFrames() const { return total_frames_; }
+  uint64_t GetSuppressedFrames() const { return suppressed_frames_; }
+  uint64_t GetSuppressedBytes() const { return suppressed_bytes_; }
+
+  // time spent encoding and sending the frames that did go out, so the
+  // stop log can put a measured cost on the suppressed ones
+  void AddSendTime(int64_t ns) { send_time_ns_ += (uint64_t)ns; }
+  uint64_t GetSendTimeNs() const { return send_time_ns_; }
+
+ private:
+  const int peak_threshold_;
+  const int hangover_frames_;
+  int silent_frames_ = 0;
+  bool in_dtx_ = false;
+
+  uint64_t total_frames_ = 0;
+  uint64_t suppressed_frames_ = 0;
+  uint64_t suppressed_bytes_ = 0;
+  uint64_t send_time_ns_ = 0;
+};
+
+// largest |sample| in the buffer
+int PeakS16(const int16_t* samples, size_t count);
+}  // namespace crossdesk
+#endif
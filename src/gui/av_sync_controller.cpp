@@ -0,0 +1,140 @@
+#include "av_sync_controller.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "rd_log.h"
+
+namespace crossdesk {
+
+// lip sync stays acceptable within about one frame either way
+constexpr int64_t kSyncToleranceUs = 40000;
+// a frame is never held longer than this, whatever the audio says
+constexpr auto kMaxHoldTime = std::chrono::milliseconds(300);
+constexpr size_t kMaxQueuedFrames = 16;
+constexpr auto kReportInterval = std::chrono::seconds(10);
+
+AvSyncController::AvSyncController()
+    : last_report_(std::chrono::steady_clock::now()) {}
+
+AvSyncController::~AvSyncController() {}
+
+void AvSyncController::PushFrame(const unsigned char* data, size_t size,
+                                 uint32_t width, uint32_t height,
+                                 int64_t captured_timestamp) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (queue_.size() >= kMaxQueuedFrames) {
+    free_buffers_.push_back(std::move(queue_.front().data));
+    queue_.pop_front();
+    overflow_frames_++;
+  }
+
+  Frame frame;
+  if (!free_buffers_.empty()) {
+    frame.data = std::move(free_buffers_.back());
+    free_buffers_.pop_back();
+  }
+  frame.data.resize(size);
+  memcpy(frame.data.data(), data, size);
+  frame.width = width;
+  frame.height = height;
+  frame.captured_timestamp = captured_timestamp;
+  frame.arrival = std::chrono::steady_clock::now();
+  queue_.push_back(std::move(frame));
+}
+
+void AvSyncController::Recycle(std::vector<unsigned char>& buffer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (buffer.capacity() > 0) {
+    free_buffers_.push_back(std::move(buffer));
+  }
+  buffer.clear();
+}
+
+bool AvSyncController::PopDueFrame(bool has_audio_clock, int64_t audio_clock,
+                                   Frame& frame) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  auto now = std::chrono::steady_clock::now();
+
+  size_t due = 0;
+  for (const auto& queued : queue_) {
+    if (has_audio_clock &&
+        queued.captured_timestamp > audio_clock + kSyncToleranceUs &&
+        now - queued.arrival < kMaxHoldTime) {
+      break;
+    }
+    due++;
+  }
+
+  if (due == 0) {
+    if (!queue_.empty()) {
+      held_polls_++;
+    }
+    return false;
+  }
+
+  // only the newest due frame is worth drawing
+  for (size_t i = 0; i + 1 < due; ++i) {
+    free_buffers_.push_back(std::move(queue_.front().data));
+    queue_.pop_front();
+  }
+  skipped_frames_ += due - 1;
+
+  std::swap(frame.data, queue_.front().data);
+  if (queue_.front().data.capacity() > 0) {
+    free_buffers_.push_back(std::move(queue_.front().data));
+  }
+  frame.width = queue_.front().width;
+  frame.height = queue_.front().height;
+  frame.captured_timestamp = queue_.front().captured_timestamp;
+  frame.arrival = queue_.front().arrival;
+  queue_.pop_front();
+  lock.unlock();
+
+  if (has_audio_clock) {
+    RecordOffset(frame.captured_timestamp - audio_clock);
+  }
+  return true;
+}
+
+bool AvSyncController::HasPendingFrames() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return !queue_.empty();
+}
+
+// positive offsets mean the picture leads the sound
+void AvSyncController::RecordOffset(int64_t offset_us) {
+  if (offset_samples_ == 0) {
+    offset_min_us_ = offset_us;
+    offset_max_us_ = offset_us;
+  }
+  offset_sum_us_ += offset_us;
+  offset_min_us_ = std::min(offset_min_us_, offset_us);
+  offset_max_us_ = std::max(offset_max_us_, offset_us);
+  offset_samples_++;
+
+  auto now = std::chrono::steady_clock::now();
+  if (now - last_report_ < kReportInterval) {
+    return;
+  }
+
+  uint64_t overflow_frames = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    overflow_frames = overflow_frames_;
+    overflow_frames_ = 0;
+  }
+  LOG_INFO(
+      "[{}] A/V offset avg [{:.1f}] min [{:.1f}] max [{:.1f}] ms, held "
+      "[{}] polls, skipped [{}] frames, overflow [{}] frames",
+      name_, offset_sum_us_ / 1000.0 / offset_samples_,
+      offset_min_us_ / 1000.0, offset_max_us_ / 1000.0, held_polls_,
+      skipped_frames_, overflow_frames);
+
+  last_report_ = now;
+  offset_sum_us_ = 0;
+  offset_samples_ = 0;
+  held_polls_ = 0;
+  skipped_frames_ = 0;
+}
+}  // namespace crossdesk
@@ -0,0 +1,73 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _AV_SYNC_CONTROLLER_H_
+#define _AV_SYNC_CONTROLLER_H_
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace crossdesk {
+
+// Holds decoded video frames of one session until the audio being played
+// has reached their capture time. Both clocks are host capture timestamps
+// from GetSystemTimeMicros(). Without an audio clock, e.g. while the host
+// is silent, every frame is shown as soon as it arrives.
+class AvSyncController {
+ public:
+  struct Frame {
+    std::vector<unsigned char> data;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    int64_t captured_timestamp = 0;
+    std::chrono::steady_clock::time_point arrival;
+  };
+
+ public:
+  AvSyncController();
+  ~AvSyncController();
+
+ public:
+  void SetName(const std::string& name) { name_ = name; }
+
+  // network thread
+  void PushFrame(const unsigned char* data, size_t size, uint32_t width,
+                 uint32_t height, int64_t captured_timestamp);
+
+  // render thread: moves the newest frame that is due into |frame| and
+  // recycles the buffer |frame| held before
+  bool PopDueFrame(bool has_audio_clock, int64_t audio_clock, Frame& frame);
+  // render thread: gives a frame buffer back to the pool, |buffer| is
+  // left empty
+  void Recycle(std::vector<unsigned char>& buffer);
+  bool HasPendingFrames();
+
+ private:
+  void RecordOffset(int64_t offset_us);
+
+ private:
+  std::string name_;
+
+  std::mutex mutex_;
+  std::deque<Frame> queue_;
+  std::vector<std::vector<unsigned char>> free_buffers_;
+  uint64_t overflow_frames_ = 0;
+
+  // render thread
+  std::chrono::steady_clock::time_point last_report_;
+  int64_t offset_sum_us_ = 0;
+  int64_t offset_min_us_ = 0;
+  int64_t offset_max_us_ = 0;
+  uint64_t offset_samples_ = 0;
+  uint64_t held_polls_ = 0;
+  uint64_t skipped_frames_ = 0;
+};
+}  // namespace crossdesk
+#endif
@@ -0,0 +1,232 @@
+#include "data_channel_scheduler.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "device_controller.h"
+
+namespace crossdesk {
+
+// messages above this size are fragmented, fragments never exceed it
+constexpr size_t kMaxChunkSize = 1024;
+// type byte, message id, fragment index, fragment count
+constexpr size_t kFragmentHeaderSize =
+    1 + sizeof(uint32_t) + sizeof(uint16_t) + sizeof(uint16_t);
+constexpr size_t kMaxFragmentPayload = kMaxChunkSize - kFragmentHeaderSize;
+constexpr size_t kMaxPartialMessages = 16;
+constexpr std::array<size_t, DataChannelScheduler::kDataClassCount>
+    kMaxQueueDepth = {256, 256, 64};
+
+DataChannelScheduler::DataChannelScheduler(SendFunc send_func)
+    : send_func_(std::move(send_func)) {}
+
+DataChannelScheduler::~DataChannelScheduler() {}
+
+int DataChannelScheduler::Send(DataClass data_class, const char* data,
+                               size_t size) {
+  if (!data || size == 0 || data_class >= kDataClassCount) {
+    return -1;
+  }
+
+  uint16_t fragment_count = 0;
+  if (size > kMaxChunkSize) {
+    size_t count = (size + kMaxFragmentPayload - 1) / kMaxFragmentPayload;
+    if (count > UINT16_MAX) {
+      return -1;
+    }
+    fragment_count = (uint16_t)count;
+  }
+
+  uint64_t id = 0;
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    auto& queue = queues_[data_class];
+    auto& stats = stats_[data_class];
+    if (queue.size() >= kMaxQueueDepth[data_class]) {
+      // drop the oldest message that has not started going out, a partly
+      // sent one would leave the receiver with a hole
+      auto oldest = queue.begin();
+      if (oldest != queue.end() && oldest->offset > 0) {
+        ++oldest;
+      }
+      if (oldest == queue.end()) {
+        stats.dropped_messages++;
+        return -1;
+      }
+      queue.erase(oldest);
+      stats.dropped_messages++;
+    }
+
+    PendingMessage message;
+    message.id = id = next_id_++;
+    message.data.assign(data, data + size);
+    message.offset = 0;
+    message.message_id = fragment_count ? next_message_id_++ : 0;
+    message.fragment_index = 0;
+    message.fragment_count = fragment_count;
+    message.enqueue_time = std::chrono::steady_clock::now();
+    queue.push_back(std::move(message));
+
+    stats.queue_depth = queue.size();
+    if (stats.queue_depth > stats.max_queue_depth) {
+      stats.max_queue_depth = stats.queue_depth;
+    }
+  }
+
+  return Drain(id);
+}
+
+std::array<DataChannelScheduler::ClassStats,
+           DataChannelScheduler::kDataClassCount>
+DataChannelScheduler::GetStats() {
+  std::lock_guard<std::mutex> lock(queue_mutex_);
+  return stats_;
+}
+
+int DataChannelScheduler::Drain(uint64_t own_id) {
+  int own_result = 0;
+
+  for (;;) {
+    {
+      // only one caller drains at a time, the others just enqueue
+      std::unique_lock<std::mutex> drain_lock(drain_mutex_, std::try_to_lock);
+      if (!drain_lock.owns_lock()) {
+        return own_result;
+      }
+
+      for (;;) {
+        // take the head of the most urgent non-empty class, one chunk only
+        int data_class = 0;
+        PendingMessage message;
+        {
+          std::lock_guard<std::mutex> lock(queue_mutex_);
+          while (data_class < kDataClassCount && queues_[data_class].empty()) {
+            ++data_class;
+          }
+          if (data_class == kDataClassCount) {
+            break;
+          }
+          message = std::move(queues_[data_class].front());
+          queues_[data_class].pop_front();
+        }
+
+        bool first_chunk = message.offset == 0;
+        bool ok = SendNextChunk(message);
+        bool done = !ok || message.offset >= message.data.size();
+
+        std::lock_guard<std::mutex> lock(queue_mutex_);
+        auto& queue = queues_[data_class];
+        auto& stats = stats_[data_class];
+        if (first_chunk) {
+          double delay_ms = std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() -
+                                message.enqueue_time)
+                                .count();
+          stats.avg_queue_delay_ms +=
+              (delay_ms - stats.avg_queue_delay_ms) / 16;
+          if (delay_ms > stats.max_queue_delay_ms) {
+            stats.max_queue_delay_ms = delay_ms;
+          }
+        }
+
+        if (!ok) {
+          stats.failed_messages++;
+          if (message.id == own_id) {
+            own_result = -1;
+          }
+        } else if (done) {
+          stats.sent_messages++;
+          stats.sent_bytes += message.data.size();
+        } else {
+          // remaining fragments go back to the head of the class
+          queue.push_front(std::move(message));
+        }
+        stats.queue_depth = queue.size();
+      }
+    }
+
+    // a message queued while the drain lock was being released would
+    // otherwise wait for the next Send
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    bool empty = true;
+    for (const auto& queue : queues_) {
+      empty = empty && queue.empty();
+    }
+    if (empty) {
+      return own_result;
+    }
+  }
+}
+
+bool DataChannelScheduler::SendNextChunk(PendingMessage& message) {
+  if (message.fragment_count == 0) {
+    message.offset = message.data.size();
+    return 0 == send_func_(message.data.data(), message.data.size());
+  }
+
+  size_t payload_size =
+      std::min(kMaxFragmentPayload, message.data.size() - message.offset);
+  char chunk[kMaxChunkSize];
+  chunk[0] = static_cast<char>(ControlType::data_fragment);
+  memcpy(chunk + 1, &message.message_id, sizeof(uint32_t));
+  memcpy(chunk + 5, &message.fragment_index, sizeof(uint16_t));
+  memcpy(chunk + 7, &message.fragment_count, sizeof(uint16_t));
+  memcpy(chunk + kFragmentHeaderSize, message.data.data() + message.offset,
+         payload_size);
+
+  message.offset += payload_size;
+  message.fragment_index++;
+  return 0 == send_func_(chunk, kFragmentHeaderSize + payload_size);
+}
+
+bool DataFragmentAssembler::Push(const std::string& sender, const char* data,
+                                 size_t size, std::string& message) {
+  if (size <= kFragmentHeaderSize) {
+    return false;
+  }
+
+  uint32_t message_id;
+  uint16_t fragment_index;
+  uint16_t fragment_count;
+  memcpy(&message_id, data + 1, sizeof(uint32_t));
+  memcpy(&fragment_index, data + 5, sizeof(uint16_t));
+  memcpy(&fragment_count, data + 7, sizeof(uint16_t));
+  if (fragment_count == 0 || fragment_index >= fragment_count) {
+    return false;
+  }
+
+  std::string key = sender + "/" + std::to_string(message_id);
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (partial_messages_.size() >= kMaxPartialMessages &&
+      partial_messages_.find(key) == partial_messages_.end()) {
+    // the sender gave up on a message, or its fragments were lost
+    partial_messages_.erase(partial_messages_.begin());
+  }
+
+  PartialMessage& partial = partial_messages_[key];
+  if (partial.fragments.empty()) {
+    partial.fragments.resize(fragment_count);
+  } else if (partial.fragments.size() != fragment_count) {
+    partial_messages_.erase(key);
+    return false;
+  }
+
+  std::string& fragment = partial.fragments[fragment_index];
+  if (fragment.empty()) {
+    fragment.assign(data + kFragmentHeaderSize, size - kFragmentHeaderSize);
+    partial.received++;
+  }
+
+  if (partial.received < partial.fragments.size()) {
+    return false;
+  }
+
+  message.clear();
+  for (const std::string& part : partial.fragments) {
+    message += part;
+  }
+  partial_messages_.erase(key);
+
+  return true;
+}
+}  // namespace crossdesk
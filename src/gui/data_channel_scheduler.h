@@ -0,0 +1,96 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _DATA_CHANNEL_SCHEDULER_H_
+#define _DATA_CHANNEL_SCHEDULER_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace crossdesk {
+
+// Orders outgoing data channel messages by class. Input is always sent
+// first and large messages are cut into bounded fragments, so a bulk
+// transfer can only delay input by a single fragment.
+class DataChannelScheduler {
+ public:
+  enum DataClass { kInput = 0, kControl, kBulk, kDataClassCount };
+
+  struct ClassStats {
+    size_t queue_depth = 0;
+    size_t max_queue_depth = 0;
+    uint64_t sent_messages = 0;
+    uint64_t sent_bytes = 0;
+    uint64_t dropped_messages = 0;
+    uint64_t failed_messages = 0;
+    double avg_queue_delay_ms = 0;
+    double max_queue_delay_ms = 0;
+  };
+
+  using SendFunc = std::function<int(const char* data, size_t size)>;
+
+ public:
+  explicit DataChannelScheduler(SendFunc send_func);
+  ~DataChannelScheduler();
+
+ public:
+  // Returns -1 if the message was dropped, or if it was sent by this call
+  // and the transport rejected it. Otherwise the message is sent or will
+  // be sent by whichever caller is currently draining the queues.
+  int Send(DataClass data_class, const char* data, size_t size);
+
+  std::array<ClassStats, kDataClassCount> GetStats();
+
+ private:
+  struct PendingMessage {
+    uint64_t id;
+    std::vector<char> data;
+    size_t offset;
+    uint32_t message_id;
+    uint16_t fragment_index;
+    uint16_t fragment_count;
+    std::chrono::steady_clock::time_point enqueue_time;
+  };
+
+  int Drain(uint64_t own_id);
+  bool SendNextChunk(PendingMessage& message);
+
+ private:
+  SendFunc send_func_;
+  std::mutex queue_mutex_;
+  std::mutex drain_mutex_;
+  std::array<std::deque<PendingMessage>, kDataClassCount> queues_;
+  std::array<ClassStats, kDataClassCount> stats_;
+  uint64_t next_id_ = 1;
+  uint32_t next_message_id_ = 1;
+};
+
+// Rebuilds messages that DataChannelScheduler fragmented, per sender.
+class DataFragmentAssembler {
+ public:
+  // true once |message| holds a complete reassembled message
+  bool Push(const std::string& sender, const char* data, size_t size,
+            std::string& message);
+
+ private:
+  struct PartialMessage {
+    std::vector<std::string> fragments;
+    size_t received = 0;
+  };
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<std::string, PartialMessage> partial_messages_;
+};
+}  // namespace crossdesk
+#endif
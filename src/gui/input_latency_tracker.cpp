@@ -0,0 +1,117 @@
+#include "input_latency_tracker.h"
+
+#include <algorithm>
+
+#include "rd_log.h"
+
+namespace crossdesk {
+
+// inputs still waiting for a frame, older ones are dropped
+constexpr size_t kMaxPendingInputs = 64;
+// samples kept for the percentiles shown in the stats panel
+constexpr size_t kMaxLatencySamples = 512;
+
+InputLatencyTracker::~InputLatencyTracker() {
+  if (export_file_.is_open()) {
+    export_file_.close();
+  }
+}
+
+void InputLatencyTracker::SetExportPath(const std::string& export_path) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (export_file_.is_open()) {
+    export_file_.close();
+  }
+  export_path_ = export_path;
+}
+
+void InputLatencyTracker::OnInputInjected(uint32_t seq, int64_t input_timestamp,
+                                          int64_t inject_timestamp) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (pending_inputs_.size() >= kMaxPendingInputs) {
+    pending_inputs_.pop_front();
+  }
+  pending_inputs_.push_back({seq, input_timestamp, inject_timestamp});
+}
+
+void InputLatencyTracker::OnFrameDisplayed(int64_t captured_timestamp,
+                                           int64_t display_timestamp) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  while (!pending_inputs_.empty() &&
+         pending_inputs_.front().inject_timestamp <= captured_timestamp) {
+    const PendingInput& input = pending_inputs_.front();
+    int64_t input_to_inject = input.inject_timestamp - input.input_timestamp;
+    int64_t inject_to_display = display_timestamp - input.inject_timestamp;
+
+    if (input_to_inject_us_.size() >= kMaxLatencySamples) {
+      input_to_inject_us_.pop_front();
+      inject_to_display_us_.pop_front();
+    }
+    input_to_inject_us_.push_back(input_to_inject);
+    inject_to_display_us_.push_back(inject_to_display);
+
+    if (!export_file_.is_open() && !export_path_.empty()) {
+      export_file_.open(export_path_, std::ios::out | std::ios::trunc);
+      if (export_file_.is_open()) {
+        export_file_ << "seq,input_us,inject_us,captured_us,display_us,"
+                        "input_to_inject_us,inject_to_display_us\n";
+      } else {
+        LOG_ERROR("Open latency log [{}] failed", export_path_);
+        export_path_.clear();
+      }
+    }
+    if (export_file_.is_open()) {
+      export_file_ << input.seq << "," << input.input_timestamp << ","
+                   << input.inject_timestamp << "," << captured_timestamp
+                   << "," << display_timestamp << "," << input_to_inject << ","
+                   << inject_to_display << "\n";
+    }
+
+    pending_inputs_.pop_front();
+  }
+}
+
+InputLatencyTracker::Summary InputLatencyTracker::GetSummary() {
+  std::vector<int64_t> input_to_inject;
+  std::vector<int64_t> inject_to_display;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    input_to_inject.assign(input_to_inject_us_.begin(),
+                           input_to_inject_us_.end());
+    inject_to_display.assign(inject_to_display_us_.begin(),
+                             inject_to_display_us_.end());
+  }
+
+  Summary summary;
+  summary.samples = input_to_inject.size();
+  if (summary.samples == 0) {
+    return summary;
+  }
+
+  summary.input_to_inject_p50_ms = Percentile(input_to_inject, 0.5) / 1000.0;
+  summary.input_to_inject_p99_ms = Percentile(input_to_inject, 0.99) / 1000.0;
+  summary.inject_to_display_p50_ms =
+      Percentile(inject_to_display, 0.5) / 1000.0;
+  summary.inject_to_display_p99_ms =
+      Percentile(inject_to_display, 0.99) / 1000.0;
+
+  return summary;
+}
+
+void InputLatencyTracker::Reset() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  pending_inputs_.clear();
+  input_to_inject_us_.clear();
+  inject_to_display_us_.clear();
+  if (export_file_.is_open()) {
+    export_file_.close();
+  }
+}
+
+double InputLatencyTracker::Percentile(std::vector<int64_t>& values,
+                                       double ratio) {
+  size_t index = (size_t)(ratio * (values.size() - 1) + 0.5);
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return (double)values[index];
+}
+}  // namespace crossdesk
@@ -0,0 +1,68 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _INPUT_LATENCY_TRACKER_H_
+#define _INPUT_LATENCY_TRACKER_H_
+
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace crossdesk {
+
+// Correlates tagged remote inputs with the frames that show their effect.
+// All timestamps are GetSystemTimeMicros() values, the same clock used for
+// XVideoFrame::captured_timestamp on the host.
+class InputLatencyTracker {
+ public:
+  struct Summary {
+    size_t samples = 0;
+    double input_to_inject_p50_ms = 0;
+    double input_to_inject_p99_ms = 0;
+    double inject_to_display_p50_ms = 0;
+    double inject_to_display_p99_ms = 0;
+  };
+
+ public:
+  InputLatencyTracker() = default;
+  ~InputLatencyTracker();
+
+ public:
+  // csv file the samples are appended to, opened on the first sample
+  void SetExportPath(const std::string& export_path);
+
+  void OnInputInjected(uint32_t seq, int64_t input_timestamp,
+                       int64_t inject_timestamp);
+
+  // first displayed frame captured after an injection completes its sample
+  void OnFrameDisplayed(int64_t captured_timestamp, int64_t display_timestamp);
+
+  Summary GetSummary();
+
+  void Reset();
+
+ private:
+  struct PendingInput {
+    uint32_t seq;
+    int64_t input_timestamp;
+    int64_t inject_timestamp;
+  };
+
+  static double Percentile(std::vector<int64_t>& values, double ratio);
+
+ private:
+  std::mutex mutex_;
+  std::deque<PendingInput> pending_inputs_;
+  std::deque<int64_t> input_to_inject_us_;
+  std::deque<int64_t> inject_to_display_us_;
+  std::string export_path_;
+  std::ofstream export_file_;
+};
+}  // namespace crossdesk
+#endif
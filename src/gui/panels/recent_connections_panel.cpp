@@ -58,11 +58,26 @@ int Render::ShowRecentConnections() {
                         ImGuiWindowFlags_NoScrollWithMouse);
   ImGui::PopStyleVar();
   ImGui::PopStyleColor();
-  size_t recent_connections_count = recent_connections_.size();
-  int count = 0;
+  int recent_connections_count = (int)recent_connections_.size();
   float button_width = 22;
   float button_height = 22;
-  for (auto& it : recent_connections_) {
+  float item_spacing = 26.0f;
+  float item_stride = recent_connection_sub_container_width + item_spacing;
+
+  // only the visible items are drawn, plus one on each side so their
+  // thumbnails are already decoded when they scroll in
+  ImVec2 items_pos = ImGui::GetCursorPos();
+  float scroll_x = ImGui::GetScrollX();
+  int first_item =
+      std::max(0, (int)((scroll_x - items_pos.x) / item_stride) - 1);
+  int last_item = std::min(
+      recent_connections_count - 1,
+      (int)((scroll_x + ImGui::GetWindowWidth() - items_pos.x) /
+            item_stride) +
+          1);
+  for (int i = first_item; i <= last_item; i++) {
+    auto& it = recent_connections_[i];
+    ImGui::SetCursorPos(ImVec2(items_pos.x + i * item_stride, items_pos.y));
     sub_containers_pos[it.first] = ImGui::GetCursorPos();
     std::string recent_connection_sub_window_name =
         "RecentConnectionsSubContainer" + it.first;
@@ -76,52 +91,29 @@ int Render::ShowRecentConnections() {
                           ImGuiWindowFlags_NoTitleBar |
                           ImGuiWindowFlags_NoBringToFrontOnFocus |
                           ImGuiWindowFlags_NoScrollbar);
-    std::string connection_info = it.first;
-
-    // remote id length is 9
-    // password length is 6
-    // connection_info -> remote_id + 'Y' + host_name + '@' + password
-    //                 -> remote_id + 'N' + host_name
-    if ('Y' == connection_info[9] && connection_info.size() >= 16) {
-      size_t pos_y = connection_info.find('Y');
-      size_t pos_at = connection_info.find('@');
-
-      if (pos_y == std::string::npos || pos_at == std::string::npos ||
-          pos_y >= pos_at) {
-        LOG_ERROR("Invalid filename");
-        continue;
-      }
-
-      it.second.remote_id = connection_info.substr(0, pos_y);
-      it.second.remote_host_name =
-          connection_info.substr(pos_y + 1, pos_at - pos_y - 1);
-      it.second.password = connection_info.substr(pos_at + 1);
-      it.second.remember_password = true;
-    } else if ('N' == connection_info[9] && connection_info.size() >= 10) {
-      size_t pos_n = connection_info.find('N');
-      size_t pos_at = connection_info.find('@');
-
-      if (pos_n == std::string::npos) {
-        LOG_ERROR("Invalid filename");
-        continue;
-      }
-
-      it.second.remote_id = connection_info.substr(0, pos_n);
-      it.second.remote_host_name = connection_info.substr(pos_n + 1);
-      it.second.password = "";
-      it.second.remember_password = false;
-    } else {
-      it.second.remote_host_name = "unknown";
-    }
-
     ImVec2 image_screen_pos = ImVec2(ImGui::GetCursorScreenPos().x + 5.0f,
                                      ImGui::GetCursorScreenPos().y + 5.0f);
     ImVec2 image_pos =
         ImVec2(ImGui::GetCursorPosX() + 5.0f, ImGui::GetCursorPosY() + 5.0f);
     ImGui::SetCursorPos(image_pos);
-    ImGui::Image((ImTextureID)(intptr_t)it.second.texture,
-                 ImVec2((float)recent_connection_image_width_,
-                        (float)recent_connection_image_height_));
+    ImVec2 image_size = ImVec2((float)recent_connection_image_width_,
+                               (float)recent_connection_image_height_);
+    ThumbnailAtlas::Region region;
+    bool has_image =
+        enable_live_preview_ &&
+        thumbnail_atlas_->Lookup(
+            SessionPreviewer::AtlasKey(it.second.remote_id), &region);
+    if (!has_image) {
+      thumbnail_atlas_->Request(it.second.remote_id, it.second.image_path);
+      has_image = thumbnail_atlas_->Lookup(it.second.remote_id, &region);
+    }
+    if (has_image) {
+      ImGui::Image((ImTextureID)(intptr_t)region.texture, image_size,
+                   ImVec2(region.u0, region.v0), ImVec2(region.u1, region.v1));
+    } else {
+      // still decoding
+      ImGui::Dummy(image_size);
+    }
 
     // remote id display button
     {
@@ -175,13 +167,6 @@ int Render::ShowRecentConnections() {
         show_confirm_delete_connection_ = true;
         delete_connection_name_ = it.first;
       }
-
-      if (delete_connection_ && delete_connection_name_ == it.first) {
-        if (!thumbnail_->DeleteThumbnail(it.first)) {
-          reload_recent_connections_ = true;
-          delete_connection_ = false;
-        }
-      }
     }
 
     // connect button
@@ -204,7 +189,7 @@ int Render::ShowRecentConnections() {
 
     ImGui::EndChild();
 
-    if (count != recent_connections_count - 1) {
+    if (i != recent_connections_count - 1) {
       ImVec2 line_start =
           ImVec2(image_screen_pos.x + recent_connection_image_width_ + 20.0f,
                  image_screen_pos.y);
@@ -215,8 +200,29 @@ int Render::ShowRecentConnections() {
                                           IM_COL32(0, 0, 0, 122), 1.0f);
     }
 
-    count++;
-    ImGui::SameLine(0, count != recent_connections_count ? 26.0f : 0.0f);
+  }
+
+  // the skipped items still count for the scrollable width
+  if (recent_connections_count > 0) {
+    ImGui::SetCursorPos(
+        ImVec2(items_pos.x + recent_connections_count * item_stride -
+                   item_spacing,
+               items_pos.y));
+    ImGui::Dummy(ImVec2(0.0f, recent_connection_sub_container_height));
+  }
+
+  if (delete_connection_) {
+    for (auto& it : recent_connections_) {
+      if (delete_connection_name_ != it.first) {
+        continue;
+      }
+      if (!thumbnail_->DeleteThumbnail(it.second.remote_id)) {
+        thumbnail_atlas_->Invalidate(it.second.remote_id);
+        reload_recent_connections_ = true;
+        delete_connection_ = false;
+      }
+      break;
+    }
   }
 
   ImGui::EndChild();
@@ -142,9 +142,25 @@ int Render::ConnectTo(const std::string& remote_id, const char* password,
     auto props = client_properties_[remote_id];
     props->local_id_ = "C-" + std::string(client_id_);
     props->remote_id_ = remote_id;
+    props->input_latency_.SetExportPath(exec_log_path_ + "/latency_" +
+                                        remote_id + ".csv");
+    props->av_sync_.SetName(remote_id);
+    if (enable_audio_latency_probe_ && audio_mixer_) {
+      props->audio_latency_probe_ =
+          std::make_shared<AudioLatencyProbe>(remote_id, 48000);
+      audio_mixer_->SetLatencyProbe(remote_id, props->audio_latency_probe_);
+    }
     memcpy(&props->params_, &params_, sizeof(Params));
     props->params_.user_id = props->local_id_.c_str();
     props->peer_ = CreatePeer(&props->params_);
+    props->data_scheduler_ = std::make_unique<DataChannelScheduler>(
+        [raw_props = props.get()](const char* data, size_t size) -> int {
+          if (!raw_props->peer_) {
+            return -1;
+          }
+          return SendDataFrame(raw_props->peer_, data, size,
+                               raw_props->data_label_.c_str());
+        });
     AddAudioStream(props->peer_, props->audio_label_.c_str());
     AddDataStream(props->peer_, props->data_label_.c_str());
 
@@ -2,6 +2,7 @@
 
 #include <libyuv.h>
 
+#include <cmath>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -15,7 +16,9 @@
 #include "localization.h"
 #include "platform.h"
 #include "rd_log.h"
+#include "remote_action_codec.h"
 #include "screen_capturer_factory.h"
+#include "trace.h"
 
 #define NV12_BUFFER_SIZE 1280 * 720 * 3 / 2
 
@@ -23,100 +26,11 @@
 
 namespace crossdesk {
 
-std::vector<char> Render::SerializeRemoteAction(const RemoteAction& action) {
-  std::vector<char> buffer;
-  buffer.push_back(static_cast<char>(action.type));
-
-  auto insert_bytes = [&](const void* ptr, size_t len) {
-    buffer.insert(buffer.end(), (const char*)ptr, (const char*)ptr + len);
-  };
-
-  if (action.type == ControlType::host_infomation) {
-    insert_bytes(&action.i.host_name_size, sizeof(size_t));
-    insert_bytes(action.i.host_name, action.i.host_name_size);
-
-    size_t num = action.i.display_num;
-    insert_bytes(&num, sizeof(size_t));
-
-    for (size_t i = 0; i < num; ++i) {
-      size_t len = strlen(action.i.display_list[i]);
-      insert_bytes(&len, sizeof(size_t));
-      insert_bytes(action.i.display_list[i], len);
-    }
-
-    insert_bytes(action.i.left, sizeof(int) * num);
-    insert_bytes(action.i.top, sizeof(int) * num);
-    insert_bytes(action.i.right, sizeof(int) * num);
-    insert_bytes(action.i.bottom, sizeof(int) * num);
-  }
-
-  return buffer;
-}
-
-bool Render::DeserializeRemoteAction(const char* data, size_t size,
-                                     RemoteAction& out) {
-  size_t offset = 0;
-  auto read = [&](void* dst, size_t len) -> bool {
-    if (offset + len > size) return false;
-    memcpy(dst, data + offset, len);
-    offset += len;
-    return true;
-  };
-
-  if (size < 1) return false;
-  out.type = static_cast<ControlType>(data[offset++]);
-
-  if (out.type == ControlType::host_infomation) {
-    size_t name_len;
-    if (!read(&name_len, sizeof(size_t)) || name_len >= sizeof(out.i.host_name))
-      return false;
-    if (!read(out.i.host_name, name_len)) return false;
-    out.i.host_name[name_len] = '\0';
-    out.i.host_name_size = name_len;
-
-    size_t num;
-    if (!read(&num, sizeof(size_t))) return false;
-    out.i.display_num = num;
-
-    out.i.display_list = (char**)malloc(num * sizeof(char*));
-    for (size_t i = 0; i < num; ++i) {
-      size_t len;
-      if (!read(&len, sizeof(size_t))) return false;
-      if (offset + len > size) return false;
-      out.i.display_list[i] = (char*)malloc(len + 1);
-      memcpy(out.i.display_list[i], data + offset, len);
-      out.i.display_list[i][len] = '\0';
-      offset += len;
-    }
-
-    auto alloc_int_array = [&](int*& arr) {
-      arr = (int*)malloc(num * sizeof(int));
-      return read(arr, num * sizeof(int));
-    };
-
-    return alloc_int_array(out.i.left) && alloc_int_array(out.i.top) &&
-           alloc_int_array(out.i.right) && alloc_int_array(out.i.bottom);
-  }
-
-  return true;
-}
-
-void Render::FreeRemoteAction(RemoteAction& action) {
-  if (action.type == ControlType::host_infomation) {
-    for (size_t i = 0; i < action.i.display_num; ++i) {
-      free(action.i.display_list[i]);
-    }
-    free(action.i.display_list);
-    free(action.i.left);
-    free(action.i.top);
-    free(action.i.right);
-    free(action.i.bottom);
-
-    action.i.display_list = nullptr;
-    action.i.left = action.i.top = action.i.right = action.i.bottom = nullptr;
-    action.i.display_num = 0;
-  }
-}
+// speaker frames between two audio capture timestamps, 500 ms
+constexpr int kAudioAnchorInterval = 50;
+// audio devices idle this long are suspended
+constexpr auto kAudioIdleGracePeriod = std::chrono::seconds(2);
+constexpr auto kLivePreviewInterval = std::chrono::seconds(3);
 
 SDL_HitTestResult Render::HitTestCallback(SDL_Window* window,
                                           const SDL_Point* area, void* data) {
@@ -249,15 +163,24 @@ int Render::LoadSettingsFromCacheFile() {
   thumbnail_.reset();
   thumbnail_ = std::make_unique<Thumbnail>(cache_path_ + "/thumbnails/",
                                            aes128_key_, aes128_iv_);
+  thumbnail_->SetSaveDoneCallback([this](const std::string& remote_id) {
+    if (thumbnail_atlas_) {
+      thumbnail_atlas_->Invalidate(remote_id);
+    }
+    thumbnail_saved_ = true;
+  });
 
   language_button_value_ = (int)config_center_->GetLanguage();
   video_quality_button_value_ = (int)config_center_->GetVideoQuality();
-  video_frame_rate_button_value_ = (int)config_center_->GetVideoFrameRate();
   video_encode_format_button_value_ =
       (int)config_center_->GetVideoEncodeFormat();
   enable_hardware_video_codec_ = config_center_->IsHardwareVideoCodec();
   enable_turn_ = config_center_->IsEnableTurn();
   enable_srtp_ = config_center_->IsEnableSrtp();
+  mute_background_tabs_ = config_center_->IsMuteBackgroundTabs();
+  enable_audio_latency_probe_ = config_center_->IsAudioLatencyProbe();
+  enable_live_preview_ = config_center_->IsLivePreview();
+  UpdateCaptureLimits();
 
   language_button_value_last_ = language_button_value_;
   video_quality_button_value_last_ = video_quality_button_value_;
@@ -276,33 +199,60 @@ int Render::ScreenCapturerInit() {
     screen_capturer_ = (ScreenCapturer*)screen_capturer_factory_->Create();
   }
 
-  last_frame_time_ = std::chrono::duration_cast<std::chrono::milliseconds>(
-                         std::chrono::steady_clock::now().time_since_epoch())
-                         .count();
-  int fps = config_center_->GetVideoFrameRate() ==
-                    ConfigCenter::VIDEO_FRAME_RATE::FPS_30
-                ? 30
-                : 60;
+  UpdateCaptureLimits();
+  next_capture_time_us_ = 0;
+  int fps = capture_limits_->fps;
   LOG_INFO("Init screen capturer with {} fps", fps);
 
   int screen_capturer_init_ret = screen_capturer_->Init(
       fps,
-      [this, fps](unsigned char* data, int size, int width, int height,
-                  const char* display_name) -> void {
-        auto now_time = std::chrono::duration_cast<std::chrono::milliseconds>(
-                            std::chrono::steady_clock::now().time_since_epoch())
-                            .count();
-        auto duration = now_time - last_frame_time_;
-        if (duration * fps >= 1000) {  // ~60 FPS
-          XVideoFrame frame;
-          frame.data = (const char*)data;
-          frame.size = size;
-          frame.width = width;
-          frame.height = height;
-          frame.captured_timestamp = GetSystemTimeMicros(peer_);
-          SendVideoFrame(peer_, &frame, display_name);
-          last_frame_time_ = now_time;
+      [this](unsigned char* data, int size, int width, int height,
+             const char* display_name) -> void {
+        TraceRecordEvent(TraceEvent::capture, width, height, size);
+        auto limits = std::atomic_load(&capture_limits_);
+
+        // paced by deadline, so a 60 Hz source still yields 60 fps
+        int64_t now_us =
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        int64_t interval_us = 1000000 / limits->fps;
+        if (now_us + interval_us / 8 < next_capture_time_us_) {
+          return;
+        }
+        next_capture_time_us_ = std::max(next_capture_time_us_ + interval_us,
+                                         now_us + interval_us / 2);
+
+        int max_height = limits->max_height;
+        auto it = limits->display_max_heights.find(display_name);
+        if (it != limits->display_max_heights.end()) {
+          max_height = it->second;
         }
+
+        XVideoFrame frame;
+        frame.data = (const char*)data;
+        frame.size = size;
+        frame.width = width;
+        frame.height = height;
+        if (max_height > 0 && height > max_height) {
+          int dst_height = max_height & ~1;
+          int dst_width = (int)((int64_t)width * dst_height / height) & ~1;
+          int dst_size = dst_width * dst_height * 3 / 2;
+          capture_scale_buffer_.resize(dst_size);
+          uint8_t* dst_y = capture_scale_buffer_.data();
+          uint8_t* dst_uv = dst_y + dst_width * dst_height;
+          libyuv::NV12Scale(data, width, data + width * height, width, width,
+                            height, dst_y, dst_width, dst_uv, dst_width,
+                            dst_width, dst_height, libyuv::kFilterBox);
+          frame.data = (const char*)capture_scale_buffer_.data();
+          frame.size = dst_size;
+          frame.width = dst_width;
+          frame.height = dst_height;
+        }
+        frame.captured_timestamp = GetSystemTimeMicros(peer_);
+        SendVideoFrame(peer_, &frame, display_name);
+        TraceRecordEvent(TraceEvent::send_video, (uint32_t)frame.size,
+                         frame.captured_timestamp);
       });
 
   if (0 == screen_capturer_init_ret) {
@@ -341,23 +291,23 @@ int Render::StopScreenCapturer() {
 int Render::StartSpeakerCapturer() {
   if (!speaker_capturer_) {
     speaker_capturer_ = (SpeakerCapturer*)speaker_capturer_factory_->Create();
+    speaker_capturer_->SetResampleQuality(
+        (ResampleQuality)config_center_->GetAudioResampleQuality());
     int speaker_capturer_init_ret =
         speaker_capturer_->Init([this](unsigned char* data, size_t size,
                                        const char* audio_name) -> void {
-          SendAudioFrame(peer_, (const char*)data, size, audio_label_.c_str());
+          SendSpeakerFrame(data, size);
         });
 
     if (0 != speaker_capturer_init_ret) {
       speaker_capturer_->Destroy();
       delete speaker_capturer_;
       speaker_capturer_ = nullptr;
+      return -1;
     }
   }
 
-  if (speaker_capturer_) {
-    speaker_capturer_->Start();
-  }
-  return 0;
+  return speaker_capturer_->Start();
 }
 
 int Render::StopSpeakerCapturer() {
@@ -365,9 +315,133 @@ int Render::StopSpeakerCapturer() {
     speaker_capturer_->Stop();
   }
 
+  uint64_t total_frames = audio_silence_detector_.GetTotalFrames();
+  if (total_frames > 0) {
+    uint64_t suppressed = audio_silence_detector_.GetSuppressedFrames();
+    uint64_t sent = total_frames - suppressed;
+    double send_us =
+        sent > 0 ? audio_silence_detector_.GetSendTimeNs() / 1000.0 / sent
+                 : 0;
+    LOG_INFO(
+        "Speaker DTX suppressed [{}/{}] frames, [{}] bytes, sending took "
+        "[{:.1f}] us per frame, about [{:.1f}] ms saved",
+        suppressed, total_frames, audio_silence_detector_.GetSuppressedBytes(),
+        send_us, send_us * suppressed / 1000.0);
+  }
+  audio_silence_detector_.Reset();
+  audio_anchor_pending_ = true;
+
   return 0;
 }
 
+void Render::SetAudioCaptureDemand(const std::string& remote_id,
+                                   bool enable) {
+  {
+    std::lock_guard<std::mutex> lock(audio_capture_mutex_);
+    if (enable) {
+      audio_capture_viewers_.insert(remote_id);
+    } else {
+      audio_capture_viewers_.erase(remote_id);
+    }
+  }
+
+  // start right away, stopping waits for the grace period in Poll
+  if (enable && capture_monitor_) {
+    capture_monitor_->Touch();
+  }
+}
+
+bool Render::HasAudioCaptureDemand() {
+  std::lock_guard<std::mutex> lock(audio_capture_mutex_);
+  return !audio_capture_viewers_.empty();
+}
+
+void Render::SendSpeakerFrame(unsigned char* data, size_t size) {
+  if (capture_monitor_) {
+    capture_monitor_->OnWakeup();
+  }
+
+  // the callback fires once the last sample of the frame is captured
+  int64_t frame_duration_us = (int64_t)(size / sizeof(int16_t)) * 1000000 /
+                              AudioFormatConverter::kOutputSampleRate;
+  int64_t captured_timestamp = GetSystemTimeMicros(peer_) - frame_duration_us;
+
+  bool probe = enable_audio_latency_probe_ &&
+               ++audio_frames_since_probe_ >= AudioLatencyProbe::kInterval;
+  int64_t probe_timestamp = 0;
+  if (probe) {
+    audio_frames_since_probe_ = 0;
+    AudioLatencyProbe::FillTone((int16_t*)data, size / sizeof(int16_t),
+                                AudioFormatConverter::kOutputSampleRate);
+    probe_timestamp = GetSystemTimeMicros(peer_);
+  }
+
+  bool was_in_dtx = audio_silence_detector_.InDtx();
+  if (audio_silence_detector_.Process((const int16_t*)data,
+                                      size / sizeof(int16_t))) {
+    auto send_start = std::chrono::steady_clock::now();
+    SendAudioFrame(peer_, (const char*)data, size, audio_label_.c_str());
+    audio_silence_detector_.AddSendTime(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - send_start)
+            .count());
+    TraceRecordEvent(TraceEvent::send_audio, size);
+
+    if (probe && data_scheduler_) {
+      RemoteAction remote_action;
+      remote_action.type = ControlType::audio_probe;
+      remote_action.seq = audio_probe_seq_++;
+      remote_action.timestamp = probe_timestamp;
+      data_scheduler_->Send(DataChannelScheduler::kControl,
+                            (const char*)&remote_action,
+                            sizeof(remote_action));
+    }
+
+    // let viewers map played samples back to capture time, again right
+    // after every silent gap
+    if (audio_anchor_pending_ || was_in_dtx ||
+        ++audio_frames_since_anchor_ >= kAudioAnchorInterval) {
+      audio_anchor_pending_ = false;
+      audio_frames_since_anchor_ = 0;
+      if (data_scheduler_) {
+        RemoteAction remote_action;
+        remote_action.type = ControlType::audio_timing;
+        remote_action.seq = 0;
+        remote_action.timestamp = captured_timestamp;
+        data_scheduler_->Send(DataChannelScheduler::kControl,
+                              (const char*)&remote_action,
+                              sizeof(remote_action));
+      }
+    }
+    return;
+  }
+
+  // tell viewers the gap that follows is silence, not loss
+  if (!was_in_dtx && data_scheduler_) {
+    RemoteAction remote_action;
+    remote_action.type = ControlType::audio_silence;
+    remote_action.a = true;
+    remote_action.seq = 0;
+    remote_action.timestamp = 0;
+    data_scheduler_->Send(DataChannelScheduler::kControl,
+                          (const char*)&remote_action, sizeof(remote_action));
+  }
+}
+
+void Render::UpdateAudioFanoutTargets() {
+  AudioFanoutSender::Targets targets;
+  for (auto& [_, props] : client_properties_) {
+    if (props->peer_ &&
+        props->connection_status_ == ConnectionStatus::Connected) {
+      targets.push_back(props->peer_);
+    }
+  }
+
+  if (targets != *audio_fanout_sender_.GetTargets()) {
+    audio_fanout_sender_.SetTargets(std::move(targets));
+  }
+}
+
 int Render::StartMouseController() {
   if (!device_controller_factory_) {
     LOG_INFO("Device controller factory is nullptr");
@@ -507,6 +581,15 @@ int Render::CreateConnectionPeer() {
   params_.user_data = this;
 
   peer_ = CreatePeer(&params_);
+  if (!data_scheduler_) {
+    data_scheduler_ = std::make_unique<DataChannelScheduler>(
+        [this](const char* data, size_t size) -> int {
+          if (!peer_) {
+            return -1;
+          }
+          return SendDataFrame(peer_, data, size, data_label_.c_str());
+        });
+  }
   if (peer_) {
     LOG_INFO("Create peer instance [{}] successful", client_id_);
     Init(peer_);
@@ -534,28 +617,53 @@ int Render::AudioDeviceInit() {
   desired_out.format = SDL_AUDIO_S16;
   desired_out.channels = 1;
 
-  output_stream_ = SDL_OpenAudioDeviceStream(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK,
-                                             &desired_out, nullptr, nullptr);
+  audio_mixer_ = std::make_unique<AudioMixer>(desired_out.freq);
+  audio_fanout_sender_.Start(audio_label_);
+  output_stream_ = SDL_OpenAudioDeviceStream(
+      SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &desired_out, SdlPlaybackAudio, this);
   if (!output_stream_) {
     LOG_ERROR("Failed to open output stream: {}", SDL_GetError());
     return -1;
   }
 
   SDL_ResumeAudioDevice(SDL_GetAudioStreamDevice(output_stream_));
+  playback_monitor_ = std::make_unique<AudioIdleMonitor>(
+      "playback", kAudioIdleGracePeriod, AudioIdleMonitor::State::running,
+      [this]() {
+        return SDL_PauseAudioDevice(SDL_GetAudioStreamDevice(output_stream_))
+                   ? 0
+                   : -1;
+      },
+      [this]() {
+        return SDL_ResumeAudioDevice(SDL_GetAudioStreamDevice(output_stream_))
+                   ? 0
+                   : -1;
+      });
 
   return 0;
 }
 
 int Render::AudioDeviceDestroy() {
+  playback_monitor_.reset();
   if (output_stream_) {
     SDL_CloseAudioDevice(SDL_GetAudioStreamDevice(output_stream_));
     SDL_DestroyAudioStream(output_stream_);
     output_stream_ = nullptr;
   }
+  audio_mixer_.reset();
+  audio_fanout_sender_.Stop();
   return 0;
 }
 
 void Render::UpdateInteractions() {
+  if (capture_monitor_) {
+    capture_monitor_->Poll(HasAudioCaptureDemand());
+  }
+  if (playback_monitor_) {
+    // playback demand only comes from audible packets, see Touch
+    playback_monitor_->Poll(false);
+  }
+
   if (start_screen_capturer_ && !screen_capturer_is_started_) {
     StartScreenCapturer();
     screen_capturer_is_started_ = true;
@@ -608,6 +716,13 @@ int Render::CreateMainWindow() {
   // for window region action
   SDL_SetWindowHitTest(main_window_, HitTestCallback, this);
 
+  // 8 x 8 cells, far more than the panel ever shows at once
+  thumbnail_atlas_ = std::make_unique<ThumbnailAtlas>(
+      recent_connection_image_width_, recent_connection_image_height_, 8, 8);
+  session_previewer_ = std::make_unique<SessionPreviewer>(
+      recent_connection_image_width_, recent_connection_image_height_,
+      kLivePreviewInterval);
+
 #if _WIN32
   SDL_PropertiesID props = SDL_GetWindowProperties(main_window_);
   HWND main_hwnd = (HWND)SDL_GetPointerProperty(
@@ -627,6 +742,10 @@ int Render::DestroyMainWindow() {
     ImGui::SetCurrentContext(main_ctx_);
   }
 
+  if (thumbnail_atlas_) {
+    thumbnail_atlas_->Clear();
+  }
+
   if (main_renderer_) {
     SDL_DestroyRenderer(main_renderer_);
   }
@@ -875,9 +994,11 @@ int Render::DrawStreamWindow() {
   ImGui::Render();
   SDL_RenderClear(stream_renderer_);
 
+  uint32_t sessions_shown = 0;
   for (auto& it : client_properties_) {
     auto props = it.second;
     if (props->tab_selected_) {
+      sessions_shown++;
       SDL_FRect render_rect_f = {
           static_cast<float>(props->stream_render_rect_.x),
           static_cast<float>(props->stream_render_rect_.y),
@@ -889,6 +1010,7 @@ int Render::DrawStreamWindow() {
   }
   ImGui_ImplSDLRenderer3_RenderDrawData(ImGui::GetDrawData(), stream_renderer_);
   SDL_RenderPresent(stream_renderer_);
+  TraceRecordEvent(TraceEvent::present, sessions_shown);
 
   return 0;
 }
@@ -934,11 +1056,19 @@ int Render::Run() {
   return 0;
 }
 
-void Render::InitializeLogger() { InitLogger(exec_log_path_); }
+void Render::InitializeLogger() {
+  InitLogger(exec_log_path_);
+  TraceSetThreadName("render");
+  TraceInit(exec_log_path_);
+}
 
 void Render::InitializeSettings() {
   LoadSettingsFromCacheFile();
 
+  config_watcher_ = std::make_unique<ConfigWatcher>(
+      cache_path_ + "/config.ini", [this]() { config_file_changed_ = true; });
+  config_watcher_->Start();
+
   localization_language_ = (ConfigCenter::LANGUAGE)language_button_value_;
   localization_language_index_ = language_button_value_;
   if (localization_language_index_ != 0 && localization_language_index_ != 1) {
@@ -973,6 +1103,10 @@ void Render::InitializeModules() {
     AudioDeviceInit();
     screen_capturer_factory_ = new ScreenCapturerFactory();
     speaker_capturer_factory_ = new SpeakerCapturerFactory();
+    capture_monitor_ = std::make_unique<AudioIdleMonitor>(
+        "capture", kAudioIdleGracePeriod, AudioIdleMonitor::State::suspended,
+        [this]() { return StopSpeakerCapturer(); },
+        [this]() { return StartSpeakerCapturer(); });
     device_controller_factory_ = new DeviceControllerFactory();
     keyboard_capturer_ = (KeyboardCapturer*)device_controller_factory_->Create(
         DeviceControllerFactory::Device::Keyboard);
@@ -1000,6 +1134,22 @@ void Render::MainLoop() {
       ProcessSdlEvent(event);
     }
 
+    // frames held back for lip sync get no refresh event of their own
+    if (stream_renderer_) {
+      for (auto& it : client_properties_) {
+        if (it.second->av_sync_.HasPendingFrames()) {
+          RefreshStreamTexture(it.second.get());
+        }
+      }
+    }
+
+    // probe results are matched here, off the audio and network threads
+    for (auto& it : client_properties_) {
+      if (it.second->audio_latency_probe_) {
+        it.second->audio_latency_probe_->Process();
+      }
+    }
+
 #if _WIN32
     MSG msg;
     while (PeekMessage(&msg, nullptr, 0, 0, PM_REMOVE)) {
@@ -1008,9 +1158,13 @@ void Render::MainLoop() {
     }
 #endif
 
+    HandleConfigChanges();
     UpdateLabels();
     HandleRecentConnections();
     HandleStreamWindow();
+    if (audio_fanout_targets_dirty_.exchange(false)) {
+      UpdateAudioFanoutTargets();
+    }
 
     DrawMainWindow();
     if (stream_window_inited_) {
@@ -1054,13 +1208,54 @@ void Render::MainLoop() {
       remote_action.i.host_name_size = host_name.size();
 
       std::vector<char> serialized = SerializeRemoteAction(remote_action);
-      int ret = SendDataFrame(peer_, serialized.data(), serialized.size(),
-                              data_label_.c_str());
+      int ret =
+          data_scheduler_->Send(DataChannelScheduler::kBulk, serialized.data(),
+                                serialized.size());
       FreeRemoteAction(remote_action);
       if (0 == ret) {
         need_to_send_host_info_ = false;
       }
     }
+
+    if (screen_capturer_is_started_ && mouse_controller_) {
+      SendCursorInfo();
+    }
+  }
+}
+
+void Render::SendCursorInfo() {
+  // ignore sub-pixel jitter, about a pixel on a 4K display
+  constexpr float kCursorMoveThreshold = 0.0002f;
+  // the query is a round trip to the window system, keep it at 60 Hz
+  constexpr uint32_t kCursorQueryIntervalMs = 16;
+
+  uint32_t now_time = SDL_GetTicks();
+  if (now_time - last_cursor_query_time_ < kCursorQueryIntervalMs) {
+    return;
+  }
+  last_cursor_query_time_ = now_time;
+
+  CursorInfo cursor_info;
+  if (0 != mouse_controller_->GetCursorState(selected_display_, &cursor_info)) {
+    return;
+  }
+
+  if (cursor_info_sent_ && cursor_info.style == last_cursor_info_.style &&
+      std::abs(cursor_info.x - last_cursor_info_.x) < kCursorMoveThreshold &&
+      std::abs(cursor_info.y - last_cursor_info_.y) < kCursorMoveThreshold) {
+    return;
+  }
+
+  RemoteAction remote_action;
+  remote_action.type = ControlType::cursor_info;
+  remote_action.c = cursor_info;
+  remote_action.seq = 0;
+  remote_action.timestamp = 0;
+  if (0 == data_scheduler_->Send(DataChannelScheduler::kInput,
+                                 (const char*)&remote_action,
+                                 sizeof(remote_action))) {
+    last_cursor_info_ = cursor_info;
+    cursor_info_sent_ = true;
   }
 }
 
@@ -1076,19 +1271,134 @@ void Render::UpdateLabels() {
   }
 }
 
+void Render::UpdateCaptureLimits() {
+  auto limits = std::make_shared<CaptureLimits>();
+  limits->fps = config_center_->GetVideoFps();
+  limits->max_height = config_center_->GetMaxCaptureHeight();
+  limits->display_max_heights = config_center_->GetDisplayMaxCaptureHeights();
+
+  video_fps_value_ = limits->fps;
+  video_fps_value_last_ = video_fps_value_;
+  max_capture_resolution_button_value_ = 0;
+  for (int i = 0; i < IM_ARRAYSIZE(kMaxCaptureHeights); ++i) {
+    // a custom limit shows as the largest choice below it
+    if (kMaxCaptureHeights[i] > 0 &&
+        kMaxCaptureHeights[i] <= limits->max_height) {
+      max_capture_resolution_button_value_ = i;
+    }
+  }
+  max_capture_resolution_button_value_last_ =
+      max_capture_resolution_button_value_;
+
+  if (screen_capturer_ &&
+      limits->fps != std::atomic_load(&capture_limits_)->fps) {
+    screen_capturer_->SetFps(limits->fps);
+    LOG_INFO("Capture frame rate changed to {} fps", limits->fps);
+  }
+  std::atomic_store(&capture_limits_,
+                    std::shared_ptr<const CaptureLimits>(std::move(limits)));
+}
+
+void Render::HandleConfigChanges() {
+  if (config_file_changed_.exchange(false)) {
+    uint32_t changed = config_center_->Reload();
+    if (changed) {
+      LOG_INFO("Config file changed, apply [{:#x}]", changed);
+    }
+
+    if (changed & ConfigCenter::kLanguageChanged) {
+      language_button_value_ = (int)config_center_->GetLanguage();
+      language_button_value_last_ = language_button_value_;
+      localization_language_ = config_center_->GetLanguage();
+      localization_language_index_ = language_button_value_ == 1 ? 1 : 0;
+    }
+
+    if (changed & ConfigCenter::kVideoQualityChanged) {
+      video_quality_button_value_ = (int)config_center_->GetVideoQuality();
+      video_quality_button_value_last_ = video_quality_button_value_;
+    }
+
+    // running capturers switch rate in place, sessions keep going
+    if (changed & (ConfigCenter::kVideoFrameRateChanged |
+                   ConfigCenter::kCaptureResolutionChanged)) {
+      UpdateCaptureLimits();
+    }
+
+    if (changed & ConfigCenter::kVideoCodecChanged) {
+      video_encode_format_button_value_ =
+          (int)config_center_->GetVideoEncodeFormat();
+      video_encode_format_button_value_last_ =
+          video_encode_format_button_value_;
+      enable_hardware_video_codec_ = config_center_->IsHardwareVideoCodec();
+      enable_hardware_video_codec_last_ = enable_hardware_video_codec_;
+    }
+
+    if (changed & ConfigCenter::kConnectionChanged) {
+      enable_turn_ = config_center_->IsEnableTurn();
+      enable_turn_last_ = enable_turn_;
+      enable_srtp_ = config_center_->IsEnableSrtp();
+      enable_srtp_last_ = enable_srtp_;
+      enable_self_hosted_server_ = config_center_->IsSelfHosted();
+    }
+
+    // the peer takes these at creation only
+    if (changed &
+        (ConfigCenter::kVideoCodecChanged | ConfigCenter::kConnectionChanged)) {
+      peer_recreate_pending_ = true;
+    }
+
+    if (changed & ConfigCenter::kAudioChanged) {
+      mute_background_tabs_ = config_center_->IsMuteBackgroundTabs();
+      enable_audio_latency_probe_ = config_center_->IsAudioLatencyProbe();
+      // used from the next speaker capturer start
+      if (speaker_capturer_) {
+        speaker_capturer_->SetResampleQuality(
+            (ResampleQuality)config_center_->GetAudioResampleQuality());
+      }
+    }
+
+    if (changed & ConfigCenter::kInterfaceChanged) {
+      enable_minimize_to_tray_ = config_center_->IsMinimizeToTray();
+      enable_minimize_to_tray_last_ = enable_minimize_to_tray_;
+      enable_live_preview_ = config_center_->IsLivePreview();
+    }
+  }
+
+  // wait for the sessions in both directions to end instead of dropping them
+  if (peer_recreate_pending_ && !stream_window_inited_ &&
+      !start_screen_capturer_) {
+    peer_recreate_pending_ = false;
+    LOG_INFO("Recreate peer instance for the changed config");
+    CleanupPeers();
+    CreateConnectionPeer();
+  }
+}
+
 void Render::HandleRecentConnections() {
+  if (thumbnail_saved_.exchange(false)) {
+    reload_recent_connections_ = true;
+  }
+
   if (reload_recent_connections_ && main_renderer_) {
     uint32_t now_time = SDL_GetTicks();
     if (now_time - recent_connection_image_save_time_ >= 50) {
-      int ret = thumbnail_->LoadThumbnail(main_renderer_, recent_connections_,
-                                          &recent_connection_image_width_,
-                                          &recent_connection_image_height_);
+      int ret = thumbnail_->LoadThumbnail(recent_connections_);
       if (!ret) {
         LOG_INFO("Load recent connection thumbnails");
       }
       reload_recent_connections_ = false;
     }
   }
+
+  if (main_renderer_ && thumbnail_atlas_) {
+    if (session_previewer_) {
+      for (auto& preview : session_previewer_->TakePreviews()) {
+        thumbnail_atlas_->Store(SessionPreviewer::AtlasKey(preview.remote_id),
+                                std::move(preview.rgba));
+      }
+    }
+    thumbnail_atlas_->Upload(main_renderer_);
+  }
 }
 
 void Render::HandleStreamWindow() {
@@ -1110,12 +1420,15 @@ void Render::HandleStreamWindow() {
 }
 
 void Render::Cleanup() {
+  config_watcher_.reset();
+
   if (screen_capturer_) {
     screen_capturer_->Destroy();
     delete screen_capturer_;
     screen_capturer_ = nullptr;
   }
 
+  capture_monitor_.reset();
   if (speaker_capturer_) {
     speaker_capturer_->Destroy();
     delete speaker_capturer_;
@@ -1158,22 +1471,49 @@ void Render::CleanupFactories() {
   }
 }
 
+void Render::SaveThumbnail(SubStreamWindowProperties* props,
+                           const std::string& remote_id) {
+  Thumbnail::SaveJob job;
+  // copied once per session, then dropped so it is saved only once
+  std::vector<unsigned char>& frame = props->av_sync_frame_.data;
+  if (!frame.empty()) {
+    job.nv12.reset(new unsigned char[frame.size()]);
+    memcpy(job.nv12.get(), frame.data(), frame.size());
+    std::vector<unsigned char>().swap(frame);
+  }
+  job.width = props->video_width_;
+  job.height = props->video_height_;
+  job.remote_id = remote_id;
+  job.host_name = props->remote_host_name_;
+  job.password = props->remember_password_ ? props->remote_password_ : "";
+  thumbnail_->SaveToThumbnailAsync(std::move(job));
+}
+
 void Render::CleanupPeer(std::shared_ptr<SubStreamWindowProperties> props) {
   SDL_FlushEvent(STREAM_REFRESH_EVENT);
 
-  if (props->dst_buffer_) {
-    thumbnail_->SaveToThumbnail(
-        (char*)props->dst_buffer_, props->video_width_, props->video_height_,
-        props->remote_id_, props->remote_host_name_,
-        props->remember_password_ ? props->remote_password_ : "");
+  if (!props->av_sync_frame_.data.empty()) {
+    SaveThumbnail(props.get(), props->remote_id_);
   }
 
   if (props->peer_) {
     LOG_INFO("[{}] Leave connection [{}]", props->local_id_, props->remote_id_);
     LeaveConnection(props->peer_, props->remote_id_.c_str());
+    audio_fanout_sender_.RemoveTarget(props->peer_);
     LOG_INFO("Destroy peer [{}]", props->local_id_);
     DestroyPeer(&props->peer_);
   }
+
+  if (audio_mixer_) {
+    audio_mixer_->RemoveSession(props->remote_id_);
+  }
+
+  if (session_previewer_) {
+    session_previewer_->Remove(props->remote_id_);
+  }
+  if (thumbnail_atlas_) {
+    thumbnail_atlas_->Invalidate(SessionPreviewer::AtlasKey(props->remote_id_));
+  }
 }
 
 void Render::CleanupPeers() {
@@ -1200,10 +1540,7 @@ void Render::CleanSubStreamWindowProperties(
     props->stream_texture_ = nullptr;
   }
 
-  if (props->dst_buffer_) {
-    delete[] props->dst_buffer_;
-    props->dst_buffer_ = nullptr;
-  }
+  std::vector<unsigned char>().swap(props->av_sync_frame_.data);
 }
 
 void Render::UpdateRenderRect() {
@@ -1282,10 +1619,7 @@ void Render::ProcessSdlEvent(const SDL_Event& event) {
         DestroyStreamWindowContext();
 
         for (auto& [host_name, props] : client_properties_) {
-          thumbnail_->SaveToThumbnail(
-              (char*)props->dst_buffer_, props->video_width_,
-              props->video_height_, host_name, props->remote_host_name_,
-              props->remember_password_ ? props->remote_password_ : "");
+          SaveThumbnail(props.get(), host_name);
 
           if (props->peer_) {
             std::string client_id = (host_name == client_id_)
@@ -1367,71 +1701,128 @@ void Render::ProcessSdlEvent(const SDL_Event& event) {
     default:
       if (event.type == STREAM_REFRESH_EVENT) {
         auto* props = static_cast<SubStreamWindowProperties*>(event.user.data1);
-        if (!props) {
-          break;
+        if (props) {
+          RefreshStreamTexture(props);
         }
-        if (props->video_width_ <= 0 || props->video_height_ <= 0) {
-          break;
-        }
-        if (!props->dst_buffer_) {
-          break;
-        }
-
-        if (props->stream_texture_) {
-          if (props->video_width_ != props->texture_width_ ||
-              props->video_height_ != props->texture_height_) {
-            props->texture_width_ = props->video_width_;
-            props->texture_height_ = props->video_height_;
-
-            SDL_DestroyTexture(props->stream_texture_);
-            // props->stream_texture_ = SDL_CreateTexture(
-            //     stream_renderer_, stream_pixformat_,
-            //     SDL_TEXTUREACCESS_STREAMING, props->texture_width_,
-            //     props->texture_height_);
-
-            SDL_PropertiesID nvProps = SDL_CreateProperties();
-            SDL_SetNumberProperty(nvProps, SDL_PROP_TEXTURE_CREATE_WIDTH_NUMBER,
-                                  props->texture_width_);
-            SDL_SetNumberProperty(nvProps,
-                                  SDL_PROP_TEXTURE_CREATE_HEIGHT_NUMBER,
-                                  props->texture_height_);
-            SDL_SetNumberProperty(nvProps,
-                                  SDL_PROP_TEXTURE_CREATE_FORMAT_NUMBER,
-                                  SDL_PIXELFORMAT_NV12);
-            SDL_SetNumberProperty(nvProps,
-                                  SDL_PROP_TEXTURE_CREATE_COLORSPACE_NUMBER,
-                                  SDL_COLORSPACE_BT601_LIMITED);
-            props->stream_texture_ =
-                SDL_CreateTextureWithProperties(stream_renderer_, nvProps);
-            SDL_DestroyProperties(nvProps);
-          }
-        } else {
-          props->texture_width_ = props->video_width_;
-          props->texture_height_ = props->video_height_;
-          // props->stream_texture_ = SDL_CreateTexture(
-          //     stream_renderer_, stream_pixformat_,
-          //     SDL_TEXTUREACCESS_STREAMING, props->texture_width_,
-          //     props->texture_height_);
-
-          SDL_PropertiesID nvProps = SDL_CreateProperties();
-          SDL_SetNumberProperty(nvProps, SDL_PROP_TEXTURE_CREATE_WIDTH_NUMBER,
-                                props->texture_width_);
-          SDL_SetNumberProperty(nvProps, SDL_PROP_TEXTURE_CREATE_HEIGHT_NUMBER,
-                                props->texture_height_);
-          SDL_SetNumberProperty(nvProps, SDL_PROP_TEXTURE_CREATE_FORMAT_NUMBER,
-                                SDL_PIXELFORMAT_NV12);
-          SDL_SetNumberProperty(nvProps,
-                                SDL_PROP_TEXTURE_CREATE_COLORSPACE_NUMBER,
-                                SDL_COLORSPACE_BT601_LIMITED);
-          props->stream_texture_ =
-              SDL_CreateTextureWithProperties(stream_renderer_, nvProps);
-          SDL_DestroyProperties(nvProps);
-        }
-
-        SDL_UpdateTexture(props->stream_texture_, NULL, props->dst_buffer_,
-                          props->texture_width_);
       }
       break;
   }
 }
+
+bool Render::PresentVideoFrame(SubStreamWindowProperties* props) {
+  int64_t audio_clock = 0;
+  bool has_audio_clock =
+      audio_mixer_ &&
+      0 == audio_mixer_->GetPlayoutTimestamp(props->remote_id_, &audio_clock);
+  AvSyncController::Frame& frame = props->av_sync_frame_;
+
+  // the frame leaving the screen goes to the previewer instead of back to
+  // the sync queue, so the one on screen stays for thumbnails
+  bool preview = enable_live_preview_ && session_previewer_ &&
+                 !frame.data.empty() &&
+                 session_previewer_->IsDue(props->remote_id_);
+  std::vector<unsigned char> outgoing;
+  uint32_t outgoing_width = frame.width;
+  uint32_t outgoing_height = frame.height;
+  if (preview) {
+    outgoing.swap(frame.data);
+  }
+  if (!props->av_sync_.PopDueFrame(has_audio_clock, audio_clock, frame)) {
+    if (preview) {
+      outgoing.swap(frame.data);
+    }
+    return false;
+  }
+  if (preview) {
+    // hands back the buffer of the previous preview, the queue reuses it
+    session_previewer_->Submit(props->remote_id_, outgoing,
+                               (int)outgoing_width, (int)outgoing_height);
+    props->av_sync_.Recycle(outgoing);
+  }
+
+  size_t size = frame.data.size();
+  props->captured_timestamp_ = frame.captured_timestamp;
+
+  bool need_to_update_render_rect = false;
+  if (props->video_width_ != props->video_width_last_ ||
+      props->video_height_ != props->video_height_last_) {
+    need_to_update_render_rect = true;
+    props->video_width_last_ = props->video_width_;
+    props->video_height_last_ = props->video_height_;
+  }
+  props->video_width_ = frame.width;
+  props->video_height_ = frame.height;
+  props->video_size_ = size;
+
+  if (need_to_update_render_rect) {
+    UpdateRenderRect();
+  }
+  return true;
+}
+
+void Render::RefreshStreamTexture(SubStreamWindowProperties* props) {
+  if (!PresentVideoFrame(props)) {
+    return;
+  }
+  if (props->video_width_ <= 0 || props->video_height_ <= 0) {
+    return;
+  }
+  if (props->av_sync_frame_.data.empty()) {
+    return;
+  }
+
+  if (props->stream_texture_) {
+    if (props->video_width_ != props->texture_width_ ||
+        props->video_height_ != props->texture_height_) {
+      props->texture_width_ = props->video_width_;
+      props->texture_height_ = props->video_height_;
+
+      SDL_DestroyTexture(props->stream_texture_);
+      // props->stream_texture_ = SDL_CreateTexture(
+      //     stream_renderer_, stream_pixformat_,
+      //     SDL_TEXTUREACCESS_STREAMING, props->texture_width_,
+      //     props->texture_height_);
+
+      SDL_PropertiesID nvProps = SDL_CreateProperties();
+      SDL_SetNumberProperty(nvProps, SDL_PROP_TEXTURE_CREATE_WIDTH_NUMBER,
+                            props->texture_width_);
+      SDL_SetNumberProperty(nvProps, SDL_PROP_TEXTURE_CREATE_HEIGHT_NUMBER,
+                            props->texture_height_);
+      SDL_SetNumberProperty(nvProps, SDL_PROP_TEXTURE_CREATE_FORMAT_NUMBER,
+                            SDL_PIXELFORMAT_NV12);
+      SDL_SetNumberProperty(nvProps, SDL_PROP_TEXTURE_CREATE_COLORSPACE_NUMBER,
+                            SDL_COLORSPACE_BT601_LIMITED);
+      props->stream_texture_ =
+          SDL_CreateTextureWithProperties(stream_renderer_, nvProps);
+      SDL_DestroyProperties(nvProps);
+    }
+  } else {
+    props->texture_width_ = props->video_width_;
+    props->texture_height_ = props->video_height_;
+    // props->stream_texture_ = SDL_CreateTexture(
+    //     stream_renderer_, stream_pixformat_,
+    //     SDL_TEXTUREACCESS_STREAMING, props->texture_width_,
+    //     props->texture_height_);
+
+    SDL_PropertiesID nvProps = SDL_CreateProperties();
+    SDL_SetNumberProperty(nvProps, SDL_PROP_TEXTURE_CREATE_WIDTH_NUMBER,
+                          props->texture_width_);
+    SDL_SetNumberProperty(nvProps, SDL_PROP_TEXTURE_CREATE_HEIGHT_NUMBER,
+                          props->texture_height_);
+    SDL_SetNumberProperty(nvProps, SDL_PROP_TEXTURE_CREATE_FORMAT_NUMBER,
+                          SDL_PIXELFORMAT_NV12);
+    SDL_SetNumberProperty(nvProps, SDL_PROP_TEXTURE_CREATE_COLORSPACE_NUMBER,
+                          SDL_COLORSPACE_BT601_LIMITED);
+    props->stream_texture_ =
+        SDL_CreateTextureWithProperties(stream_renderer_, nvProps);
+    SDL_DestroyProperties(nvProps);
+  }
+
+  SDL_UpdateTexture(props->stream_texture_, NULL,
+                    props->av_sync_frame_.data.data(), props->texture_width_);
+  TraceRecordEvent(TraceEvent::upload, props->texture_width_,
+                   props->texture_height_, props->captured_timestamp_);
+  props->input_latency_.OnFrameDisplayed(props->captured_timestamp_,
+                                         GetSystemTimeMicros(props->peer_));
+}
 }  // namespace crossdesk
\ No newline at end of file
@@ -10,30 +10,48 @@
 #include <SDL3/SDL.h>
 
 #include <atomic>
+#include <algorithm>
 #include <chrono>
 #include <fstream>
+#include <map>
+#include <memory>
 #include <mutex>
 #include <optional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include "IconsFontAwesome6.h"
+#include "audio_fanout_sender.h"
+#include "audio_idle_monitor.h"
+#include "audio_mixer.h"
+#include "audio_silence_detector.h"
+#include "av_sync_controller.h"
 #include "config_center.h"
+#include "config_watcher.h"
+#include "data_channel_scheduler.h"
 #include "device_controller_factory.h"
 #include "imgui.h"
 #include "imgui_impl_sdl3.h"
 #include "imgui_impl_sdlrenderer3.h"
 #include "imgui_internal.h"
+#include "input_latency_tracker.h"
 #include "minirtc.h"
 #include "path_manager.h"
 #include "screen_capturer_factory.h"
 #include "speaker_capturer_factory.h"
 #include "thumbnail.h"
+#include "session_previewer.h"
+#include "thumbnail_atlas.h"
 #if _WIN32
 #include "win_tray.h"
 #endif
 
 namespace crossdesk {
+// choices of the capture resolution setting, 0 keeps the native size
+constexpr int kMaxCaptureHeights[] = {0, 480, 720, 1080, 1440, 2160};
+
 class Render {
  public:
   struct SubStreamWindowProperties {
@@ -52,11 +70,14 @@ class Render {
     bool mouse_control_button_pressed_ = false;
     bool mouse_controller_is_started_ = false;
     bool audio_capture_button_pressed_ = false;
+    float audio_volume_ = 1.0f;
+    bool audio_muted_ = false;
     bool control_mouse_ = false;
     bool streaming_ = false;
     bool is_control_bar_in_left_ = true;
     bool control_bar_hovered_ = false;
     bool display_selectable_hovered_ = false;
+    bool audio_popup_hovered_ = false;
     bool control_bar_expand_ = true;
     bool reset_control_bar_pos_ = false;
     bool control_window_width_is_changing_ = false;
@@ -67,10 +88,10 @@ class Render {
     float sub_stream_window_width_ = 1280;
     float sub_stream_window_height_ = 720;
     float control_window_min_width_ = 20;
-    float control_window_max_width_ = 230;
+    float control_window_max_width_ = 262;
     float control_window_min_height_ = 40;
-    float control_window_max_height_ = 170;
-    float control_window_width_ = 230;
+    float control_window_max_height_ = 220;
+    float control_window_width_ = 262;
     float control_window_height_ = 40;
     float control_bar_pos_x_ = 0;
     float control_bar_pos_y_ = 30;
@@ -78,8 +99,6 @@ class Render {
     float mouse_diff_control_bar_pos_y_ = 0;
     double control_bar_button_pressed_time_ = 0;
     double net_traffic_stats_button_pressed_time_ = 0;
-    unsigned char* dst_buffer_ = nullptr;
-    size_t dst_buffer_capacity_ = 0;
     float mouse_pos_x_ = 0;
     float mouse_pos_y_ = 0;
     float mouse_pos_x_last_ = 0;
@@ -118,6 +137,20 @@ class Render {
     int frame_count_ = 0;
     std::chrono::steady_clock::time_point last_time_;
     XNetTrafficStats net_traffic_stats_;
+    uint32_t input_seq_ = 0;
+    int64_t last_input_probe_timestamp_ = 0;
+    int64_t captured_timestamp_ = 0;
+    InputLatencyTracker input_latency_;
+    AvSyncController av_sync_;
+    // the frame on screen, uploaded straight from the sync queue's buffer
+    AvSyncController::Frame av_sync_frame_;
+    std::shared_ptr<AudioLatencyProbe> audio_latency_probe_;
+    std::unique_ptr<DataChannelScheduler> data_scheduler_;
+    CursorInfo remote_cursor_ = {0, 0, CursorStyle::cursor_arrow};
+    bool remote_cursor_valid_ = false;
+    float last_sent_mouse_x_ = 0;
+    float last_sent_mouse_y_ = 0;
+    std::chrono::steady_clock::time_point remote_cursor_agreed_time_;
   };
 
  public:
@@ -138,9 +171,15 @@ class Render {
   void UpdateInteractions();
   void HandleRecentConnections();
   void HandleStreamWindow();
+  // applies edits made to config.ini while running
+  void HandleConfigChanges();
+  // hands the frame rate and resolution limits to the capture side
+  void UpdateCaptureLimits();
   void Cleanup();
   void CleanupFactories();
   void CleanupPeer(std::shared_ptr<SubStreamWindowProperties> props);
+  void SaveThumbnail(SubStreamWindowProperties* props,
+                     const std::string& remote_id);
   void CleanupPeers();
   void CleanSubStreamWindowProperties(
       std::shared_ptr<SubStreamWindowProperties> props);
@@ -182,8 +221,13 @@ class Render {
   int DrawStreamWindow();
   int ConfirmDeleteConnection();
   int NetTrafficStats(std::shared_ptr<SubStreamWindowProperties>& props);
+  int DataQueueStats(std::shared_ptr<SubStreamWindowProperties>& props);
+  int AudioJitterStats(std::shared_ptr<SubStreamWindowProperties>& props);
+  void UpdateAudioGains();
   void DrawConnectionStatusText(
       std::shared_ptr<SubStreamWindowProperties>& props);
+  void DrawRemoteCursor(std::shared_ptr<SubStreamWindowProperties>& props);
+  void SendCursorInfo();
 
  public:
   static void OnReceiveVideoBufferCb(const XVideoFrame* video_frame,
@@ -213,19 +257,25 @@ class Render {
   static SDL_HitTestResult HitTestCallback(SDL_Window* window,
                                            const SDL_Point* area, void* data);
 
-  static std::vector<char> SerializeRemoteAction(const RemoteAction& action);
-
-  static bool DeserializeRemoteAction(const char* data, size_t size,
-                                      RemoteAction& out);
-
-  static void FreeRemoteAction(RemoteAction& action);
-
  private:
   int SendKeyCommand(int key_code, bool is_down);
+  void TagInputLatencyProbe(SubStreamWindowProperties* props,
+                            RemoteAction& remote_action);
+  void SendInputAck(const RemoteAction& remote_action);
+  void SendSpeakerFrame(unsigned char* data, size_t size);
+  void UpdateAudioFanoutTargets();
+  void SetAudioCaptureDemand(const std::string& remote_id, bool enable);
+  bool HasAudioCaptureDemand();
+  bool PresentVideoFrame(SubStreamWindowProperties* props);
+  void RefreshStreamTexture(SubStreamWindowProperties* props);
+  int SendTextCommand(std::shared_ptr<SubStreamWindowProperties>& props,
+                      const std::string& text);
   int ProcessMouseEvent(const SDL_Event& event);
 
   static void SdlCaptureAudioIn(void* userdata, Uint8* stream, int len);
   static void SdlCaptureAudioOut(void* userdata, Uint8* stream, int len);
+  static void SdlPlaybackAudio(void* userdata, SDL_AudioStream* stream,
+                               int additional_amount, int total_amount);
 
  private:
   int SaveSettingsIntoCacheFile();
@@ -268,6 +318,12 @@ class Render {
   CDCache cd_cache_;
   std::mutex cd_cache_mutex_;
   std::unique_ptr<ConfigCenter> config_center_;
+  std::unique_ptr<ConfigWatcher> config_watcher_;
+  // set by the config watcher
+  std::atomic<bool> config_file_changed_{false};
+  // connection or codec settings changed while sessions were running,
+  // the peer is recreated once they are gone
+  bool peer_recreate_pending_ = false;
   ConfigCenter::LANGUAGE localization_language_ =
       ConfigCenter::LANGUAGE::CHINESE;
   std::unique_ptr<PathManager> path_manager_;
@@ -288,6 +344,11 @@ class Render {
   unsigned char aes128_key_[16];
   unsigned char aes128_iv_[16];
   std::unique_ptr<Thumbnail> thumbnail_;
+  std::unique_ptr<ThumbnailAtlas> thumbnail_atlas_;
+  // live previews of the connected sessions, shown in place of their
+  // saved thumbnails
+  std::unique_ptr<SessionPreviewer> session_previewer_;
+  bool enable_live_preview_ = false;
 
   // recent connections
   std::vector<std::pair<std::string, Thumbnail::RecentConnection>>
@@ -315,7 +376,9 @@ class Render {
   bool keyboard_capturer_is_started_ = false;
   bool foucs_on_main_window_ = false;
   bool foucs_on_stream_window_ = false;
-  bool audio_capture_ = false;
+  // viewers that asked for the speaker audio
+  std::mutex audio_capture_mutex_;
+  std::unordered_set<std::string> audio_capture_viewers_;
   int main_window_width_real_ = 720;
   int main_window_height_real_ = 540;
   float main_window_dpi_scaling_w_ = 1.0f;
@@ -361,8 +424,33 @@ class Render {
   std::string controlled_remote_id_ = "";
   std::string focused_remote_id_ = "";
   bool need_to_send_host_info_ = false;
+  bool cursor_info_sent_ = false;
+  uint32_t last_cursor_query_time_ = 0;
+  std::unique_ptr<DataChannelScheduler> data_scheduler_;
+  DataFragmentAssembler data_fragment_assembler_;
+  CursorInfo last_cursor_info_ = {0, 0, CursorStyle::cursor_arrow};
   SDL_Event last_mouse_event;
   SDL_AudioStream* output_stream_;
+  // one playout buffer per remote session, mixed in SdlPlaybackAudio
+  std::unique_ptr<AudioMixer> audio_mixer_;
+  AudioFanoutSender audio_fanout_sender_;
+  // set by the connection status callback when a session connects or
+  // drops, the main loop then republishes the fan-out targets
+  std::atomic<bool> audio_fanout_targets_dirty_{false};
+  // only touched by the audio device thread
+  std::vector<int16_t> playback_buffer_;
+  // suspend the devices while no session needs them
+  std::unique_ptr<AudioIdleMonitor> playback_monitor_;
+  std::unique_ptr<AudioIdleMonitor> capture_monitor_;
+  bool mute_background_tabs_ = false;
+  // speaker capture thread
+  AudioSilenceDetector audio_silence_detector_;
+  int audio_frames_since_anchor_ = 0;
+  bool audio_anchor_pending_ = true;
+  // diagnostics, see AudioLatencyProbe
+  bool enable_audio_latency_probe_ = false;
+  int audio_frames_since_probe_ = 0;
+  uint32_t audio_probe_seq_ = 0;
   uint32_t STREAM_REFRESH_EVENT = 0;
 
   // stream window render
@@ -403,6 +491,8 @@ class Render {
   bool focus_on_input_widget_ = true;
   bool is_client_mode_ = false;
   bool reload_recent_connections_ = true;
+  // set by the thumbnail worker
+  std::atomic<bool> thumbnail_saved_{false};
   bool show_confirm_delete_connection_ = false;
   bool delete_connection_ = false;
   bool is_tab_bar_hovered_ = false;
@@ -429,14 +519,28 @@ class Render {
   MouseController* mouse_controller_ = nullptr;
   KeyboardCapturer* keyboard_capturer_ = nullptr;
   std::vector<DisplayInfo> display_info_list_;
-  uint64_t last_frame_time_;
+  // what the capture callback sends, swapped whole when settings change
+  struct CaptureLimits {
+    int fps = 30;
+    // frame height limit, 0 for none
+    int max_height = 0;
+    // by display name, overrides max_height
+    std::map<std::string, int> display_max_heights;
+  };
+  std::shared_ptr<const CaptureLimits> capture_limits_ =
+      std::make_shared<CaptureLimits>();
+  // capture thread
+  int64_t next_capture_time_us_ = 0;
+  std::vector<uint8_t> capture_scale_buffer_;
   char client_id_[10] = "";
   char client_id_display_[12] = "";
   char client_id_with_password_[17] = "";
   char password_saved_[7] = "";
   int language_button_value_ = 0;
   int video_quality_button_value_ = 0;
-  int video_frame_rate_button_value_ = 0;
+  int video_fps_value_ = 30;
+  // index into kMaxCaptureHeights
+  int max_capture_resolution_button_value_ = 0;
   int video_encode_format_button_value_ = 0;
   bool enable_hardware_video_codec_ = false;
   bool enable_turn_ = false;
@@ -448,6 +552,8 @@ class Render {
   bool enable_self_hosted_server_ = false;
   int language_button_value_last_ = 0;
   int video_quality_button_value_last_ = 0;
+  int video_fps_value_last_ = 30;
+  int max_capture_resolution_button_value_last_ = 0;
   int video_encode_format_button_value_last_ = 0;
   bool enable_hardware_video_codec_last_ = false;
   bool enable_turn_last_ = false;
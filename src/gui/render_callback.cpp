@@ -2,7 +2,9 @@
 #include "localization.h"
 #include "platform.h"
 #include "rd_log.h"
+#include "remote_action_codec.h"
 #include "render.h"
+#include "trace.h"
 
 #define NV12_BUFFER_SIZE 1280 * 720 * 3 / 2
 
@@ -13,6 +15,9 @@
 
 namespace crossdesk {
 
+// mouse moves are probed at most this often, discrete inputs always
+constexpr int64_t kMotionProbeIntervalUs = 200 * 1000;
+
 int Render::SendKeyCommand(int key_code, bool is_down) {
   RemoteAction remote_action;
   remote_action.type = ControlType::keyboard;
@@ -28,8 +33,10 @@ int Render::SendKeyCommand(int key_code, bool is_down) {
         client_properties_.end()) {
       auto props = client_properties_[controlled_remote_id_];
       if (props->connection_status_ == ConnectionStatus::Connected) {
-        SendDataFrame(props->peer_, (const char*)&remote_action,
-                      sizeof(remote_action), props->data_label_.c_str());
+        TagInputLatencyProbe(props.get(), remote_action);
+        props->data_scheduler_->Send(DataChannelScheduler::kInput,
+                                     (const char*)&remote_action,
+                                     sizeof(remote_action));
       }
     }
   }
@@ -37,6 +44,77 @@ int Render::SendKeyCommand(int key_code, bool is_down) {
   return 0;
 }
 
+void Render::TagInputLatencyProbe(SubStreamWindowProperties* props,
+                                  RemoteAction& remote_action) {
+  remote_action.seq = 0;
+  remote_action.timestamp = 0;
+
+  int64_t now = GetSystemTimeMicros(props->peer_);
+  if (ControlType::mouse == remote_action.type &&
+      MouseFlag::move == remote_action.m.flag &&
+      now - props->last_input_probe_timestamp_ < kMotionProbeIntervalUs) {
+    return;
+  }
+
+  // seq 0 is reserved for untagged actions
+  if (++props->input_seq_ == 0) {
+    ++props->input_seq_;
+  }
+  remote_action.seq = props->input_seq_;
+  remote_action.timestamp = now;
+  props->last_input_probe_timestamp_ = now;
+}
+
+void Render::SendInputAck(const RemoteAction& remote_action) {
+  if (remote_action.seq == 0 || !peer_ || !data_scheduler_) {
+    return;
+  }
+
+  RemoteAction ack;
+  ack.type = ControlType::input_ack;
+  ack.ack.seq = remote_action.seq;
+  ack.ack.input_timestamp = remote_action.timestamp;
+  ack.ack.inject_timestamp = GetSystemTimeMicros(peer_);
+  ack.seq = 0;
+  ack.timestamp = 0;
+  data_scheduler_->Send(DataChannelScheduler::kControl, (const char*)&ack,
+                        sizeof(ack));
+}
+
+int Render::SendTextCommand(std::shared_ptr<SubStreamWindowProperties>& props,
+                            const std::string& text) {
+  // keep every data frame small, cutting only on UTF-8 boundaries
+  constexpr size_t kMaxTextRunSize = 1024;
+
+  if (props->connection_status_ != ConnectionStatus::Connected) {
+    return -1;
+  }
+
+  size_t offset = 0;
+  while (offset < text.size()) {
+    size_t run_size = std::min(kMaxTextRunSize, text.size() - offset);
+    while (offset + run_size < text.size() && run_size > 0 &&
+           (text[offset + run_size] & 0xC0) == 0x80) {
+      --run_size;
+    }
+    if (run_size == 0) {
+      run_size = std::min(kMaxTextRunSize, text.size() - offset);
+    }
+
+    RemoteAction remote_action;
+    remote_action.type = ControlType::text_input;
+    remote_action.t.text = const_cast<char*>(text.data() + offset);
+    remote_action.t.text_size = run_size;
+    std::vector<char> serialized = SerializeRemoteAction(remote_action);
+    props->data_scheduler_->Send(DataChannelScheduler::kBulk,
+                                 serialized.data(), serialized.size());
+
+    offset += run_size;
+  }
+
+  return 0;
+}
+
 int Render::ProcessMouseEvent(const SDL_Event& event) {
   controlled_remote_id_ = "";
   int video_width, video_height = 0;
@@ -91,11 +169,16 @@ int Render::ProcessMouseEvent(const SDL_Event& event) {
         remote_action.m.flag = MouseFlag::move;
       }
 
-      if (props->control_bar_hovered_ || props->display_selectable_hovered_) {
+      if (props->control_bar_hovered_ || props->display_selectable_hovered_ ||
+          props->audio_popup_hovered_) {
         remote_action.m.flag = MouseFlag::move;
       }
-      SendDataFrame(props->peer_, (const char*)&remote_action,
-                    sizeof(remote_action), props->data_label_.c_str());
+      props->last_sent_mouse_x_ = remote_action.m.x;
+      props->last_sent_mouse_y_ = remote_action.m.y;
+      TagInputLatencyProbe(props.get(), remote_action);
+      props->data_scheduler_->Send(DataChannelScheduler::kInput,
+                                   (const char*)&remote_action,
+                                   sizeof(remote_action));
     } else if (SDL_EVENT_MOUSE_WHEEL == event.type &&
                last_mouse_event.button.x >= props->stream_render_rect_.x &&
                last_mouse_event.button.x <= props->stream_render_rect_.x +
@@ -127,8 +210,10 @@ int Render::ProcessMouseEvent(const SDL_Event& event) {
           (float)(event.button.y - props->stream_render_rect_.y) /
           render_height;
 
-      SendDataFrame(props->peer_, (const char*)&remote_action,
-                    sizeof(remote_action), props->data_label_.c_str());
+      TagInputLatencyProbe(props.get(), remote_action);
+      props->data_scheduler_->Send(DataChannelScheduler::kInput,
+                                   (const char*)&remote_action,
+                                   sizeof(remote_action));
     }
   }
 
@@ -141,21 +226,8 @@ void Render::SdlCaptureAudioIn(void* userdata, Uint8* stream, int len) {
     return;
   }
 
-  if (1) {
-    for (auto it : render->client_properties_) {
-      auto props = it.second;
-      if (props->connection_status_ == ConnectionStatus::Connected) {
-        SendAudioFrame(props->peer_, (const char*)stream, len,
-                       render->audio_label_.c_str());
-      }
-    }
-
-  } else {
-    memcpy(render->audio_buffer_, stream, len);
-    render->audio_len_ = len;
-    SDL_Delay(10);
-    render->audio_buffer_fresh_ = true;
-  }
+  // the sender thread fans out to the peers
+  render->audio_fanout_sender_.Push(stream, len);
 }
 
 void Render::SdlCaptureAudioOut([[maybe_unused]] void* userdata,
@@ -203,32 +275,12 @@ void Render::OnReceiveVideoBufferCb(const XVideoFrame* video_frame,
       render->client_properties_.find(remote_id)->second.get();
 
   if (props->connection_established_) {
-    if (!props->dst_buffer_) {
-      props->dst_buffer_capacity_ = video_frame->size;
-      props->dst_buffer_ = new unsigned char[video_frame->size];
-    }
-
-    if (props->dst_buffer_capacity_ < video_frame->size) {
-      delete props->dst_buffer_;
-      props->dst_buffer_capacity_ = video_frame->size;
-      props->dst_buffer_ = new unsigned char[video_frame->size];
-    }
-
-    memcpy(props->dst_buffer_, video_frame->data, video_frame->size);
-    bool need_to_update_render_rect = false;
-    if (props->video_width_ != props->video_width_last_ ||
-        props->video_height_ != props->video_height_last_) {
-      need_to_update_render_rect = true;
-      props->video_width_last_ = props->video_width_;
-      props->video_height_last_ = props->video_height_;
-    }
-    props->video_width_ = video_frame->width;
-    props->video_height_ = video_frame->height;
-    props->video_size_ = video_frame->size;
-
-    if (need_to_update_render_rect) {
-      render->UpdateRenderRect();
-    }
+    TraceRecordEvent(TraceEvent::receive_video, (uint32_t)video_frame->size,
+                     video_frame->captured_timestamp);
+    // presented by the render thread once the audio has caught up
+    props->av_sync_.PushFrame(video_frame->data, video_frame->size,
+                              video_frame->width, video_frame->height,
+                              video_frame->captured_timestamp);
 
     SDL_Event event;
     event.type = render->STREAM_REFRESH_EVENT;
@@ -261,13 +313,50 @@ void Render::OnReceiveAudioBufferCb(const char* data, size_t size,
   }
 
   render->audio_buffer_fresh_ = true;
+  TraceRecordEvent(TraceEvent::receive_audio, (uint32_t)size);
 
-  if (render->output_stream_) {
-    int pushed = SDL_PutAudioStreamData(
-        render->output_stream_, (const Uint8*)data, static_cast<int>(size));
-    if (pushed < 0) {
-      LOG_ERROR("Failed to push audio data: {}", SDL_GetError());
-    }
+  std::string remote_id(user_id, user_id_size);
+  auto it = render->client_properties_.find(remote_id);
+  if (it != render->client_properties_.end() &&
+      it->second->audio_latency_probe_) {
+    it->second->audio_latency_probe_->OnReceived(
+        (const int16_t*)data, size / sizeof(int16_t),
+        GetSystemTimeMicros(it->second->peer_));
+  }
+
+  if (render->audio_mixer_ &&
+      render->audio_mixer_->Push(remote_id, (const int16_t*)data,
+                                 size / sizeof(int16_t)) &&
+      render->playback_monitor_) {
+    render->playback_monitor_->Touch();
+  }
+}
+
+void Render::SdlPlaybackAudio(void* userdata, SDL_AudioStream* stream,
+                              int additional_amount, int total_amount) {
+  Render* render = (Render*)userdata;
+  if (!render || !render->audio_mixer_ || additional_amount <= 0) {
+    return;
+  }
+  if (render->playback_monitor_) {
+    render->playback_monitor_->OnWakeup();
+  }
+
+  size_t count = additional_amount / sizeof(int16_t);
+  auto& playback_buffer = render->playback_buffer_;
+  if (playback_buffer.size() < count) {
+    playback_buffer.resize(count);
+  }
+  // mono S16 at 48 kHz, see AudioDeviceInit
+  int queued = SDL_GetAudioStreamQueued(stream);
+  int64_t output_queue_us =
+      queued > 0 ? (int64_t)queued / (int64_t)sizeof(int16_t) * 1000000 / 48000
+                 : 0;
+  render->audio_mixer_->Mix(playback_buffer.data(), count, output_queue_us);
+
+  if (!SDL_PutAudioStreamData(stream, playback_buffer.data(),
+                              (int)(count * sizeof(int16_t)))) {
+    LOG_ERROR("Failed to push audio data: {}", SDL_GetError());
   }
 }
 
@@ -279,14 +368,62 @@ void Render::OnReceiveDataBufferCb(const char* data, size_t size,
     return;
   }
 
+  if (size == 0) {
+    return;
+  }
+
+  // the full enum of a serialized text run or host info is not its type
+  ControlType type = GetControlType(data);
+  if (ControlType::data_fragment == type) {
+    std::string message;
+    if (render->data_fragment_assembler_.Push(
+            std::string(user_id, user_id_size), data, size, message)) {
+      OnReceiveDataBufferCb(message.data(), message.size(), user_id,
+                            user_id_size, user_data);
+    }
+    return;
+  }
+
   RemoteAction remote_action;
-  memcpy(&remote_action, data, size);
+  memcpy(&remote_action, data, std::min(size, sizeof(remote_action)));
 
   std::string remote_id(user_id, user_id_size);
   if (render->client_properties_.find(remote_id) !=
       render->client_properties_.end()) {
     // local
     auto props = render->client_properties_.find(remote_id)->second;
+    if (ControlType::input_ack == type) {
+      if (size >= sizeof(remote_action)) {
+        props->input_latency_.OnInputInjected(
+            remote_action.ack.seq, remote_action.ack.input_timestamp,
+            remote_action.ack.inject_timestamp);
+      }
+      return;
+    } else if (ControlType::cursor_info == type) {
+      if (size >= sizeof(remote_action)) {
+        props->remote_cursor_ = remote_action.c;
+        props->remote_cursor_valid_ = true;
+      }
+      return;
+    } else if (ControlType::audio_silence == type) {
+      if (render->audio_mixer_) {
+        render->audio_mixer_->MarkSilence(remote_id);
+      }
+      return;
+    } else if (ControlType::audio_probe == type) {
+      if (size >= sizeof(remote_action) && props->audio_latency_probe_) {
+        props->audio_latency_probe_->OnProbeSent(remote_action.seq,
+                                                 remote_action.timestamp);
+      }
+      return;
+    } else if (ControlType::audio_timing == type) {
+      if (size >= sizeof(remote_action) && render->audio_mixer_) {
+        render->audio_mixer_->SetCaptureAnchor(remote_id,
+                                               remote_action.timestamp);
+      }
+      return;
+    }
+
     RemoteAction host_info;
     if (DeserializeRemoteAction(data, size, host_info)) {
       if (ControlType::host_infomation == host_info.type &&
@@ -316,27 +453,39 @@ void Render::OnReceiveDataBufferCb(const char* data, size_t size,
     FreeRemoteAction(host_info);
   } else {
     // remote
-    if (ControlType::mouse == remote_action.type && render->mouse_controller_) {
+    if (ControlType::mouse == type && render->mouse_controller_) {
+      TraceRecordEvent(TraceEvent::input_mouse, (uint32_t)remote_action.m.flag,
+                       (int64_t)(remote_action.m.x * 10000),
+                       (int64_t)(remote_action.m.y * 10000));
       render->mouse_controller_->SendMouseCommand(remote_action,
                                                   render->selected_display_);
-    } else if (ControlType::audio_capture == remote_action.type) {
-      if (remote_action.a) {
-        render->StartSpeakerCapturer();
-        render->audio_capture_ = true;
-      } else {
-        render->StopSpeakerCapturer();
-        render->audio_capture_ = false;
-      }
-    } else if (ControlType::keyboard == remote_action.type &&
+      render->SendInputAck(remote_action);
+    } else if (ControlType::audio_capture == type) {
+      render->SetAudioCaptureDemand(remote_id, remote_action.a);
+    } else if (ControlType::keyboard == type &&
                render->keyboard_capturer_) {
+      TraceRecordEvent(TraceEvent::input_keyboard,
+                       (uint32_t)remote_action.k.key_value,
+                       remote_action.k.flag == KeyFlag::key_down);
       render->keyboard_capturer_->SendKeyboardCommand(
           (int)remote_action.k.key_value,
           remote_action.k.flag == KeyFlag::key_down);
-    } else if (ControlType::display_id == remote_action.type) {
+      render->SendInputAck(remote_action);
+    } else if (ControlType::display_id == type) {
       if (render->screen_capturer_) {
         render->selected_display_ = remote_action.d;
         render->screen_capturer_->SwitchTo(remote_action.d);
       }
+    } else if (ControlType::text_input == type &&
+               render->keyboard_capturer_) {
+      RemoteAction text_input;
+      if (DeserializeRemoteAction(data, size, text_input)) {
+        render->keyboard_capturer_->SendTextCommand(text_input.t.text,
+                                                    text_input.t.text_size);
+      } else {
+        LOG_ERROR("Invalid text input received, size [{}]", size);
+      }
+      FreeRemoteAction(text_input);
     }
   }
 }
@@ -415,6 +564,7 @@ void Render::OnConnectionStatusCb(ConnectionStatus status, const char* user_id,
           render->need_to_create_stream_window_ = true;
         }
         props->connection_established_ = true;
+        render->audio_fanout_targets_dirty_ = true;
         props->stream_render_rect_ = {
             0, (int)render->title_bar_height_,
             (int)render->stream_window_width_,
@@ -430,9 +580,11 @@ void Render::OnConnectionStatusCb(ConnectionStatus status, const char* user_id,
         render->control_mouse_ = false;
         props->connection_established_ = false;
         props->mouse_control_button_pressed_ = false;
-        if (props->dst_buffer_) {
-          memset(props->dst_buffer_, 0, props->dst_buffer_capacity_);
-          SDL_UpdateTexture(props->stream_texture_, NULL, props->dst_buffer_,
+        render->audio_fanout_targets_dirty_ = true;
+        if (!props->av_sync_frame_.data.empty()) {
+          std::vector<unsigned char>& frame = props->av_sync_frame_.data;
+          std::fill(frame.begin(), frame.end(), 0);
+          SDL_UpdateTexture(props->stream_texture_, NULL, frame.data(),
                             props->texture_width_);
         }
         render->CleanSubStreamWindowProperties(props);
@@ -464,6 +616,7 @@ void Render::OnConnectionStatusCb(ConnectionStatus status, const char* user_id,
     switch (status) {
       case ConnectionStatus::Connected:
         render->need_to_send_host_info_ = true;
+        render->cursor_info_sent_ = false;
         render->start_screen_capturer_ = true;
         render->start_mouse_controller_ = true;
         break;
@@ -473,10 +626,7 @@ void Render::OnConnectionStatusCb(ConnectionStatus status, const char* user_id,
         render->start_keyboard_capturer_ = false;
         render->need_to_send_host_info_ = false;
         if (props) props->connection_established_ = false;
-        if (render->audio_capture_) {
-          render->StopSpeakerCapturer();
-          render->audio_capture_ = false;
-        }
+        render->SetAudioCaptureDemand(remote_id, false);
         break;
       default:
         break;
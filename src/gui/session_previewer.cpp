@@ -0,0 +1,114 @@
+#include "session_previewer.h"
+
+namespace crossdesk {
+
+SessionPreviewer::SessionPreviewer(int width, int height,
+                                   std::chrono::milliseconds interval)
+    : width_(width), height_(height), interval_(interval) {}
+
+SessionPreviewer::~SessionPreviewer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exit_ = true;
+  }
+  jobs_cv_.notify_one();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+bool SessionPreviewer::IsDue(const std::string& remote_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = sessions_.find(remote_id);
+  if (it == sessions_.end()) {
+    return true;
+  }
+  if (it->second.pending) {
+    return false;
+  }
+  return std::chrono::steady_clock::now() - it->second.last_submit >=
+         interval_;
+}
+
+void SessionPreviewer::Submit(const std::string& remote_id,
+                              std::vector<unsigned char>& nv12, int width,
+                              int height) {
+  if ((size_t)width * height * 3 / 2 > nv12.size()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [it, inserted] = sessions_.try_emplace(remote_id);
+    Session& session = it->second;
+    if (inserted) {
+      session.generation = ++next_generation_;
+    }
+    session.last_submit = std::chrono::steady_clock::now();
+    session.pending = true;
+
+    Job job;
+    job.remote_id = remote_id;
+    job.generation = session.generation;
+    job.nv12.swap(nv12);
+    nv12.swap(session.spent);
+    job.width = width;
+    job.height = height;
+    jobs_.push_back(std::move(job));
+
+    if (!worker_.joinable()) {
+      worker_ = std::thread(&SessionPreviewer::WorkerLoop, this);
+    }
+  }
+  jobs_cv_.notify_one();
+}
+
+std::vector<SessionPreviewer::Preview> SessionPreviewer::TakePreviews() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::vector<Preview> previews;
+  previews.swap(previews_);
+  return previews;
+}
+
+void SessionPreviewer::Remove(const std::string& remote_id) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  sessions_.erase(remote_id);
+  for (auto it = jobs_.begin(); it != jobs_.end();) {
+    it = it->remote_id == remote_id ? jobs_.erase(it) : it + 1;
+  }
+  for (auto it = previews_.begin(); it != previews_.end();) {
+    it = it->remote_id == remote_id ? previews_.erase(it) : it + 1;
+  }
+}
+
+void SessionPreviewer::WorkerLoop() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      jobs_cv_.wait(lock, [this]() { return exit_ || !jobs_.empty(); });
+      if (exit_) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+
+    Preview preview;
+    preview.remote_id = std::move(job.remote_id);
+    preview.rgba.resize((size_t)width_ * height_ * 4);
+    scaler_.Scale(job.nv12.data(), job.width, job.height, width_, height_,
+                  preview.rgba.data());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = sessions_.find(preview.remote_id);
+    if (it == sessions_.end() || it->second.generation != job.generation) {
+      // removed while scaling, maybe reconnected since
+      continue;
+    }
+    it->second.pending = false;
+    it->second.spent = std::move(job.nv12);
+    previews_.push_back(std::move(preview));
+  }
+}
+}  // namespace crossdesk
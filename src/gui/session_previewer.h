@@ -0,0 +1,97 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _SESSION_PREVIEWER_H_
+#define _SESSION_PREVIEWER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "nv12_scaler.h"
+
+namespace crossdesk {
+
+// Scales the frames of connected sessions down to live previews on a
+// worker thread. At most one frame per session and interval is taken,
+// and it is taken over rather than copied; the buffer of the session's
+// previous frame is handed back in exchange. All calls are made on the
+// render thread.
+class SessionPreviewer {
+ public:
+  struct Preview {
+    std::string remote_id;
+    // width * height RGBA
+    std::vector<uint8_t> rgba;
+  };
+
+ public:
+  // key of the preview of |remote_id| in the thumbnail atlas
+  static std::string AtlasKey(const std::string& remote_id) {
+    return "live:" + remote_id;
+  }
+
+ public:
+  SessionPreviewer(int width, int height, std::chrono::milliseconds interval);
+  ~SessionPreviewer();
+
+ public:
+  // true once the interval has passed and the last frame is done
+  bool IsDue(const std::string& remote_id);
+  // takes |nv12| over, the caller gets the buffer of the session's last
+  // scaled frame back, or an empty one. |nv12| is left alone when the
+  // frame is too small for its size.
+  void Submit(const std::string& remote_id, std::vector<unsigned char>& nv12,
+              int width, int height);
+  // previews finished since the last call, oldest first
+  std::vector<Preview> TakePreviews();
+  // the session is gone, its pending preview is dropped
+  void Remove(const std::string& remote_id);
+
+ private:
+  struct Session {
+    std::chrono::steady_clock::time_point last_submit;
+    bool pending = false;
+    // tells a reconnect apart from the session removed before it
+    uint64_t generation = 0;
+    // scaled already, goes back to the caller on the next Submit
+    std::vector<unsigned char> spent;
+  };
+  struct Job {
+    std::string remote_id;
+    uint64_t generation = 0;
+    std::vector<unsigned char> nv12;
+    int width = 0;
+    int height = 0;
+  };
+
+  void WorkerLoop();
+
+ private:
+  const int width_;
+  const int height_;
+  const std::chrono::milliseconds interval_;
+
+  std::mutex mutex_;
+  std::condition_variable jobs_cv_;
+  std::unordered_map<std::string, Session> sessions_;
+  std::deque<Job> jobs_;
+  std::vector<Preview> previews_;
+  uint64_t next_generation_ = 0;
+  bool exit_ = false;
+  std::thread worker_;
+
+  // worker thread
+  Nv12Scaler scaler_;
+};
+}  // namespace crossdesk
+#endif
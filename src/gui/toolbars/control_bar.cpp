@@ -68,8 +68,9 @@ int Render::ControlBar(std::shared_ptr<SubStreamWindowProperties>& props) {
           remote_action.type = ControlType::display_id;
           remote_action.d = i;
           if (props->connection_status_ == ConnectionStatus::Connected) {
-            SendDataFrame(props->peer_, (const char*)&remote_action,
-                          sizeof(remote_action), props->data_label_.c_str());
+            props->data_scheduler_->Send(DataChannelScheduler::kControl,
+                                         (const char*)&remote_action,
+                                         sizeof(remote_action));
           }
         }
         props->display_selectable_hovered_ = ImGui::IsWindowHovered();
@@ -142,10 +143,40 @@ int Render::ControlBar(std::shared_ptr<SubStreamWindowProperties>& props) {
         RemoteAction remote_action;
         remote_action.type = ControlType::audio_capture;
         remote_action.a = props->audio_capture_button_pressed_;
-        SendDataFrame(props->peer_, (const char*)&remote_action,
-                      sizeof(remote_action), props->data_label_.c_str());
+        props->data_scheduler_->Send(DataChannelScheduler::kControl,
+                                     (const char*)&remote_action,
+                                     sizeof(remote_action));
       }
     }
+    bool audio_button_hovered = ImGui::IsItemHovered();
+    // right click for the local playback volume of this session
+    if (ImGui::IsItemClicked(ImGuiMouseButton_Right)) {
+      ImGui::OpenPopup("audio_volume");
+    }
+    if (ImGui::BeginPopup("audio_volume")) {
+      ImGui::SetWindowFontScale(0.5f);
+      ImGui::Checkbox(
+          localization::mute_playback[localization_language_index_].c_str(),
+          &props->audio_muted_);
+      float volume_percent = props->audio_volume_ * 100.0f;
+      ImGui::SetNextItemWidth(120.0f);
+      if (ImGui::SliderFloat(
+              localization::volume[localization_language_index_].c_str(),
+              &volume_percent, 0.0f, 100.0f, "%.0f%%")) {
+        props->audio_volume_ = volume_percent / 100.0f;
+      }
+      if (ImGui::Checkbox(
+              localization::mute_background_tabs[localization_language_index_]
+                  .c_str(),
+              &mute_background_tabs_)) {
+        config_center_->SetMuteBackgroundTabs(mute_background_tabs_);
+      }
+      props->audio_popup_hovered_ = ImGui::IsWindowHovered();
+      ImGui::SetWindowFontScale(1.0f);
+      ImGui::EndPopup();
+    } else {
+      props->audio_popup_hovered_ = false;
+    }
     if (!props->audio_capture_button_pressed_) {
       draw_list->AddLine(
           ImVec2(disable_audio_x, disable_audio_y),
@@ -154,11 +185,33 @@ int Render::ControlBar(std::shared_ptr<SubStreamWindowProperties>& props) {
       draw_list->AddLine(
           ImVec2(disable_audio_x - 1.2f, disable_audio_y + 1.2f),
           ImVec2(disable_audio_x + 15.3f, disable_audio_y + 15.4f),
-          ImGui::IsItemHovered() ? IM_COL32(66, 150, 250, 255)
+          audio_button_hovered ? IM_COL32(66, 150, 250, 255)
                                  : IM_COL32(179, 213, 253, 255),
           2.0f);
     }
 
+    ImGui::SameLine();
+    // type clipboard text on the remote host
+    std::string paste = ICON_FA_PASTE;
+    if (ImGui::Button(paste.c_str(), ImVec2(25, 25))) {
+      if (props->connection_established_ && SDL_HasClipboardText()) {
+        char* clipboard_text = SDL_GetClipboardText();
+        if (clipboard_text) {
+          SendTextCommand(props, clipboard_text);
+          SDL_free(clipboard_text);
+        }
+      }
+    }
+    if (ImGui::IsItemHovered()) {
+      ImGui::BeginTooltip();
+      ImGui::SetWindowFontScale(0.5f);
+      ImGui::Text("%s",
+                  localization::type_clipboard[localization_language_index_]
+                      .c_str());
+      ImGui::SetWindowFontScale(1.0f);
+      ImGui::EndTooltip();
+    }
+
     ImGui::SameLine();
     // net traffic stats button
     bool button_color_style_pushed = false;
@@ -253,6 +306,60 @@ int Render::ControlBar(std::shared_ptr<SubStreamWindowProperties>& props) {
   return 0;
 }
 
+int Render::DataQueueStats(std::shared_ptr<SubStreamWindowProperties>& props) {
+  static const char* class_names[DataChannelScheduler::kDataClassCount] = {
+      "Input", "Control", "Bulk"};
+  auto stats = props->data_scheduler_->GetStats();
+
+  ImGui::BeginTooltip();
+  ImGui::SetWindowFontScale(0.5f);
+  for (int i = 0; i < DataChannelScheduler::kDataClassCount; i++) {
+    ImGui::Text(
+        "%-8s depth %zu/%zu  sent %llu  dropped %llu  failed %llu  "
+        "delay %.2f/%.2f ms",
+        class_names[i], stats[i].queue_depth, stats[i].max_queue_depth,
+        (unsigned long long)stats[i].sent_messages,
+        (unsigned long long)stats[i].dropped_messages,
+        (unsigned long long)stats[i].failed_messages,
+        stats[i].avg_queue_delay_ms, stats[i].max_queue_delay_ms);
+  }
+  ImGui::SetWindowFontScale(1.0f);
+  ImGui::EndTooltip();
+
+  return 0;
+}
+
+int Render::AudioJitterStats(
+    std::shared_ptr<SubStreamWindowProperties>& props) {
+  AudioJitterBuffer::Stats stats;
+  if (!audio_mixer_ || 0 != audio_mixer_->GetStats(props->remote_id_, &stats)) {
+    return -1;
+  }
+
+  ImGui::BeginTooltip();
+  ImGui::SetWindowFontScale(0.5f);
+  ImGui::Text("depth %.1f/%.1f ms  jitter %.1f ms  drift %+.0f ppm",
+              stats.depth_ms, stats.target_ms, stats.jitter_ms,
+              stats.drift_ppm);
+  ImGui::Text("underruns %llu  concealed %llu ms  dropped %llu ms",
+              (unsigned long long)stats.underruns,
+              (unsigned long long)stats.concealed_ms,
+              (unsigned long long)stats.dropped_ms);
+  if (playback_monitor_) {
+    ImGui::Text("device %s  wakeups %llu  suspended %llu times",
+                playback_monitor_->GetState() ==
+                        AudioIdleMonitor::State::running
+                    ? "running"
+                    : "suspended",
+                (unsigned long long)playback_monitor_->GetWakeups(),
+                (unsigned long long)playback_monitor_->GetSuspendCount());
+  }
+  ImGui::SetWindowFontScale(1.0f);
+  ImGui::EndTooltip();
+
+  return 0;
+}
+
 int Render::NetTrafficStats(std::shared_ptr<SubStreamWindowProperties>& props) {
   ImGui::SetCursorPos(ImVec2(props->is_control_bar_in_left_
                                  ? (props->control_window_width_ + 5.0f)
@@ -290,6 +397,9 @@ int Render::NetTrafficStats(std::shared_ptr<SubStreamWindowProperties>& props) {
     ImGui::TableNextColumn();
     ImGui::Text("%s",
                 localization::audio[localization_language_index_].c_str());
+    if (ImGui::IsItemHovered()) {
+      AudioJitterStats(props);
+    }
     ImGui::TableNextColumn();
     BitrateDisplay((int)props->net_traffic_stats_.audio_inbound_stats.bitrate);
     ImGui::TableNextColumn();
@@ -299,6 +409,9 @@ int Render::NetTrafficStats(std::shared_ptr<SubStreamWindowProperties>& props) {
 
     ImGui::TableNextColumn();
     ImGui::Text("%s", localization::data[localization_language_index_].c_str());
+    if (ImGui::IsItemHovered() && props->data_scheduler_) {
+      DataQueueStats(props);
+    }
     ImGui::TableNextColumn();
     BitrateDisplay((int)props->net_traffic_stats_.data_inbound_stats.bitrate);
     ImGui::TableNextColumn();
@@ -320,6 +433,36 @@ int Render::NetTrafficStats(std::shared_ptr<SubStreamWindowProperties>& props) {
     ImGui::Text("FPS");
     ImGui::TableNextColumn();
     ImGui::Text("%d", props->fps_);
+    ImGui::TableNextRow();
+
+    InputLatencyTracker::Summary latency = props->input_latency_.GetSummary();
+    ImGui::TableNextColumn();
+    ImGui::Text("%s",
+                localization::latency[localization_language_index_].c_str());
+    ImGui::TableNextColumn();
+    ImGui::Text("P50");
+    ImGui::TableNextColumn();
+    ImGui::Text("P99");
+    ImGui::TableNextColumn();
+    ImGui::Text("%zu", latency.samples);
+
+    ImGui::TableNextColumn();
+    ImGui::Text("%s", localization::input_to_inject[localization_language_index_]
+                          .c_str());
+    ImGui::TableNextColumn();
+    ImGui::Text("%.1f ms", latency.input_to_inject_p50_ms);
+    ImGui::TableNextColumn();
+    ImGui::Text("%.1f ms", latency.input_to_inject_p99_ms);
+    ImGui::TableNextRow();
+
+    ImGui::TableNextColumn();
+    ImGui::Text("%s",
+                localization::inject_to_display[localization_language_index_]
+                    .c_str());
+    ImGui::TableNextColumn();
+    ImGui::Text("%.1f ms", latency.inject_to_display_p50_ms);
+    ImGui::TableNextColumn();
+    ImGui::Text("%.1f ms", latency.inject_to_display_p99_ms);
 
     ImGui::EndTable();
   }
@@ -110,8 +110,6 @@ int Render::SettingWindow() {
       ImGui::Separator();
 
       {
-        const char* video_frame_rate_items[] = {"30 fps", "60 fps"};
-
         settings_items_offset += settings_items_padding;
         ImGui::SetCursorPosY(settings_items_offset + 4);
         ImGui::Text("%s",
@@ -126,9 +124,40 @@ int Render::SettingWindow() {
         ImGui::SetCursorPosY(settings_items_offset);
         ImGui::SetNextItemWidth(SETTINGS_SELECT_WINDOW_WIDTH);
 
-        ImGui::Combo("##video_frame_rate", &video_frame_rate_button_value_,
-                     video_frame_rate_items,
-                     IM_ARRAYSIZE(video_frame_rate_items));
+        ImGui::SliderInt("##video_frame_rate", &video_fps_value_,
+                         ConfigCenter::kMinVideoFps, ConfigCenter::kMaxVideoFps,
+                         "%d fps", ImGuiSliderFlags_AlwaysClamp);
+      }
+
+      ImGui::Separator();
+
+      {
+        const char* max_capture_resolution_items[] = {
+            localization::native_resolution[localization_language_index_]
+                .c_str(),
+            "480p", "720p", "1080p", "1440p", "2160p"};
+        static_assert(IM_ARRAYSIZE(max_capture_resolution_items) ==
+                          IM_ARRAYSIZE(kMaxCaptureHeights),
+                      "one item per capture height");
+
+        settings_items_offset += settings_items_padding;
+        ImGui::SetCursorPosY(settings_items_offset + 4);
+        ImGui::Text("%s", localization::max_capture_resolution
+                              [localization_language_index_]
+                                  .c_str());
+
+        if (ConfigCenter::LANGUAGE::CHINESE == localization_language_) {
+          ImGui::SetCursorPosX(MAX_CAPTURE_RESOLUTION_SELECT_WINDOW_PADDING_CN);
+        } else {
+          ImGui::SetCursorPosX(MAX_CAPTURE_RESOLUTION_SELECT_WINDOW_PADDING_EN);
+        }
+        ImGui::SetCursorPosY(settings_items_offset);
+        ImGui::SetNextItemWidth(SETTINGS_SELECT_WINDOW_WIDTH);
+
+        ImGui::Combo("##max_capture_resolution",
+                     &max_capture_resolution_button_value_,
+                     max_capture_resolution_items,
+                     IM_ARRAYSIZE(max_capture_resolution_items));
       }
 
       ImGui::Separator();
@@ -297,6 +326,15 @@ int Render::SettingWindow() {
         }
         video_quality_button_value_last_ = video_quality_button_value_;
 
+        // Video frame rate and resolution, applied to a running capturer
+        config_center_->SetVideoFps(video_fps_value_);
+        if (max_capture_resolution_button_value_ !=
+            max_capture_resolution_button_value_last_) {
+          config_center_->SetMaxCaptureHeight(
+              kMaxCaptureHeights[max_capture_resolution_button_value_]);
+        }
+        UpdateCaptureLimits();
+
         // Video encode format
         if (video_encode_format_button_value_ == 0) {
           config_center_->SetVideoEncodeFormat(
@@ -366,6 +404,10 @@ int Render::SettingWindow() {
           video_quality_button_value_ = video_quality_button_value_last_;
         }
 
+        video_fps_value_ = video_fps_value_last_;
+        max_capture_resolution_button_value_ =
+            max_capture_resolution_button_value_last_;
+
         if (video_encode_format_button_value_ !=
             video_encode_format_button_value_last_) {
           video_encode_format_button_value_ =
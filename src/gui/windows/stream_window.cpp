@@ -31,6 +31,84 @@ void Render::DrawConnectionStatusText(
   }
 }
 
+static ImGuiMouseCursor CursorStyleToImGuiCursor(CursorStyle style) {
+  switch (style) {
+    case CursorStyle::cursor_ibeam:
+      return ImGuiMouseCursor_TextInput;
+    case CursorStyle::cursor_hand:
+      return ImGuiMouseCursor_Hand;
+    case CursorStyle::cursor_size_all:
+      return ImGuiMouseCursor_ResizeAll;
+    case CursorStyle::cursor_size_ns:
+      return ImGuiMouseCursor_ResizeNS;
+    case CursorStyle::cursor_size_we:
+      return ImGuiMouseCursor_ResizeEW;
+    case CursorStyle::cursor_size_nwse:
+      return ImGuiMouseCursor_ResizeNWSE;
+    case CursorStyle::cursor_size_nesw:
+      return ImGuiMouseCursor_ResizeNESW;
+    case CursorStyle::cursor_not_allowed:
+      return ImGuiMouseCursor_NotAllowed;
+    case CursorStyle::cursor_hidden:
+      return ImGuiMouseCursor_None;
+    default:
+      return ImGuiMouseCursor_Arrow;
+  }
+}
+
+void Render::DrawRemoteCursor(
+    std::shared_ptr<SubStreamWindowProperties>& props) {
+  // host cursor further away than this is drawn next to the local pointer
+  constexpr float kCursorMismatchPixels = 8.0f;
+  constexpr auto kCursorMismatchTimeout = std::chrono::milliseconds(500);
+
+  if (!props->remote_cursor_valid_ || !props->streaming_) {
+    return;
+  }
+
+  CursorInfo cursor = props->remote_cursor_;
+  const SDL_Rect& rect = props->stream_render_rect_;
+  ImVec2 mouse_pos = ImGui::GetIO().MousePos;
+  bool hovered = mouse_pos.x >= rect.x && mouse_pos.x <= rect.x + rect.w &&
+                 mouse_pos.y >= rect.y && mouse_pos.y <= rect.y + rect.h &&
+                 !props->control_bar_hovered_ &&
+                 !props->display_selectable_hovered_ &&
+                 !props->audio_popup_hovered_;
+
+  bool draw_host_cursor = true;
+  auto now = std::chrono::steady_clock::now();
+  if (props->control_mouse_ && hovered) {
+    // the local pointer is the predicted host cursor, so it moves without
+    // waiting for a new frame; only the style comes from the host
+    ImGui::SetMouseCursor(CursorStyleToImGuiCursor(cursor.style));
+
+    float diff_x = (cursor.x - props->last_sent_mouse_x_) * rect.w;
+    float diff_y = (cursor.y - props->last_sent_mouse_y_) * rect.h;
+    if (diff_x * diff_x + diff_y * diff_y <=
+        kCursorMismatchPixels * kCursorMismatchPixels) {
+      props->remote_cursor_agreed_time_ = now;
+    }
+    // the host moved the cursor on its own, e.g. clamped or warped it
+    draw_host_cursor =
+        now - props->remote_cursor_agreed_time_ > kCursorMismatchTimeout;
+  } else {
+    props->remote_cursor_agreed_time_ = now;
+  }
+
+  if (!draw_host_cursor || CursorStyle::cursor_hidden == cursor.style ||
+      cursor.x < 0.0f || cursor.x > 1.0f || cursor.y < 0.0f ||
+      cursor.y > 1.0f) {
+    return;
+  }
+
+  ImVec2 tip(rect.x + cursor.x * rect.w, rect.y + cursor.y * rect.h);
+  ImVec2 left(tip.x, tip.y + 16.0f);
+  ImVec2 right(tip.x + 11.0f, tip.y + 11.0f);
+  ImDrawList* draw_list = ImGui::GetWindowDrawList();
+  draw_list->AddTriangleFilled(tip, left, right, IM_COL32(255, 255, 255, 255));
+  draw_list->AddTriangle(tip, left, right, IM_COL32(0, 0, 0, 255), 1.5f);
+}
+
 void Render::CloseTab(decltype(client_properties_)::iterator& it) {
   CleanupPeer(it->second);
   it = client_properties_.erase(it);
@@ -41,6 +119,18 @@ void Render::CloseTab(decltype(client_properties_)::iterator& it) {
   }
 }
 
+void Render::UpdateAudioGains() {
+  if (!audio_mixer_) {
+    return;
+  }
+
+  for (auto& [remote_id, props] : client_properties_) {
+    bool muted = props->audio_muted_ ||
+                 (mute_background_tabs_ && !props->tab_selected_);
+    audio_mixer_->SetGain(remote_id, muted ? 0.0f : props->audio_volume_);
+  }
+}
+
 int Render::StreamWindow() {
   ImGui::SetNextWindowPos(
       ImVec2(0, fullscreen_button_pressed_ ? 0 : title_bar_height_),
@@ -117,6 +207,7 @@ int Render::StreamWindow() {
           props->render_window_height_ = size.y;
           UpdateRenderRect();
 
+          DrawRemoteCursor(props);
           ControlWindow(props);
 
           focused_remote_id_ = props->remote_id_;
@@ -175,6 +266,7 @@ int Render::StreamWindow() {
         props->render_window_height_ = size.y;
         UpdateRenderRect();
 
+        DrawRemoteCursor(props);
         ControlWindow(props);
         ImGui::End();
 
@@ -197,6 +289,8 @@ int Render::StreamWindow() {
     }
   }
 
+  UpdateAudioGains();
+
   // UpdateRenderRect();
   ImGui::End();  // End VideoBg
 
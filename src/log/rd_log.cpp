@@ -7,6 +7,10 @@ namespace crossdesk {
 
 namespace {
 
+// messages, the oldest are dropped once the writer falls this far behind
+constexpr size_t kLogQueueSize = 8192;
+constexpr auto kLogFlushInterval = std::chrono::seconds(1);
+
 std::string g_log_dir = "logs";
 std::once_flag g_logger_once_flag;
 std::shared_ptr<spdlog::logger> g_logger;
@@ -26,6 +30,14 @@ void InitLogger(const std::string& log_dir) {
   g_log_dir = log_dir;
 }
 
+void ShutdownLogger() {
+  if (!g_logger_created.load()) {
+    return;
+  }
+  g_logger->flush();
+  spdlog::shutdown();
+}
+
 std::shared_ptr<spdlog::logger> get_logger() {
   std::call_once(g_logger_once_flag, []() {
     g_logger_created.store(true);
@@ -54,10 +66,15 @@ std::shared_ptr<spdlog::logger> get_logger() {
     sinks.push_back(std::make_shared<spdlog::sinks::rotating_file_sink_mt>(
         filename, 5 * 1024 * 1024, 3));
 
-    g_logger = std::make_shared<spdlog::logger>(LOGGER_NAME, sinks.begin(),
-                                                sinks.end());
-    g_logger->flush_on(spdlog::level::info);
+    // the caller only formats the message payload, the pattern (time,
+    // level, thread) is applied and the sinks write on one worker thread
+    spdlog::init_thread_pool(kLogQueueSize, 1);
+    g_logger = std::make_shared<spdlog::async_logger>(
+        LOGGER_NAME, sinks.begin(), sinks.end(), spdlog::thread_pool(),
+        spdlog::async_overflow_policy::overrun_oldest);
+    g_logger->flush_on(spdlog::level::err);
     spdlog::register_logger(g_logger);
+    spdlog::flush_every(kLogFlushInterval);
   });
 
   return g_logger;
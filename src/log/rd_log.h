@@ -7,7 +7,9 @@
 #ifndef _RD_LOG_H_
 #define _RD_LOG_H_
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <iomanip>
 #include <iostream>
 #include <memory>
@@ -16,6 +18,7 @@
 #include <string>
 #include <vector>
 
+#include "spdlog/async.h"
 #include "spdlog/common.h"
 #include "spdlog/logger.h"
 #include "spdlog/sinks/base_sink.h"
@@ -31,11 +34,74 @@ constexpr auto LOGGER_NAME = "crossdesk";
 
 void InitLogger(const std::string& log_dir);
 
+// writes out what is still queued, nothing is logged afterwards
+void ShutdownLogger();
+
 std::shared_ptr<spdlog::logger> get_logger();
 
+// Lets one line per interval through, for the RATE_LIMITED macros below.
+class LogRateLimiter {
+ public:
+  explicit LogRateLimiter(int64_t interval_ms) : interval_ms_(interval_ms) {}
+
+  // |suppressed| receives the number of lines dropped since the last one
+  bool Allow(uint64_t* suppressed) {
+    int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      std::chrono::steady_clock::now().time_since_epoch())
+                      .count();
+    int64_t last = last_ms_.load(std::memory_order_relaxed);
+    if ((last != 0 && now - last < interval_ms_) ||
+        !last_ms_.compare_exchange_strong(last, now)) {
+      suppressed_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    *suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+    return true;
+  }
+
+ private:
+  const int64_t interval_ms_;
+  std::atomic<int64_t> last_ms_{0};
+  std::atomic<uint64_t> suppressed_{0};
+};
+
 #define LOG_INFO(...) SPDLOG_LOGGER_INFO(get_logger(), __VA_ARGS__)
 #define LOG_WARN(...) SPDLOG_LOGGER_WARN(get_logger(), __VA_ARGS__)
 #define LOG_ERROR(...) SPDLOG_LOGGER_ERROR(get_logger(), __VA_ARGS__)
 #define LOG_FATAL(...) SPDLOG_LOGGER_CRITICAL(get_logger(), __VA_ARGS__)
+
+// For hot paths. Each call site counts on its own: EVERY_N logs the 1st,
+// (n+1)th, ... call, RATE_LIMITED at most one call per |interval_ms|.
+#define LOG_EVERY_N_IMPL(log, n, ...)                                    \
+  do {                                                                   \
+    static std::atomic<uint64_t> log_occurrences{0};                     \
+    if (log_occurrences.fetch_add(1, std::memory_order_relaxed) % (n) == \
+        0) {                                                             \
+      log(__VA_ARGS__);                                                  \
+    }                                                                    \
+  } while (0)
+
+#define LOG_RATE_LIMITED_IMPL(log, interval_ms, ...)                   \
+  do {                                                                 \
+    static crossdesk::LogRateLimiter log_limiter(interval_ms);         \
+    uint64_t log_suppressed = 0;                                       \
+    if (log_limiter.Allow(&log_suppressed)) {                          \
+      log(__VA_ARGS__);                                                \
+      if (log_suppressed > 0) {                                        \
+        log("[{}] similar lines suppressed", log_suppressed);          \
+      }                                                                \
+    }                                                                  \
+  } while (0)
+
+#define LOG_INFO_EVERY_N(n, ...) LOG_EVERY_N_IMPL(LOG_INFO, n, __VA_ARGS__)
+#define LOG_WARN_EVERY_N(n, ...) LOG_EVERY_N_IMPL(LOG_WARN, n, __VA_ARGS__)
+#define LOG_ERROR_EVERY_N(n, ...) LOG_EVERY_N_IMPL(LOG_ERROR, n, __VA_ARGS__)
+
+#define LOG_INFO_RATE_LIMITED(interval_ms, ...) \
+  LOG_RATE_LIMITED_IMPL(LOG_INFO, interval_ms, __VA_ARGS__)
+#define LOG_WARN_RATE_LIMITED(interval_ms, ...) \
+  LOG_RATE_LIMITED_IMPL(LOG_WARN, interval_ms, __VA_ARGS__)
+#define LOG_ERROR_RATE_LIMITED(interval_ms, ...) \
+  LOG_RATE_LIMITED_IMPL(LOG_ERROR, interval_ms, __VA_ARGS__)
 }  // namespace crossdesk
 #endif
\ No newline at end of file
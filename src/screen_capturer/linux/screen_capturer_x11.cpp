@@ -91,8 +91,17 @@ int ScreenCapturerX11::Start() {
   running_ = true;
   paused_ = false;
   thread_ = std::thread([this]() {
+    // grab no faster than the configured rate instead of spinning
+    auto next_frame = std::chrono::steady_clock::now();
     while (running_) {
       if (!paused_) OnFrame();
+      next_frame += std::chrono::microseconds(1000000 / fps_.load());
+      auto now = std::chrono::steady_clock::now();
+      if (next_frame < now) {
+        next_frame = now;
+      } else {
+        std::this_thread::sleep_until(next_frame);
+      }
     }
   });
   return 0;
@@ -120,18 +129,25 @@ int ScreenCapturerX11::SwitchTo(int monitor_index) {
   return 0;
 }
 
+int ScreenCapturerX11::SetFps(int fps) {
+  fps_ = fps;
+  return 0;
+}
+
 std::vector<DisplayInfo> ScreenCapturerX11::GetDisplayInfoList() {
   return display_info_list_;
 }
 
 void ScreenCapturerX11::OnFrame() {
+  // runs at frame rate, keep a persistent failure from flooding the log
   if (!display_) {
-    LOG_ERROR("Display is not initialized");
+    LOG_ERROR_RATE_LIMITED(5000, "Display is not initialized");
     return;
   }
 
   if (monitor_index_ < 0 || monitor_index_ >= display_info_list_.size()) {
-    LOG_ERROR("Invalid monitor index: {}", monitor_index_.load());
+    LOG_ERROR_RATE_LIMITED(5000, "Invalid monitor index: {}",
+                           monitor_index_.load());
     return;
   }
 
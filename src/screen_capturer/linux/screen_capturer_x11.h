@@ -37,6 +37,7 @@ class ScreenCapturerX11 : public ScreenCapturer {
   int Resume(int monitor_index) override;
 
   int SwitchTo(int monitor_index) override;
+  int SetFps(int fps) override;
 
   std::vector<DisplayInfo> GetDisplayInfoList() override;
 
@@ -54,7 +55,7 @@ class ScreenCapturerX11 : public ScreenCapturer {
   std::atomic<bool> running_{false};
   std::atomic<bool> paused_{false};
   std::atomic<int> monitor_index_{0};
-  int fps_ = 60;
+  std::atomic<int> fps_{60};
   cb_desktop_data callback_;
   std::vector<DisplayInfo> display_info_list_;
 
@@ -62,6 +62,14 @@ int ScreenCapturerSck::SwitchTo(int monitor_index) {
   return -1;
 }
 
+int ScreenCapturerSck::SetFps(int fps) {
+  if (screen_capturer_sck_impl_) {
+    return screen_capturer_sck_impl_->SetFps(fps);
+  }
+
+  return -1;
+}
+
 std::vector<DisplayInfo> ScreenCapturerSck::GetDisplayInfoList() {
   if (screen_capturer_sck_impl_) {
     return screen_capturer_sck_impl_->GetDisplayInfoList();
@@ -33,6 +33,7 @@ class ScreenCapturerSck : public ScreenCapturer {
   int Resume(int monitor_index) override;
 
   int SwitchTo(int monitor_index) override;
+  int SetFps(int fps) override;
 
   std::vector<DisplayInfo> GetDisplayInfoList() override;
 
@@ -65,6 +65,8 @@ class API_AVAILABLE(macos(14.0)) ScreenCapturerSckImpl : public ScreenCapturer {
 
   int SwitchTo(int monitor_index) override;
 
+  int SetFps(int fps) override;
+
   int Destroy() override;
 
   int Stop() override;
@@ -199,6 +201,7 @@ ScreenCapturerSckImpl::~ScreenCapturerSckImpl() {
 
 int ScreenCapturerSckImpl::Init(const int fps, cb_desktop_data cb) {
   _on_data = cb;
+  fps_ = fps;
 
   dispatch_semaphore_t sema = dispatch_semaphore_create(0);
   __block SCShareableContent *content = nil;
@@ -270,6 +273,19 @@ int ScreenCapturerSckImpl::SwitchTo(int monitor_index) {
   return 0;
 }
 
+int ScreenCapturerSckImpl::SetFps(int fps) {
+  {
+    std::lock_guard<std::mutex> lock(lock_);
+    fps_ = fps;
+    if (!stream_) {
+      return 0;
+    }
+  }
+  // picks up the new minimumFrameInterval without restarting the stream
+  StartOrReconfigureCapturer();
+  return 0;
+}
+
 int ScreenCapturerSckImpl::Destroy() {
   std::lock_guard<std::mutex> lock(lock_);
   if (stream_) {
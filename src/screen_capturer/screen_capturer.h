@@ -31,6 +31,8 @@ class ScreenCapturer {
 
   virtual std::vector<DisplayInfo> GetDisplayInfoList() = 0;
   virtual int SwitchTo(int monitor_index) = 0;
+  // changes the capture rate of a running capturer
+  virtual int SetFps(int fps) = 0;
 };
 }  // namespace crossdesk
 #endif
\ No newline at end of file
@@ -217,6 +217,11 @@ int ScreenCapturerWgc::Stop() {
   return 0;
 }
 
+int ScreenCapturerWgc::SetFps(int fps) {
+  fps_ = fps;
+  return 0;
+}
+
 int ScreenCapturerWgc::SwitchTo(int monitor_index) {
   if (monitor_index_ == monitor_index) {
     LOG_INFO("Already on monitor {}:{}", monitor_index_ + 1,
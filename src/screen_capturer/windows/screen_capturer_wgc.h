@@ -33,6 +33,7 @@ class ScreenCapturerWgc : public ScreenCapturer,
   std::vector<DisplayInfo> GetDisplayInfoList() { return display_info_list_; }
 
   int SwitchTo(int monitor_index);
+  int SetFps(int fps) override;
 
   void OnFrame(const WgcSession::wgc_session_frame& frame, int id);
 
@@ -0,0 +1,308 @@
+#include "audio_format_converter.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "rd_log.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CROSSDESK_AUDIO_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define CROSSDESK_AUDIO_NEON
+#endif
+
+namespace crossdesk {
+
+// input is converted in blocks of this many frames to bound the buffers
+constexpr size_t kBlockFrames = 256;
+constexpr size_t kOutputFrameBytes =
+    AudioFormatConverter::kOutputFrameSamples * sizeof(int16_t);
+constexpr double kPi = 3.14159265358979323846;
+
+void DownmixStereoF32(const float* data, size_t frames, float* out) {
+  size_t i = 0;
+#if defined(CROSSDESK_AUDIO_SSE2)
+  const __m128 half = _mm_set1_ps(0.5f);
+  for (; i + 4 <= frames; i += 4) {
+    __m128 a = _mm_loadu_ps(data + 2 * i);
+    __m128 b = _mm_loadu_ps(data + 2 * i + 4);
+    __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    _mm_storeu_ps(out + i, _mm_mul_ps(_mm_add_ps(left, right), half));
+  }
+#elif defined(CROSSDESK_AUDIO_NEON)
+  for (; i + 4 <= frames; i += 4) {
+    float32x4x2_t x = vld2q_f32(data + 2 * i);
+    vst1q_f32(out + i, vmulq_n_f32(vaddq_f32(x.val[0], x.val[1]), 0.5f));
+  }
+#endif
+  for (; i < frames; ++i) {
+    out[i] = (data[2 * i] + data[2 * i + 1]) * 0.5f;
+  }
+}
+
+void DownmixStereoS16(const int16_t* data, size_t frames, float* out) {
+  const float scale = 1.0f / 65536.0f;
+  size_t i = 0;
+#if defined(CROSSDESK_AUDIO_SSE2)
+  const __m128i ones = _mm_set1_epi16(1);
+  const __m128 scale_v = _mm_set1_ps(scale);
+  for (; i + 4 <= frames; i += 4) {
+    // madd sums each left/right pair into one 32 bit lane
+    __m128i x = _mm_loadu_si128((const __m128i*)(data + 2 * i));
+    __m128i sum = _mm_madd_epi16(x, ones);
+    _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(sum), scale_v));
+  }
+#elif defined(CROSSDESK_AUDIO_NEON)
+  for (; i + 4 <= frames; i += 4) {
+    int16x4x2_t x = vld2_s16(data + 2 * i);
+    int32x4_t sum = vaddl_s16(x.val[0], x.val[1]);
+    vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(sum), scale));
+  }
+#endif
+  for (; i < frames; ++i) {
+    out[i] = (float)((int32_t)data[2 * i] + data[2 * i + 1]) * scale;
+  }
+}
+
+void ConvertF32ToS16(const float* data, size_t count, int16_t* out) {
+  size_t i = 0;
+#if defined(CROSSDESK_AUDIO_SSE2)
+  const __m128 scale = _mm_set1_ps(32767.0f);
+  for (; i + 8 <= count; i += 8) {
+    __m128i lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(data + i), scale));
+    __m128i hi =
+        _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(data + i + 4), scale));
+    // packs saturates, so clipped input cannot wrap around
+    _mm_storeu_si128((__m128i*)(out + i), _mm_packs_epi32(lo, hi));
+  }
+#elif defined(CROSSDESK_AUDIO_NEON)
+  for (; i + 4 <= count; i += 4) {
+    int32x4_t x = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(data + i), 32767.0f));
+    vst1_s16(out + i, vqmovn_s32(x));
+  }
+#endif
+  for (; i < count; ++i) {
+    float x = std::clamp(data[i] * 32767.0f, -32768.0f, 32767.0f);
+    out[i] = (int16_t)std::lrint(x);
+  }
+}
+
+float DotProductF32(const float* a, const float* b, size_t count) {
+  float sum = 0;
+  size_t i = 0;
+#if defined(CROSSDESK_AUDIO_SSE2)
+  __m128 acc = _mm_setzero_ps();
+  for (; i + 4 <= count; i += 4) {
+    acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, acc);
+  sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#elif defined(CROSSDESK_AUDIO_NEON)
+  float32x4_t acc = vdupq_n_f32(0);
+  for (; i + 4 <= count; i += 4) {
+    acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+  }
+  float lanes[4];
+  vst1q_f32(lanes, acc);
+  sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+#endif
+  for (; i < count; ++i) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+AudioFormatConverter::AudioFormatConverter()
+    : frame_ring_(4 * kOutputFrameBytes) {}
+
+AudioFormatConverter::~AudioFormatConverter() {}
+
+int AudioFormatConverter::Configure(const AudioFormat& input,
+                                    ResampleQuality quality) {
+  if (input.sample_rate < 8000 || input.sample_rate > 192000 ||
+      input.channels < 1 || input.channels > 8) {
+    LOG_ERROR("Unsupported capture format [{} Hz, {} channels]",
+              input.sample_rate, input.channels);
+    configured_ = false;
+    return -1;
+  }
+
+  input_ = input;
+  quality_ = quality;
+  step_ = (double)input_.sample_rate / kOutputSampleRate;
+  bypass_ = input_.sample_rate == kOutputSampleRate;
+
+  if (quality_ == ResampleQuality::high) {
+    taps_ = 32;
+    phases_ = 256;
+  } else if (quality_ == ResampleQuality::medium) {
+    taps_ = 16;
+    phases_ = 128;
+  } else {
+    taps_ = 2;
+    phases_ = 256;
+  }
+  BuildKernel();
+
+  // leftover history is at most taps_ + 1 samples
+  history_.assign(taps_ + kBlockFrames + 2, 0.0f);
+  resampled_.assign((size_t)std::ceil(kBlockFrames / step_) + 2, 0.0f);
+  output_.assign(std::max(resampled_.size(), kBlockFrames), 0);
+  configured_ = true;
+  Reset();
+
+  LOG_INFO("Capture format [{} Hz, {} channels, {}{}], resample quality [{}]",
+           input_.sample_rate, input_.channels,
+           input_.sample_type == AudioSampleType::f32 ? "f32" : "s16",
+           input_.planar ? " planar" : "", (int)quality_);
+  return 0;
+}
+
+void AudioFormatConverter::BuildKernel() {
+  kernel_.assign((size_t)(phases_ + 1) * taps_, 0.0f);
+  // below the lower Nyquist frequency when downsampling
+  double cutoff = std::min(1.0, 1.0 / step_) * 0.95;
+  int half = taps_ / 2;
+
+  for (int phase = 0; phase <= phases_; ++phase) {
+    double frac = (double)phase / phases_;
+    float* row = kernel_.data() + (size_t)phase * taps_;
+    double sum = 0;
+    for (int k = 0; k < taps_; ++k) {
+      double x = k - (half - 1) - frac;
+      double weight;
+      if (taps_ == 2) {
+        weight = std::max(0.0, 1.0 - std::fabs(x));
+      } else {
+        double sinc =
+            x == 0 ? 1.0 : std::sin(kPi * cutoff * x) / (kPi * cutoff * x);
+        // Blackman window over [-half, half]
+        double w = 0.5 + 0.5 * x / half;
+        double window = 0.42 - 0.5 * std::cos(2 * kPi * w) +
+                        0.08 * std::cos(4 * kPi * w);
+        weight = w <= 0 || w >= 1 ? 0 : sinc * window;
+      }
+      row[k] = (float)weight;
+      sum += weight;
+    }
+    // unity gain at DC for every phase
+    for (int k = 0; k < taps_ && sum != 0; ++k) {
+      row[k] = (float)(row[k] / sum);
+    }
+  }
+}
+
+void AudioFormatConverter::Reset() {
+  frame_ring_.Reset();
+  std::fill(history_.begin(), history_.end(), 0.0f);
+  // the first output sample is centred on the first input sample
+  history_len_ = taps_ / 2 - 1;
+  position_ = (double)history_len_;
+}
+
+void AudioFormatConverter::DownmixToMono(const uint8_t* data, size_t offset,
+                                         size_t frames, size_t total_frames,
+                                         float* out) const {
+  int channels = input_.channels;
+  bool is_f32 = input_.sample_type == AudioSampleType::f32;
+  size_t sample_size = is_f32 ? sizeof(float) : sizeof(int16_t);
+
+  if (!input_.planar) {
+    const uint8_t* p = data + offset * channels * sample_size;
+    if (channels == 2) {
+      if (is_f32) {
+        DownmixStereoF32((const float*)p, frames, out);
+      } else {
+        DownmixStereoS16((const int16_t*)p, frames, out);
+      }
+      return;
+    }
+    if (channels == 1 && is_f32) {
+      memcpy(out, p, frames * sizeof(float));
+      return;
+    }
+  }
+
+  // planar and uncommon layouts
+  float scale = (is_f32 ? 1.0f : 1.0f / 32768.0f) / channels;
+  for (size_t i = 0; i < frames; ++i) {
+    float sum = 0;
+    for (int c = 0; c < channels; ++c) {
+      size_t index = input_.planar ? c * total_frames + offset + i
+                                   : (offset + i) * channels + c;
+      sum += is_f32 ? ((const float*)data)[index]
+                    : (float)((const int16_t*)data)[index];
+    }
+    out[i] = sum * scale;
+  }
+}
+
+size_t AudioFormatConverter::Resample(float* out) {
+  int half = taps_ / 2;
+  size_t count = 0;
+  while ((size_t)position_ + half < history_len_) {
+    size_t base = (size_t)position_;
+    double frac = position_ - base;
+    int phase = (int)(frac * phases_ + 0.5);
+    const float* row = kernel_.data() + (size_t)phase * taps_;
+    out[count++] =
+        DotProductF32(history_.data() + base - (half - 1), row, taps_);
+    position_ += step_;
+  }
+
+  // keep only what the next outputs still need
+  size_t first = (size_t)position_ - (half - 1);
+  first = std::min(first, history_len_);
+  memmove(history_.data(), history_.data() + first,
+          (history_len_ - first) * sizeof(float));
+  history_len_ -= first;
+  position_ -= first;
+  return count;
+}
+
+void AudioFormatConverter::Process(const void* data, size_t frames,
+                                   const frame_cb& cb) {
+  if (!configured_ || !data) {
+    return;
+  }
+
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  for (size_t offset = 0; offset < frames; offset += kBlockFrames) {
+    size_t block = std::min(kBlockFrames, frames - offset);
+    size_t count = 0;
+
+    if (bypass_) {
+      DownmixToMono(bytes, offset, block, frames, resampled_.data());
+      count = block;
+    } else {
+      DownmixToMono(bytes, offset, block, frames,
+                    history_.data() + history_len_);
+      history_len_ += block;
+      count = Resample(resampled_.data());
+    }
+
+    ConvertF32ToS16(resampled_.data(), count, output_.data());
+
+    // the ring holds whole frames, so every frame peeked is contiguous
+    const uint8_t* p = (const uint8_t*)output_.data();
+    size_t remaining = count * sizeof(int16_t);
+    while (remaining > 0) {
+      size_t written = frame_ring_.Write(p, remaining);
+      p += written;
+      remaining -= written;
+
+      const uint8_t* frame = nullptr;
+      while ((frame = frame_ring_.Peek(kOutputFrameBytes))) {
+        cb(const_cast<uint8_t*>(frame), kOutputFrameBytes);
+        frame_ring_.Consume(kOutputFrameBytes);
+      }
+    }
+  }
+}
+}  // namespace crossdesk
@@ -0,0 +1,93 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _AUDIO_FORMAT_CONVERTER_H_
+#define _AUDIO_FORMAT_CONVERTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "spsc_ring_buffer.h"
+
+namespace crossdesk {
+
+enum class AudioSampleType { s16 = 0, f32 };
+
+struct AudioFormat {
+  int sample_rate = 48000;
+  int channels = 1;
+  AudioSampleType sample_type = AudioSampleType::s16;
+  // channels stored one after another instead of interleaved
+  bool planar = false;
+
+  bool operator==(const AudioFormat& other) const {
+    return sample_rate == other.sample_rate && channels == other.channels &&
+           sample_type == other.sample_type && planar == other.planar;
+  }
+  bool operator!=(const AudioFormat& other) const { return !(*this == other); }
+};
+
+// low: linear interpolation, medium: 16 tap windowed sinc,
+// high: 32 tap windowed sinc
+enum class ResampleQuality { low = 0, medium, high };
+
+// Converts whatever the platform captures into the format the peer sends:
+// 48 kHz mono S16 in 10 ms frames. Channels are averaged, the rate is
+// converted with a polyphase filter and complete frames are handed to the
+// callback. Not thread safe, Configure/Process/Reset run on one thread.
+class AudioFormatConverter {
+ public:
+  static constexpr int kOutputSampleRate = 48000;
+  static constexpr size_t kOutputFrameSamples = 480;
+
+  typedef std::function<void(unsigned char*, size_t)> frame_cb;
+
+ public:
+  AudioFormatConverter();
+  ~AudioFormatConverter();
+
+ public:
+  int Configure(const AudioFormat& input, ResampleQuality quality);
+  const AudioFormat& GetInputFormat() const { return input_; }
+
+  // |data| holds |frames| frames in the configured input format
+  void Process(const void* data, size_t frames, const frame_cb& cb);
+  void Reset();
+
+ private:
+  void BuildKernel();
+  void DownmixToMono(const uint8_t* data, size_t offset, size_t frames,
+                     size_t total_frames, float* out) const;
+  size_t Resample(float* out);
+
+ private:
+  AudioFormat input_;
+  ResampleQuality quality_ = ResampleQuality::medium;
+  bool configured_ = false;
+
+  double step_ = 1.0;
+  bool bypass_ = true;
+  int taps_ = 2;
+  int phases_ = 1;
+  std::vector<float> kernel_;
+
+  std::vector<float> history_;
+  size_t history_len_ = 0;
+  double position_ = 0;
+
+  std::vector<float> resampled_;
+  std::vector<int16_t> output_;
+  SpscRingBuffer frame_ring_;
+};
+
+void DownmixStereoF32(const float* data, size_t frames, float* out);
+void DownmixStereoS16(const int16_t* data, size_t frames, float* out);
+void ConvertF32ToS16(const float* data, size_t count, int16_t* out);
+float DotProductF32(const float* a, const float* b, size_t count);
+}  // namespace crossdesk
+#endif
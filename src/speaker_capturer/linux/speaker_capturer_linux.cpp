@@ -1,262 +1,327 @@
 #include "speaker_capturer_linux.h"
 
+#include <algorithm>
+
 #include <pulse/error.h>
 #include <pulse/introspect.h>
 
-#include <condition_variable>
-#include <iostream>
-#include <thread>
-
 #include "rd_log.h"
 
 namespace crossdesk {
 
-constexpr int kSampleRate = 48000;
-constexpr pa_sample_format_t kFormat = PA_SAMPLE_S16LE;
-constexpr int kChannels = 1;
-constexpr size_t kFrameSizeBytes = 480 * sizeof(int16_t);
+constexpr int kMaxChannels = 8;
 
 SpeakerCapturerLinux::SpeakerCapturerLinux()
-    : inited_(false), paused_(false), stop_flag_(false) {}
-SpeakerCapturerLinux::~SpeakerCapturerLinux() {
-  Stop();
-  Destroy();
-}
+    : inited_(false), paused_(false), started_(false) {}
+
+SpeakerCapturerLinux::~SpeakerCapturerLinux() { Destroy(); }
 
 int SpeakerCapturerLinux::Init(speaker_data_cb cb) {
   if (inited_) return 0;
   cb_ = cb;
+
+  if (0 != ConnectContext()) {
+    Cleanup();
+    return -1;
+  }
+
   inited_ = true;
   return 0;
 }
 
 int SpeakerCapturerLinux::Destroy() {
+  Cleanup();
   inited_ = false;
   return 0;
 }
 
-std::string SpeakerCapturerLinux::GetDefaultMonitorSourceName() {
-  std::string monitor_name;
-  std::mutex mtx;
-  std::condition_variable cv;
-  bool ready = false;
-
-  pa_mainloop* mainloop = pa_mainloop_new();
-  pa_mainloop_api* api = pa_mainloop_get_api(mainloop);
-  pa_context* context = pa_context_new(api, "GetMonitor");
-
-  struct CallbackState {
-    std::string* name;
-    std::mutex* mtx;
-    std::condition_variable* cv;
-    bool* ready;
-  } state{&monitor_name, &mtx, &cv, &ready};
-
-  pa_context_set_state_callback(
-      context,
-      [](pa_context* c, void* userdata) {
-        auto* state = static_cast<CallbackState*>(userdata);
-        if (pa_context_get_state(c) == PA_CONTEXT_READY) {
-          pa_operation* operation = pa_context_get_server_info(
-              c,
-              [](pa_context*, const pa_server_info* info, void* userdata) {
-                auto* state = static_cast<CallbackState*>(userdata);
-                if (info && info->default_sink_name) {
-                  *(state->name) =
-                      std::string(info->default_sink_name) + ".monitor";
-                }
-                {
-                  std::lock_guard<std::mutex> lock(*(state->mtx));
-                  *(state->ready) = true;
-                }
-                state->cv->notify_one();
-              },
-              userdata);
-          if (operation) {
-            pa_operation_unref(operation);
-          }
-        }
-      },
-      &state);
-
-  pa_context_connect(context, nullptr, PA_CONTEXT_NOFLAGS, nullptr);
-
-  std::thread loop_thread([&]() {
-    int ret = 0;
-    pa_mainloop_run(mainloop, &ret);
-  });
-
-  {
-    std::unique_lock<std::mutex> lock(mtx);
-    cv.wait_for(lock, std::chrono::seconds(2), [&] { return ready; });
+int SpeakerCapturerLinux::ConnectContext() {
+  mainloop_ = pa_threaded_mainloop_new();
+  if (!mainloop_) {
+    LOG_ERROR("Failed to create mainloop");
+    return -1;
   }
 
-  pa_context_disconnect(context);
-  pa_context_unref(context);
-  pa_mainloop_quit(mainloop, 0);
-  loop_thread.join();
-  pa_mainloop_free(mainloop);
+  pa_mainloop_api* api = pa_threaded_mainloop_get_api(mainloop_);
+  context_ = pa_context_new(api, "SpeakerCapturer");
+  pa_context_set_state_callback(context_, OnContextState, this);
+  pa_context_set_subscribe_callback(context_, OnContextEvent, this);
 
-  return monitor_name;
-}
-
-int SpeakerCapturerLinux::Start() {
-  if (!inited_ || mainloop_thread_.joinable()) return -1;
-  stop_flag_ = false;
-
-  mainloop_thread_ = std::thread([this]() {
-    std::string monitor_name = GetDefaultMonitorSourceName();
-    if (monitor_name.empty()) {
-      LOG_ERROR("Failed to get monitor source");
-      return;
-    }
+  if (pa_threaded_mainloop_start(mainloop_) < 0) {
+    LOG_ERROR("Failed to start mainloop");
+    return -1;
+  }
 
-    mainloop_ = pa_threaded_mainloop_new();
-    pa_mainloop_api* api = pa_threaded_mainloop_get_api(mainloop_);
-    context_ = pa_context_new(api, "SpeakerCapturer");
-
-    pa_context_set_state_callback(
-        context_,
-        [](pa_context* c, void* userdata) {
-          auto self = static_cast<SpeakerCapturerLinux*>(userdata);
-          pa_context_state_t state = pa_context_get_state(c);
-          if (state == PA_CONTEXT_READY || state == PA_CONTEXT_FAILED ||
-              state == PA_CONTEXT_TERMINATED) {
-            pa_threaded_mainloop_signal(self->mainloop_, 0);
-          }
-        },
-        this);
-
-    if (pa_threaded_mainloop_start(mainloop_) < 0) {
-      LOG_ERROR("Failed to start mainloop");
-      Cleanup();
-      return;
-    }
+  pa_threaded_mainloop_lock(mainloop_);
 
-    pa_threaded_mainloop_lock(mainloop_);
+  if (pa_context_connect(context_, nullptr, PA_CONTEXT_NOFLAGS, nullptr) < 0) {
+    LOG_ERROR("Failed to connect context");
+    pa_threaded_mainloop_unlock(mainloop_);
+    return -1;
+  }
 
-    if (pa_context_connect(context_, nullptr, PA_CONTEXT_NOFLAGS, nullptr) <
-        0) {
-      LOG_ERROR("Failed to connect context");
+  while (true) {
+    pa_context_state_t state = pa_context_get_state(context_);
+    if (state == PA_CONTEXT_READY) break;
+    if (!PA_CONTEXT_IS_GOOD(state)) {
+      LOG_ERROR("Failed to connect context: {}",
+                pa_strerror(pa_context_errno(context_)));
       pa_threaded_mainloop_unlock(mainloop_);
-      Cleanup();
-      return;
+      return -1;
     }
+    pa_threaded_mainloop_wait(mainloop_);
+  }
 
-    while (true) {
-      pa_context_state_t state = pa_context_get_state(context_);
-      if (state == PA_CONTEXT_READY) break;
-      if (!PA_CONTEXT_IS_GOOD(state) || stop_flag_) {
-        pa_threaded_mainloop_unlock(mainloop_);
-        Cleanup();
-        return;
-      }
-      pa_threaded_mainloop_wait(mainloop_);
-    }
+  // follow default sink changes so the monitor name is always at hand
+  pa_operation* operation = pa_context_subscribe(
+      context_, PA_SUBSCRIPTION_MASK_SERVER, nullptr, nullptr);
+  if (operation) {
+    pa_operation_unref(operation);
+  }
 
-    pa_sample_spec ss = {kFormat, kSampleRate, kChannels};
-    stream_ = pa_stream_new(context_, "Capture", &ss, nullptr);
-
-    pa_stream_set_read_callback(
-        stream_,
-        [](pa_stream* s, size_t len, void* u) {
-          auto self = static_cast<SpeakerCapturerLinux*>(u);
-          if (self->paused_ || self->stop_flag_) return;
-
-          const void* data = nullptr;
-          if (pa_stream_peek(s, &data, &len) < 0 || !data) return;
-
-          const uint8_t* p = static_cast<const uint8_t*>(data);
-          self->frame_cache_.insert(self->frame_cache_.end(), p, p + len);
-
-          while (self->frame_cache_.size() >= kFrameSizeBytes) {
-            std::vector<uint8_t> temp_frame(
-                self->frame_cache_.begin(),
-                self->frame_cache_.begin() + kFrameSizeBytes);
-            self->cb_(temp_frame.data(), kFrameSizeBytes, "audio");
-            self->frame_cache_.erase(
-                self->frame_cache_.begin(),
-                self->frame_cache_.begin() + kFrameSizeBytes);
-          }
-
-          pa_stream_drop(s);
-        },
-        this);
-
-    pa_buffer_attr attr = {.maxlength = (uint32_t)-1,
-                           .tlength = 0,
-                           .prebuf = 0,
-                           .minreq = 0,
-                           .fragsize = (uint32_t)kFrameSizeBytes};
-
-    if (pa_stream_connect_record(stream_, monitor_name.c_str(), &attr,
-                                 PA_STREAM_ADJUST_LATENCY) < 0) {
-      LOG_ERROR("Failed to connect stream");
-      pa_threaded_mainloop_unlock(mainloop_);
+  server_info_ready_ = false;
+  RequestServerInfo();
+  while (!server_info_ready_ &&
+         PA_CONTEXT_IS_GOOD(pa_context_get_state(context_))) {
+    pa_threaded_mainloop_wait(mainloop_);
+  }
+  bool has_monitor = !monitor_name_.empty();
+
+  pa_threaded_mainloop_unlock(mainloop_);
+
+  if (!has_monitor) {
+    LOG_ERROR("Failed to get monitor source");
+    return -1;
+  }
+
+  return 0;
+}
+
+void SpeakerCapturerLinux::RequestServerInfo() {
+  pa_operation* operation =
+      pa_context_get_server_info(context_, OnServerInfo, this);
+  if (operation) {
+    pa_operation_unref(operation);
+  } else {
+    server_info_ready_ = true;
+  }
+}
+
+int SpeakerCapturerLinux::Start() {
+  if (!inited_) return -1;
+
+  pa_threaded_mainloop_lock(mainloop_);
+  if (pa_context_get_state(context_) != PA_CONTEXT_READY) {
+    // the sound server went away, reconnect once
+    pa_threaded_mainloop_unlock(mainloop_);
+    Cleanup();
+    if (0 != ConnectContext()) {
       Cleanup();
-      return;
+      inited_ = false;
+      return -1;
     }
+    pa_threaded_mainloop_lock(mainloop_);
+  }
 
-    while (true) {
-      pa_stream_state_t s = pa_stream_get_state(stream_);
-      if (s == PA_STREAM_READY) break;
-      if (!PA_STREAM_IS_GOOD(s) || stop_flag_) {
-        pa_threaded_mainloop_unlock(mainloop_);
-        Cleanup();
-        return;
-      }
-      pa_threaded_mainloop_wait(mainloop_);
+  started_ = true;
+  int ret = 0;
+  if (!stream_) {
+    ret = CreateStream();
+  } else {
+    pa_operation* operation = pa_stream_cork(stream_, 0, nullptr, nullptr);
+    if (operation) {
+      pa_operation_unref(operation);
     }
+  }
+  pa_threaded_mainloop_unlock(mainloop_);
 
-    pa_threaded_mainloop_unlock(mainloop_);
+  return ret;
+}
 
-    while (!stop_flag_)
-      std::this_thread::sleep_for(std::chrono::milliseconds(100));
-  });
+int SpeakerCapturerLinux::Stop() {
+  if (!mainloop_) return 0;
+
+  pa_threaded_mainloop_lock(mainloop_);
+  started_ = false;
+  if (stream_) {
+    pa_operation* operation = pa_stream_cork(stream_, 1, nullptr, nullptr);
+    if (operation) {
+      pa_operation_unref(operation);
+    }
+    // do not replay stale audio on the next uncork
+    operation = pa_stream_flush(stream_, nullptr, nullptr);
+    if (operation) {
+      pa_operation_unref(operation);
+    }
+  }
+  converter_.Reset();
+  pa_threaded_mainloop_unlock(mainloop_);
 
   return 0;
 }
 
-int SpeakerCapturerLinux::Stop() {
-  stop_flag_ = true;
+int SpeakerCapturerLinux::CreateStream() {
+  // capture the monitor in the server's own rate and layout, as float so
+  // the server never converts, and normalise it ourselves
+  pa_sample_spec ss = {PA_SAMPLE_FLOAT32LE, server_sample_spec_.rate,
+                       std::clamp<uint8_t>(server_sample_spec_.channels, 1,
+                                           kMaxChannels)};
+  if (!pa_sample_spec_valid(&ss)) {
+    ss.rate = AudioFormatConverter::kOutputSampleRate;
+    ss.channels = 2;
+  }
 
-  if (mainloop_) {
-    pa_threaded_mainloop_lock(mainloop_);
-    pa_threaded_mainloop_signal(mainloop_, 0);
-    pa_threaded_mainloop_unlock(mainloop_);
+  AudioFormat format;
+  format.sample_rate = (int)ss.rate;
+  format.channels = ss.channels;
+  format.sample_type = AudioSampleType::f32;
+  if (0 != converter_.Configure(format, resample_quality_)) {
+    return -1;
   }
+  bytes_per_frame_ = pa_frame_size(&ss);
 
-  if (mainloop_thread_.joinable()) {
-    mainloop_thread_.join();
+  stream_ = pa_stream_new(context_, "Capture", &ss, nullptr);
+  if (!stream_) {
+    LOG_ERROR("Failed to create stream: {}",
+              pa_strerror(pa_context_errno(context_)));
+    return -1;
+  }
+
+  pa_stream_set_state_callback(stream_, OnStreamState, this);
+  pa_stream_set_read_callback(stream_, OnStreamRead, this);
+
+  pa_buffer_attr attr = {.maxlength = (uint32_t)-1,
+                         .tlength = 0,
+                         .prebuf = 0,
+                         .minreq = 0,
+                         .fragsize = (uint32_t)(bytes_per_frame_ *
+                                                ss.rate / 100)};
+
+  pa_stream_flags_t flags = PA_STREAM_ADJUST_LATENCY;
+  if (!started_) {
+    flags = (pa_stream_flags_t)(flags | PA_STREAM_START_CORKED);
+  }
+
+  if (pa_stream_connect_record(stream_, monitor_name_.c_str(), &attr, flags) <
+      0) {
+    LOG_ERROR("Failed to connect stream");
+    pa_stream_unref(stream_);
+    stream_ = nullptr;
+    return -1;
   }
 
-  Cleanup();
   return 0;
 }
 
+void SpeakerCapturerLinux::DestroyStream() {
+  if (stream_) {
+    pa_stream_set_state_callback(stream_, nullptr, nullptr);
+    pa_stream_set_read_callback(stream_, nullptr, nullptr);
+    pa_stream_disconnect(stream_);
+    pa_stream_unref(stream_);
+    stream_ = nullptr;
+  }
+  converter_.Reset();
+}
+
 void SpeakerCapturerLinux::Cleanup() {
   if (mainloop_) {
-    pa_threaded_mainloop_stop(mainloop_);
     pa_threaded_mainloop_lock(mainloop_);
 
-    if (stream_) {
-      pa_stream_disconnect(stream_);
-      pa_stream_unref(stream_);
-      stream_ = nullptr;
-    }
+    DestroyStream();
 
     if (context_) {
+      pa_context_set_state_callback(context_, nullptr, nullptr);
+      pa_context_set_subscribe_callback(context_, nullptr, nullptr);
       pa_context_disconnect(context_);
       pa_context_unref(context_);
       context_ = nullptr;
     }
 
     pa_threaded_mainloop_unlock(mainloop_);
+    pa_threaded_mainloop_stop(mainloop_);
     pa_threaded_mainloop_free(mainloop_);
     mainloop_ = nullptr;
   }
 
-  frame_cache_.clear();
+  monitor_name_.clear();
+  server_info_ready_ = false;
+  started_ = false;
+}
+
+void SpeakerCapturerLinux::OnContextState(pa_context* context,
+                                          void* userdata) {
+  auto self = static_cast<SpeakerCapturerLinux*>(userdata);
+  pa_context_state_t state = pa_context_get_state(context);
+  if (state == PA_CONTEXT_READY || state == PA_CONTEXT_FAILED ||
+      state == PA_CONTEXT_TERMINATED) {
+    pa_threaded_mainloop_signal(self->mainloop_, 0);
+  }
+}
+
+void SpeakerCapturerLinux::OnContextEvent(pa_context* context,
+                                          pa_subscription_event_type_t type,
+                                          uint32_t index, void* userdata) {
+  auto self = static_cast<SpeakerCapturerLinux*>(userdata);
+  if ((type & PA_SUBSCRIPTION_EVENT_FACILITY_MASK) ==
+          PA_SUBSCRIPTION_EVENT_SERVER &&
+      (type & PA_SUBSCRIPTION_EVENT_TYPE_MASK) ==
+          PA_SUBSCRIPTION_EVENT_CHANGE) {
+    self->RequestServerInfo();
+  }
+}
+
+void SpeakerCapturerLinux::OnServerInfo(pa_context* context,
+                                        const pa_server_info* info,
+                                        void* userdata) {
+  auto self = static_cast<SpeakerCapturerLinux*>(userdata);
+  if (info && info->default_sink_name) {
+    std::string monitor_name =
+        std::string(info->default_sink_name) + ".monitor";
+    bool spec_changed =
+        !pa_sample_spec_equal(&info->sample_spec, &self->server_sample_spec_);
+    self->server_sample_spec_ = info->sample_spec;
+    if (monitor_name != self->monitor_name_ || spec_changed) {
+      LOG_INFO("Speaker monitor source: [{}]", monitor_name);
+      self->monitor_name_ = monitor_name;
+      // follow the new default sink, keeping the cork state
+      if (self->stream_) {
+        self->DestroyStream();
+        self->CreateStream();
+      }
+    }
+  }
+
+  self->server_info_ready_ = true;
+  pa_threaded_mainloop_signal(self->mainloop_, 0);
+}
+
+void SpeakerCapturerLinux::OnStreamState(pa_stream* stream, void* userdata) {
+  pa_stream_state_t state = pa_stream_get_state(stream);
+  if (state == PA_STREAM_FAILED) {
+    auto self = static_cast<SpeakerCapturerLinux*>(userdata);
+    LOG_ERROR("Capture stream failed: {}",
+              pa_strerror(pa_context_errno(self->context_)));
+  }
+}
+
+void SpeakerCapturerLinux::OnStreamRead(pa_stream* stream, size_t len,
+                                        void* userdata) {
+  auto self = static_cast<SpeakerCapturerLinux*>(userdata);
+
+  const void* data = nullptr;
+  if (pa_stream_peek(stream, &data, &len) < 0) return;
+  if (len == 0) return;
+
+  // holes come back as a null pointer, they still have to be dropped
+  if (data && !self->paused_ && self->started_) {
+    self->converter_.Process(data, len / self->bytes_per_frame_,
+                             [self](unsigned char* frame, size_t size) {
+                               self->cb_(frame, size, "audio");
+                             });
+  }
+
+  pa_stream_drop(stream);
 }
 
 int SpeakerCapturerLinux::Pause() {
@@ -268,4 +333,4 @@ int SpeakerCapturerLinux::Resume() {
   paused_ = false;
   return 0;
 }
-}  // namespace crossdesk
\ No newline at end of file
+}  // namespace crossdesk
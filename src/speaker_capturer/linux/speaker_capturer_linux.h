@@ -13,13 +13,13 @@
 #include <functional>
 #include <mutex>
 #include <string>
-#include <thread>
-#include <vector>
 
 #include "speaker_capturer.h"
 
 namespace crossdesk {
 
+// Owns one threaded mainloop, context and record stream for the lifetime of
+// the capturer. Start/Stop only cork and uncork the stream.
 class SpeakerCapturerLinux : public SpeakerCapturer {
  public:
   SpeakerCapturerLinux();
@@ -34,23 +34,41 @@ class SpeakerCapturerLinux : public SpeakerCapturer {
   int Resume();
 
  private:
-  std::string GetDefaultMonitorSourceName();
+  int ConnectContext();
   void Cleanup();
+  void RequestServerInfo();
+  // must be called with the mainloop locked
+  int CreateStream();
+  void DestroyStream();
+
+  static void OnContextState(pa_context* context, void* userdata);
+  static void OnContextEvent(pa_context* context,
+                             pa_subscription_event_type_t type, uint32_t index,
+                             void* userdata);
+  static void OnServerInfo(pa_context* context, const pa_server_info* info,
+                           void* userdata);
+  static void OnStreamState(pa_stream* stream, void* userdata);
+  static void OnStreamRead(pa_stream* stream, size_t len, void* userdata);
 
  private:
   speaker_data_cb cb_ = nullptr;
 
   std::atomic<bool> inited_;
   std::atomic<bool> paused_;
-  std::atomic<bool> stop_flag_;
+  std::atomic<bool> started_;
 
-  std::thread mainloop_thread_;
   pa_threaded_mainloop* mainloop_ = nullptr;
   pa_context* context_ = nullptr;
   pa_stream* stream_ = nullptr;
 
-  std::mutex state_mtx_;
-  std::vector<uint8_t> frame_cache_;
+  // guarded by the mainloop lock
+  std::string monitor_name_;
+  pa_sample_spec server_sample_spec_ = {};
+  bool server_info_ready_ = false;
+
+  // mainloop thread
+  AudioFormatConverter converter_;
+  size_t bytes_per_frame_ = 0;
 };
 }  // namespace crossdesk
-#endif
\ No newline at end of file
+#endif
@@ -27,10 +27,14 @@ class SpeakerCapturerMacosx : public SpeakerCapturer {
 
   int Pause();
   int Resume();
+  ResampleQuality GetResampleQuality() const;
 
  public:
   speaker_data_cb cb_ = nullptr;
   bool inited_ = false;
+  // capture queue
+  AudioFormatConverter converter_;
+  bool converter_configured_ = false;
 
   class Impl;
   Impl* impl_ = nullptr;
@@ -37,15 +37,26 @@ class SpeakerCapturerMacosx;
       CMAudioFormatDescriptionGetStreamBasicDescription(formatDesc);
 
   if (_owner->cb_ && dataPtr && length > 0 && asbd) {
-    std::vector<short> out_pcm16;
-    // ... 数据转换逻辑保持不变 ...
-    // 调用回调
-    size_t frame_bytes = 960;  // 480 * 2
-    size_t total_bytes = out_pcm16.size() * sizeof(short);
-    unsigned char* p = (unsigned char*)out_pcm16.data();
-    for (size_t offset = 0; offset + frame_bytes <= total_bytes; offset += frame_bytes) {
-      _owner->cb_(p + offset, frame_bytes, "audio");
+    crossdesk::AudioFormat format;
+    format.sample_rate = (int)asbd->mSampleRate;
+    format.channels = (int)asbd->mChannelsPerFrame;
+    format.sample_type = (asbd->mFormatFlags & kAudioFormatFlagIsFloat)
+                             ? crossdesk::AudioSampleType::f32
+                             : crossdesk::AudioSampleType::s16;
+    format.planar = (asbd->mFormatFlags & kAudioFormatFlagIsNonInterleaved) != 0;
+    if (!_owner->converter_configured_ || format != _owner->converter_.GetInputFormat()) {
+      _owner->converter_configured_ =
+          0 == _owner->converter_.Configure(format, _owner->GetResampleQuality());
     }
+    if (!_owner->converter_configured_) return;
+
+    size_t sample_size =
+        format.sample_type == crossdesk::AudioSampleType::f32 ? sizeof(float) : sizeof(int16_t);
+    size_t frames = length / (sample_size * format.channels);
+    auto owner = _owner;
+    _owner->converter_.Process(dataPtr, frames, [owner](unsigned char* frame, size_t size) {
+      owner->cb_(frame, size, "audio");
+    });
   }
 }
 @end
@@ -97,8 +108,9 @@ int SpeakerCapturerMacosx::Init(speaker_data_cb cb) {
 
   impl_->config = [[SCStreamConfiguration alloc] init];
   impl_->config.capturesAudio = YES;
+  // capture stereo, the converter downmixes to what the peer sends
   impl_->config.sampleRate = 48000;
-  impl_->config.channelCount = 1;
+  impl_->config.channelCount = 2;
 
   dispatch_semaphore_t sema = dispatch_semaphore_create(0);
   __block NSError* error = nil;
@@ -152,6 +164,7 @@ int SpeakerCapturerMacosx::Start() {
     impl_->delegate = nil;
   }
 
+  converter_configured_ = false;
   impl_->delegate = [[SpeakerCaptureDelegate alloc] initWithOwner:this];
   SCContentFilter* filter = [[SCContentFilter alloc] initWithDisplay:impl_->mainDisplay
                                                     excludingWindows:@[]];
@@ -225,5 +238,9 @@ int SpeakerCapturerMacosx::Destroy() {
 
 int SpeakerCapturerMacosx::Pause() { return 0; }
 
+ResampleQuality SpeakerCapturerMacosx::GetResampleQuality() const {
+  return resample_quality_;
+}
+
 int SpeakerCapturerMacosx::Resume() { return Start(); }
 }  // namespace crossdesk
\ No newline at end of file
@@ -9,6 +9,8 @@
 
 #include <functional>
 
+#include "audio_format_converter.h"
+
 namespace crossdesk {
 
 class SpeakerCapturer {
@@ -24,6 +26,14 @@ class SpeakerCapturer {
   virtual int Destroy() = 0;
   virtual int Start() = 0;
   virtual int Stop() = 0;
+
+  // takes effect on the next Init
+  void SetResampleQuality(ResampleQuality quality) {
+    resample_quality_ = quality;
+  }
+
+ protected:
+  ResampleQuality resample_quality_ = ResampleQuality::medium;
 };
 }  // namespace crossdesk
 #endif
\ No newline at end of file
@@ -11,9 +11,8 @@ namespace crossdesk {
 
 static ma_device_config device_config_;
 static ma_device device_;
-static ma_format format_ = ma_format_s16;
-static ma_uint32 sample_rate_ = ma_standard_sample_rate_48000;
-static ma_uint32 channels_ = 1;
+// float in the device's own rate and layout, normalised by the converter
+static ma_format format_ = ma_format_f32;
 static FILE* fp_ = nullptr;
 
 void data_callback(ma_device* pDevice, void* pOutput, const void* pInput,
@@ -21,13 +20,13 @@ void data_callback(ma_device* pDevice, void* pOutput, const void* pInput,
   SpeakerCapturerWasapi* ptr = (SpeakerCapturerWasapi*)pDevice->pUserData;
   if (ptr) {
     if (SAVE_AUDIO_FILE) {
-      fwrite(pInput, frameCount * ma_get_bytes_per_frame(format_, channels_), 1,
-             fp_);
+      fwrite(pInput,
+             frameCount * ma_get_bytes_per_frame(format_,
+                                                 pDevice->capture.channels),
+             1, fp_);
     }
 
-    ptr->GetCallback()((unsigned char*)pInput,
-                       frameCount * ma_get_bytes_per_frame(format_, channels_),
-                       "audio");
+    ptr->ProcessCapturedFrames(pInput, frameCount);
   }
 
   (void)pOutput;
@@ -37,6 +36,17 @@ SpeakerCapturerWasapi::speaker_data_cb SpeakerCapturerWasapi::GetCallback() {
   return cb_;
 }
 
+void SpeakerCapturerWasapi::ProcessCapturedFrames(const void* data,
+                                                  uint32_t frame_count) {
+  if (!cb_) {
+    return;
+  }
+  converter_.Process(data, frame_count,
+                     [this](unsigned char* frame, size_t size) {
+                       cb_(frame, size, "audio");
+                     });
+}
+
 SpeakerCapturerWasapi::SpeakerCapturerWasapi() {}
 
 SpeakerCapturerWasapi::~SpeakerCapturerWasapi() {
@@ -62,8 +72,9 @@ int SpeakerCapturerWasapi::Init(speaker_data_cb cb) {
   device_config_ = ma_device_config_init(ma_device_type_loopback);
   device_config_.capture.pDeviceID = NULL;
   device_config_.capture.format = format_;
-  device_config_.capture.channels = channels_;
-  device_config_.sampleRate = sample_rate_;
+  // 0 keeps the native channel count and rate of the loopback device
+  device_config_.capture.channels = 0;
+  device_config_.sampleRate = 0;
   device_config_.dataCallback = data_callback;
   device_config_.pUserData = this;
 
@@ -74,6 +85,15 @@ int SpeakerCapturerWasapi::Init(speaker_data_cb cb) {
     return -1;
   }
 
+  AudioFormat format;
+  format.sample_rate = (int)device_.sampleRate;
+  format.channels = (int)device_.capture.channels;
+  format.sample_type = AudioSampleType::f32;
+  if (0 != converter_.Configure(format, resample_quality_)) {
+    ma_device_uninit(&device_);
+    return -1;
+  }
+
   inited_ = true;
 
   return 0;
@@ -92,6 +112,7 @@ int SpeakerCapturerWasapi::Start() {
 
 int SpeakerCapturerWasapi::Stop() {
   ma_device_stop(&device_);
+  converter_.Reset();
   return 0;
 }
 
@@ -26,9 +26,11 @@ class SpeakerCapturerWasapi : public SpeakerCapturer {
   int Resume();
 
   speaker_data_cb GetCallback();
+  void ProcessCapturedFrames(const void* data, uint32_t frame_count);
 
  private:
   speaker_data_cb cb_ = nullptr;
+  AudioFormatConverter converter_;
 
  private:
   bool inited_ = false;
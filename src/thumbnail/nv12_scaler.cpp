@@ -0,0 +1,248 @@
+#include "nv12_scaler.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "rd_log.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CROSSDESK_NV12_SCALER_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define CROSSDESK_NV12_SCALER_NEON
+#endif
+
+namespace crossdesk {
+
+// 257 * 255 still fits in the uint16_t column sums. An 8K frame puts 48
+// source rows into one output row.
+constexpr int kMaxBoxRows = 257;
+
+// sums[i] = src[i] + src[stride + i] + ... over |rows| rows. Up to four
+// rows are added in registers before the sums are loaded and stored
+// again, which is what bounds this loop.
+static void AccumulateRowsU8(const uint8_t* src, size_t stride, int rows,
+                             size_t width, uint16_t* sums) {
+  memset(sums, 0, width * sizeof(uint16_t));
+  for (int r = 0; r < rows;) {
+    int group = std::min(rows - r, 4);
+    const uint8_t* r0 = src + r * stride;
+    const uint8_t* r1 = group > 1 ? r0 + stride : r0;
+    const uint8_t* r2 = group > 2 ? r1 + stride : r0;
+    const uint8_t* r3 = group > 3 ? r2 + stride : r0;
+    size_t i = 0;
+#if defined(CROSSDESK_NV12_SCALER_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    // rows a group does not have are read as r0 and masked off
+    const __m128i m1 = group > 1 ? _mm_set1_epi8(-1) : zero;
+    const __m128i m2 = group > 2 ? _mm_set1_epi8(-1) : zero;
+    const __m128i m3 = group > 3 ? _mm_set1_epi8(-1) : zero;
+    for (; i + 16 <= width; i += 16) {
+      __m128i x0 = _mm_loadu_si128((const __m128i*)(r0 + i));
+      __m128i x1 = _mm_and_si128(_mm_loadu_si128((const __m128i*)(r1 + i)), m1);
+      __m128i x2 = _mm_and_si128(_mm_loadu_si128((const __m128i*)(r2 + i)), m2);
+      __m128i x3 = _mm_and_si128(_mm_loadu_si128((const __m128i*)(r3 + i)), m3);
+      __m128i lo = _mm_add_epi16(
+          _mm_add_epi16(_mm_unpacklo_epi8(x0, zero),
+                        _mm_unpacklo_epi8(x1, zero)),
+          _mm_add_epi16(_mm_unpacklo_epi8(x2, zero),
+                        _mm_unpacklo_epi8(x3, zero)));
+      __m128i hi = _mm_add_epi16(
+          _mm_add_epi16(_mm_unpackhi_epi8(x0, zero),
+                        _mm_unpackhi_epi8(x1, zero)),
+          _mm_add_epi16(_mm_unpackhi_epi8(x2, zero),
+                        _mm_unpackhi_epi8(x3, zero)));
+      lo = _mm_add_epi16(lo, _mm_loadu_si128((const __m128i*)(sums + i)));
+      hi = _mm_add_epi16(hi, _mm_loadu_si128((const __m128i*)(sums + i + 8)));
+      _mm_storeu_si128((__m128i*)(sums + i), lo);
+      _mm_storeu_si128((__m128i*)(sums + i + 8), hi);
+    }
+#elif defined(CROSSDESK_NV12_SCALER_NEON)
+    const uint8x16_t m1 = vdupq_n_u8(group > 1 ? 0xFF : 0);
+    const uint8x16_t m2 = vdupq_n_u8(group > 2 ? 0xFF : 0);
+    const uint8x16_t m3 = vdupq_n_u8(group > 3 ? 0xFF : 0);
+    for (; i + 16 <= width; i += 16) {
+      uint8x16_t x0 = vld1q_u8(r0 + i);
+      uint8x16_t x1 = vandq_u8(vld1q_u8(r1 + i), m1);
+      uint8x16_t x2 = vandq_u8(vld1q_u8(r2 + i), m2);
+      uint8x16_t x3 = vandq_u8(vld1q_u8(r3 + i), m3);
+      uint16x8_t lo = vaddq_u16(vaddl_u8(vget_low_u8(x0), vget_low_u8(x1)),
+                                vaddl_u8(vget_low_u8(x2), vget_low_u8(x3)));
+      uint16x8_t hi = vaddq_u16(vaddl_u8(vget_high_u8(x0), vget_high_u8(x1)),
+                                vaddl_u8(vget_high_u8(x2), vget_high_u8(x3)));
+      vst1q_u16(sums + i, vaddq_u16(vld1q_u16(sums + i), lo));
+      vst1q_u16(sums + i + 8, vaddq_u16(vld1q_u16(sums + i + 8), hi));
+    }
+#endif
+    for (; i < width; ++i) {
+      uint16_t sum = r0[i];
+      if (group > 1) sum += r1[i];
+      if (group > 2) sum += r2[i];
+      if (group > 3) sum += r3[i];
+      sums[i] += sum;
+    }
+    r += group;
+  }
+}
+
+// returns sums[0] + ... + sums[count - 1]
+static uint32_t SumU16(const uint16_t* sums, int count) {
+  int i = 0;
+  uint32_t total = 0;
+#if defined(CROSSDESK_NV12_SCALER_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  __m128i acc = zero;
+  for (; i + 8 <= count; i += 8) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(sums + i));
+    acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(x, zero));
+    acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(x, zero));
+  }
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+  total = (uint32_t)_mm_cvtsi128_si32(acc);
+#elif defined(CROSSDESK_NV12_SCALER_NEON)
+  uint32x4_t acc = vdupq_n_u32(0);
+  for (; i + 8 <= count; i += 8) {
+    acc = vpadalq_u16(acc, vld1q_u16(sums + i));
+  }
+  total = vgetq_lane_u32(acc, 0) + vgetq_lane_u32(acc, 1) +
+          vgetq_lane_u32(acc, 2) + vgetq_lane_u32(acc, 3);
+#endif
+  for (; i < count; ++i) {
+    total += sums[i];
+  }
+  return total;
+}
+
+// sums holds interleaved U and V; adds up |pairs| of each
+static void SumUV16(const uint16_t* sums, int pairs, uint32_t* u_sum,
+                    uint32_t* v_sum) {
+  int i = 0;
+  uint32_t u = 0;
+  uint32_t v = 0;
+#if defined(CROSSDESK_NV12_SCALER_SSE2)
+  const __m128i zero = _mm_setzero_si128();
+  // lanes hold U, V, U, V
+  __m128i acc = zero;
+  for (; i + 4 <= pairs; i += 4) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(sums + 2 * i));
+    acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(x, zero));
+    acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(x, zero));
+  }
+  acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+  u = (uint32_t)_mm_cvtsi128_si32(acc);
+  v = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(acc, 4));
+#elif defined(CROSSDESK_NV12_SCALER_NEON)
+  uint32x4_t acc = vdupq_n_u32(0);
+  for (; i + 4 <= pairs; i += 4) {
+    uint16x8_t x = vld1q_u16(sums + 2 * i);
+    acc = vaddw_u16(acc, vget_low_u16(x));
+    acc = vaddw_u16(acc, vget_high_u16(x));
+  }
+  u = vgetq_lane_u32(acc, 0) + vgetq_lane_u32(acc, 2);
+  v = vgetq_lane_u32(acc, 1) + vgetq_lane_u32(acc, 3);
+#endif
+  for (; i < pairs; ++i) {
+    u += sums[2 * i];
+    v += sums[2 * i + 1];
+  }
+  *u_sum = u;
+  *v_sum = v;
+}
+
+static inline uint8_t ClampU8(int x) {
+  return (uint8_t)(x < 0 ? 0 : (x > 255 ? 255 : x));
+}
+
+// BT.601 limited range, the same matrix libyuv::I420ToABGR uses
+static inline void YuvToRgba(int y, int u, int v, uint8_t* out) {
+  int c = 298 * (y - 16) + 128;
+  int d = u - 128;
+  int e = v - 128;
+  out[0] = ClampU8((c + 409 * e) >> 8);
+  out[1] = ClampU8((c - 100 * d - 208 * e) >> 8);
+  out[2] = ClampU8((c + 516 * d) >> 8);
+  out[3] = 0xFF;
+}
+
+// Box filters straight from the NV12 planes into the letterboxed RGBA
+// output. Each output row sums its source rows column by column, then
+// each pixel averages its columns, so every source byte is read once.
+void Nv12Scaler::Scale(const uint8_t* src, int src_w, int src_h, int dst_w,
+                       int dst_h, uint8_t* dst_rgba) {
+  memset(dst_rgba, 0, dst_w * dst_h * 4);
+  for (int i = 0; i < dst_w * dst_h; ++i) {
+    dst_rgba[i * 4 + 3] = 0xFF;
+  }
+  if (src_w < 2 || src_h < 2) {
+    return;
+  }
+
+  float src_aspect = float(src_w) / src_h;
+  float dst_aspect = float(dst_w) / dst_h;
+  int fit_w = dst_w, fit_h = dst_h;
+  if (src_aspect > dst_aspect) {
+    fit_h = std::max(1, int(dst_w / src_aspect));
+  } else {
+    fit_w = std::max(1, int(dst_h * src_aspect));
+  }
+  if ((src_h + fit_h - 1) / fit_h > kMaxBoxRows) {
+    LOG_ERROR("Frame [{}x{}] too large to scale down", src_w, src_h);
+    return;
+  }
+
+  const uint8_t* y_plane = src;
+  const uint8_t* uv_plane = src + (size_t)src_w * src_h;
+  int chroma_w = src_w / 2;
+  int chroma_h = src_h / 2;
+
+  // only ever grow, so steady state allocates nothing
+  luma_sums_.resize(src_w);
+  chroma_sums_.resize((size_t)chroma_w * 2);
+  columns_.resize(fit_w);
+
+  // the column spans are the same for every output row; working them out
+  // per pixel cost more than summing the source did
+  for (int ox = 0; ox < fit_w; ++ox) {
+    Column& column = columns_[ox];
+    column.x0 = ox * src_w / fit_w;
+    column.x_count = std::max(1, (ox + 1) * src_w / fit_w - column.x0);
+    column.cx0 = std::min(ox * chroma_w / fit_w, chroma_w - 1);
+    column.cx_count = std::max(1, (ox + 1) * chroma_w / fit_w - column.cx0);
+    column.x_scale = 1.0f / column.x_count;
+    column.cx_scale = 1.0f / column.cx_count;
+  }
+
+  int pad_x = (dst_w - fit_w) / 2;
+  int pad_y = (dst_h - fit_h) / 2;
+  for (int oy = 0; oy < fit_h; ++oy) {
+    int y0 = oy * src_h / fit_h;
+    int y1 = std::max(y0 + 1, (oy + 1) * src_h / fit_h);
+    int cy0 = std::min(oy * chroma_h / fit_h, chroma_h - 1);
+    int cy1 = std::max(cy0 + 1, (oy + 1) * chroma_h / fit_h);
+    AccumulateRowsU8(y_plane + (size_t)y0 * src_w, src_w, y1 - y0, src_w,
+                     luma_sums_.data());
+    AccumulateRowsU8(uv_plane + (size_t)cy0 * src_w, src_w, cy1 - cy0,
+                     (size_t)chroma_w * 2, chroma_sums_.data());
+
+    float y_scale = 1.0f / (y1 - y0);
+    float cy_scale = 1.0f / (cy1 - cy0);
+    uint8_t* out = dst_rgba + ((size_t)(oy + pad_y) * dst_w + pad_x) * 4;
+    for (int ox = 0; ox < fit_w; ++ox) {
+      const Column& column = columns_[ox];
+      uint32_t y_sum = SumU16(luma_sums_.data() + column.x0, column.x_count);
+      uint32_t u_sum = 0;
+      uint32_t v_sum = 0;
+      SumUV16(chroma_sums_.data() + 2 * column.cx0, column.cx_count, &u_sum,
+              &v_sum);
+
+      float c_scale = column.cx_scale * cy_scale;
+      YuvToRgba((int)(y_sum * column.x_scale * y_scale + 0.5f),
+                (int)(u_sum * c_scale + 0.5f), (int)(v_sum * c_scale + 0.5f),
+                out + ox * 4);
+    }
+  }
+}
+}  // namespace crossdesk
@@ -0,0 +1,45 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _NV12_SCALER_H_
+#define _NV12_SCALER_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace crossdesk {
+
+// Box-filters an NV12 frame down to a small RGBA image in one pass,
+// letterboxed on black. Keeps its row sums between calls, so one
+// instance must not be shared between threads.
+class Nv12Scaler {
+ public:
+  Nv12Scaler() = default;
+  ~Nv12Scaler() = default;
+
+ public:
+  // |dst_rgba| holds dst_w * dst_h * 4 bytes
+  void Scale(const uint8_t* src, int src_w, int src_h, int dst_w, int dst_h,
+             uint8_t* dst_rgba);
+
+ private:
+  // source span of one output column, in luma and in chroma samples
+  struct Column {
+    int x0;
+    int x_count;
+    int cx0;
+    int cx_count;
+    float x_scale;
+    float cx_scale;
+  };
+
+ private:
+  std::vector<Column> columns_;
+  std::vector<uint16_t> luma_sums_;
+  std::vector<uint16_t> chroma_sums_;
+};
+}  // namespace crossdesk
+#endif
@@ -0,0 +1,208 @@
+#include "qoi_codec.h"
+
+#include <cstring>
+
+namespace crossdesk {
+
+constexpr uint8_t kQoiOpIndex = 0x00;
+constexpr uint8_t kQoiOpDiff = 0x40;
+constexpr uint8_t kQoiOpLuma = 0x80;
+constexpr uint8_t kQoiOpRun = 0xc0;
+constexpr uint8_t kQoiOpRgb = 0xfe;
+constexpr uint8_t kQoiOpRgba = 0xff;
+constexpr uint8_t kQoiMask = 0xc0;
+
+constexpr size_t kQoiHeaderSize = 14;
+constexpr uint8_t kQoiPadding[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+// far above any thumbnail, keeps a corrupt header from allocating much
+constexpr uint32_t kQoiMaxSide = 4096;
+
+struct QoiPixel {
+  uint8_t r = 0;
+  uint8_t g = 0;
+  uint8_t b = 0;
+  uint8_t a = 0;
+
+  bool operator==(const QoiPixel& other) const {
+    return r == other.r && g == other.g && b == other.b && a == other.a;
+  }
+};
+
+static inline int QoiHash(const QoiPixel& p) {
+  return (p.r * 3 + p.g * 5 + p.b * 7 + p.a * 11) % 64;
+}
+
+static void WriteU32(std::vector<uint8_t>& out, uint32_t value) {
+  out.push_back((uint8_t)(value >> 24));
+  out.push_back((uint8_t)(value >> 16));
+  out.push_back((uint8_t)(value >> 8));
+  out.push_back((uint8_t)value);
+}
+
+static uint32_t ReadU32(const uint8_t* data) {
+  return ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) |
+         ((uint32_t)data[2] << 8) | data[3];
+}
+
+bool IsQoi(const uint8_t* data, size_t size) {
+  return size >= kQoiHeaderSize && 0 == memcmp(data, "qoif", 4);
+}
+
+int QoiEncode(const uint8_t* rgba, int width, int height,
+              std::vector<uint8_t>& out) {
+  if (width <= 0 || height <= 0 || (uint32_t)width > kQoiMaxSide ||
+      (uint32_t)height > kQoiMaxSide) {
+    return -1;
+  }
+
+  size_t pixel_count = (size_t)width * height;
+  out.clear();
+  // worst case, every pixel as QOI_OP_RGBA
+  out.reserve(kQoiHeaderSize + pixel_count * 5 + sizeof(kQoiPadding));
+  out.insert(out.end(), {'q', 'o', 'i', 'f'});
+  WriteU32(out, (uint32_t)width);
+  WriteU32(out, (uint32_t)height);
+  out.push_back(4);  // channels
+  out.push_back(0);  // sRGB with linear alpha
+
+  QoiPixel index[64];
+  QoiPixel prev;
+  prev.a = 255;
+  int run = 0;
+  for (size_t i = 0; i < pixel_count; ++i) {
+    QoiPixel px;
+    px.r = rgba[i * 4];
+    px.g = rgba[i * 4 + 1];
+    px.b = rgba[i * 4 + 2];
+    px.a = rgba[i * 4 + 3];
+
+    if (px == prev) {
+      run++;
+      if (run == 62 || i == pixel_count - 1) {
+        out.push_back((uint8_t)(kQoiOpRun | (run - 1)));
+        run = 0;
+      }
+      continue;
+    }
+    if (run > 0) {
+      out.push_back((uint8_t)(kQoiOpRun | (run - 1)));
+      run = 0;
+    }
+
+    int hash = QoiHash(px);
+    if (index[hash] == px) {
+      out.push_back((uint8_t)(kQoiOpIndex | hash));
+    } else {
+      index[hash] = px;
+      if (px.a == prev.a) {
+        int8_t vr = (int8_t)(px.r - prev.r);
+        int8_t vg = (int8_t)(px.g - prev.g);
+        int8_t vb = (int8_t)(px.b - prev.b);
+        int8_t vg_r = (int8_t)(vr - vg);
+        int8_t vg_b = (int8_t)(vb - vg);
+        if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2) {
+          out.push_back(
+              (uint8_t)(kQoiOpDiff | (vr + 2) << 4 | (vg + 2) << 2 | (vb + 2)));
+        } else if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 &&
+                   vg_b > -9 && vg_b < 8) {
+          out.push_back((uint8_t)(kQoiOpLuma | (vg + 32)));
+          out.push_back((uint8_t)((vg_r + 8) << 4 | (vg_b + 8)));
+        } else {
+          out.push_back(kQoiOpRgb);
+          out.push_back(px.r);
+          out.push_back(px.g);
+          out.push_back(px.b);
+        }
+      } else {
+        out.push_back(kQoiOpRgba);
+        out.push_back(px.r);
+        out.push_back(px.g);
+        out.push_back(px.b);
+        out.push_back(px.a);
+      }
+    }
+    prev = px;
+  }
+
+  out.insert(out.end(), kQoiPadding, kQoiPadding + sizeof(kQoiPadding));
+  return 0;
+}
+
+int QoiDecode(const uint8_t* data, size_t size, std::vector<uint8_t>& rgba,
+              int* width, int* height) {
+  if (!IsQoi(data, size)) {
+    return -1;
+  }
+  uint32_t w = ReadU32(data + 4);
+  uint32_t h = ReadU32(data + 8);
+  if (w == 0 || h == 0 || w > kQoiMaxSide || h > kQoiMaxSide) {
+    return -1;
+  }
+
+  size_t pixel_count = (size_t)w * h;
+  rgba.resize(pixel_count * 4);
+
+  QoiPixel index[64];
+  QoiPixel px;
+  px.a = 255;
+  int run = 0;
+  size_t pos = kQoiHeaderSize;
+  // the padding is never part of a chunk
+  size_t chunks_end = size - sizeof(kQoiPadding);
+  for (size_t i = 0; i < pixel_count; ++i) {
+    if (run > 0) {
+      run--;
+    } else if (pos < chunks_end) {
+      uint8_t b1 = data[pos++];
+      if (b1 == kQoiOpRgb) {
+        if (pos + 3 > chunks_end) {
+          return -1;
+        }
+        px.r = data[pos];
+        px.g = data[pos + 1];
+        px.b = data[pos + 2];
+        pos += 3;
+      } else if (b1 == kQoiOpRgba) {
+        if (pos + 4 > chunks_end) {
+          return -1;
+        }
+        px.r = data[pos];
+        px.g = data[pos + 1];
+        px.b = data[pos + 2];
+        px.a = data[pos + 3];
+        pos += 4;
+      } else if ((b1 & kQoiMask) == kQoiOpIndex) {
+        px = index[b1];
+      } else if ((b1 & kQoiMask) == kQoiOpDiff) {
+        px.r += ((b1 >> 4) & 0x03) - 2;
+        px.g += ((b1 >> 2) & 0x03) - 2;
+        px.b += (b1 & 0x03) - 2;
+      } else if ((b1 & kQoiMask) == kQoiOpLuma) {
+        if (pos + 1 > chunks_end) {
+          return -1;
+        }
+        uint8_t b2 = data[pos++];
+        int vg = (b1 & 0x3f) - 32;
+        px.r += vg - 8 + ((b2 >> 4) & 0x0f);
+        px.g += vg;
+        px.b += vg - 8 + (b2 & 0x0f);
+      } else {
+        run = b1 & 0x3f;
+      }
+      index[QoiHash(px)] = px;
+    } else {
+      // truncated
+      return -1;
+    }
+
+    rgba[i * 4] = px.r;
+    rgba[i * 4 + 1] = px.g;
+    rgba[i * 4 + 2] = px.b;
+    rgba[i * 4 + 3] = px.a;
+  }
+
+  *width = (int)w;
+  *height = (int)h;
+  return 0;
+}
+}  // namespace crossdesk
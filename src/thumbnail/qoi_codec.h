@@ -0,0 +1,28 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _QOI_CODEC_H_
+#define _QOI_CODEC_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace crossdesk {
+
+// Lossless QOI ("Quite OK Image") coding of RGBA thumbnails. One pass
+// each way and no entropy coder, which makes it many times faster than
+// PNG at thumbnail sizes.
+bool IsQoi(const uint8_t* data, size_t size);
+
+int QoiEncode(const uint8_t* rgba, int width, int height,
+              std::vector<uint8_t>& out);
+
+// |rgba| receives width * height * 4 bytes
+int QoiDecode(const uint8_t* data, size_t size, std::vector<uint8_t>& rgba,
+              int* width, int* height);
+}  // namespace crossdesk
+#endif
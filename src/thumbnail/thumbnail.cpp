@@ -13,120 +13,16 @@
 #include <string>
 #include <vector>
 
-#include "libyuv.h"
+#include "qoi_codec.h"
 #include "rd_log.h"
 
+// only decodes thumbnails saved as PNG by older versions
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
-#define STB_IMAGE_WRITE_IMPLEMENTATION
-#include "stb_image_write.h"
 
 namespace crossdesk {
 
-bool LoadTextureFromMemory(const void* data, size_t data_size,
-                           SDL_Renderer* renderer, SDL_Texture** out_texture,
-                           int* out_width, int* out_height) {
-  int image_width = 0;
-  int image_height = 0;
-  int channels = 4;
-  unsigned char* image_data =
-      stbi_load_from_memory((const unsigned char*)data, (int)data_size,
-                            &image_width, &image_height, NULL, 4);
-  if (image_data == nullptr) {
-    LOG_ERROR("Failed to load image: [{}]", stbi_failure_reason());
-    return false;
-  }
-
-  // ABGR
-  int pitch = image_width * channels;
-  SDL_Surface* surface =
-      SDL_CreateSurfaceFrom(image_width, image_height, SDL_PIXELFORMAT_RGBA32,
-                            (void*)image_data, pitch);
-  if (surface == nullptr) {
-    LOG_ERROR("Failed to create SDL surface: [{}]", SDL_GetError());
-    return false;
-  }
-
-  SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
-  if (texture == nullptr) {
-    LOG_ERROR("Failed to create SDL texture: [{}]", SDL_GetError());
-  }
-
-  *out_texture = texture;
-  *out_width = image_width;
-  *out_height = image_height;
-
-  SDL_DestroySurface(surface);
-  stbi_image_free(image_data);
-
-  return true;
-}
-
-bool LoadTextureFromFile(const char* file_name, SDL_Renderer* renderer,
-                         SDL_Texture** out_texture, int* out_width,
-                         int* out_height) {
-  std::filesystem::path file_path(file_name);
-  if (!std::filesystem::exists(file_path)) return false;
-  std::ifstream file(file_path, std::ios::binary);
-  if (!file) return false;
-  file.seekg(0, std::ios::end);
-  size_t file_size = file.tellg();
-  file.seekg(0, std::ios::beg);
-  if (file_size == -1) return false;
-  char* file_data = new char[file_size];
-  if (!file_data) return false;
-  file.read(file_data, file_size);
-  bool ret = LoadTextureFromMemory(file_data, file_size, renderer, out_texture,
-                                   out_width, out_height);
-  delete[] file_data;
-
-  return ret;
-}
-
-void ScaleNv12ToABGR(char* src, int src_w, int src_h, int dst_w, int dst_h,
-                     char* dst_rgba) {
-  uint8_t* y = reinterpret_cast<uint8_t*>(src);
-  uint8_t* uv = y + src_w * src_h;
-
-  float src_aspect = float(src_w) / src_h;
-  float dst_aspect = float(dst_w) / dst_h;
-  int fit_w = dst_w, fit_h = dst_h;
-  if (src_aspect > dst_aspect) {
-    fit_h = int(dst_w / src_aspect);
-  } else {
-    fit_w = int(dst_h * src_aspect);
-  }
-
-  std::vector<uint8_t> y_i420(src_w * src_h);
-  std::vector<uint8_t> u_i420((src_w / 2) * (src_h / 2));
-  std::vector<uint8_t> v_i420((src_w / 2) * (src_h / 2));
-  libyuv::NV12ToI420(y, src_w, uv, src_w, y_i420.data(), src_w, u_i420.data(),
-                     src_w / 2, v_i420.data(), src_w / 2, src_w, src_h);
-
-  std::vector<uint8_t> y_fit(fit_w * fit_h);
-  std::vector<uint8_t> u_fit((fit_w + 1) / 2 * (fit_h + 1) / 2);
-  std::vector<uint8_t> v_fit((fit_w + 1) / 2 * (fit_h + 1) / 2);
-  libyuv::I420Scale(y_i420.data(), src_w, u_i420.data(), src_w / 2,
-                    v_i420.data(), src_w / 2, src_w, src_h, y_fit.data(), fit_w,
-                    u_fit.data(), (fit_w + 1) / 2, v_fit.data(),
-                    (fit_w + 1) / 2, fit_w, fit_h, libyuv::kFilterBilinear);
-
-  std::vector<uint8_t> abgr(fit_w * fit_h * 4);
-  libyuv::I420ToABGR(y_fit.data(), fit_w, u_fit.data(), (fit_w + 1) / 2,
-                     v_fit.data(), (fit_w + 1) / 2, abgr.data(), fit_w * 4,
-                     fit_w, fit_h);
-
-  memset(dst_rgba, 0, dst_w * dst_h * 4);
-  for (int i = 0; i < dst_w * dst_h; ++i) {
-    dst_rgba[i * 4 + 3] = 0xFF;
-  }
-
-  for (int y = 0; y < fit_h; ++y) {
-    int dst_offset =
-        ((y + (dst_h - fit_h) / 2) * dst_w + (dst_w - fit_w) / 2) * 4;
-    memcpy(dst_rgba + dst_offset, abgr.data() + y * fit_w * 4, fit_w * 4);
-  }
-}
+constexpr char kIndexFileName[] = "index";
 
 Thumbnail::Thumbnail(std::string save_path) {
   if (!save_path.empty()) {
@@ -150,23 +46,82 @@ Thumbnail::Thumbnail(std::string save_path, unsigned char* aes128_key,
 }
 
 Thumbnail::~Thumbnail() {
+  {
+    std::lock_guard<std::mutex> lock(jobs_mutex_);
+    exit_ = true;
+  }
+  jobs_cv_.notify_one();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+
   if (rgba_buffer_) {
     delete[] rgba_buffer_;
     rgba_buffer_ = nullptr;
   }
 }
 
+void Thumbnail::SaveToThumbnailAsync(SaveJob job) {
+  {
+    std::lock_guard<std::mutex> lock(jobs_mutex_);
+    jobs_.push_back(std::move(job));
+    if (!worker_.joinable()) {
+      worker_ = std::thread(&Thumbnail::WorkerLoop, this);
+    }
+  }
+  jobs_cv_.notify_one();
+}
+
+void Thumbnail::SetSaveDoneCallback(save_done_cb cb) {
+  std::lock_guard<std::mutex> lock(jobs_mutex_);
+  save_done_cb_ = std::move(cb);
+}
+
+void Thumbnail::WorkerLoop() {
+  while (true) {
+    SaveJob job;
+    {
+      std::unique_lock<std::mutex> lock(jobs_mutex_);
+      jobs_cv_.wait(lock, [this]() { return exit_ || !jobs_.empty(); });
+      // drain what is queued before exiting, those are the last frames
+      if (jobs_.empty()) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+
+    SaveToThumbnail((const char*)job.nv12.get(), job.width, job.height,
+                    job.remote_id, job.host_name, job.password);
+    job.nv12.reset();
+
+    save_done_cb cb;
+    {
+      std::lock_guard<std::mutex> lock(jobs_mutex_);
+      cb = save_done_cb_;
+    }
+    if (cb) {
+      cb(job.remote_id);
+    }
+  }
+}
+
 int Thumbnail::SaveToThumbnail(const char* yuv420p, int width, int height,
                                const std::string& remote_id,
                                const std::string& host_name,
                                const std::string& password) {
+  // nothing is written without a remembered password
+  if (password.empty()) {
+    return 0;
+  }
+
   if (!rgba_buffer_) {
     rgba_buffer_ = new char[thumbnail_width_ * thumbnail_height_ * 4];
   }
 
   if (yuv420p) {
-    ScaleNv12ToABGR((char*)yuv420p, width, height, thumbnail_width_,
-                    thumbnail_height_, rgba_buffer_);
+    scaler_.Scale((const uint8_t*)yuv420p, width, height, thumbnail_width_,
+                  thumbnail_height_, (uint8_t*)rgba_buffer_);
   } else {
     // If yuv420p is null, fill the buffer with black pixels
     memset(rgba_buffer_, 0x00, thumbnail_width_ * thumbnail_height_ * 4);
@@ -176,110 +131,153 @@ int Thumbnail::SaveToThumbnail(const char* yuv420p, int width, int height,
     }
   }
 
-  std::string image_file_name;
-  if (password.empty()) {
-    return 0;
-  } else {
-    // delete the old thumbnail
-    std::string filename_with_remote_id = remote_id;
-    DeleteThumbnail(filename_with_remote_id);
+  std::vector<uint8_t> encoded;
+  if (0 != QoiEncode((const uint8_t*)rgba_buffer_, thumbnail_width_,
+                     thumbnail_height_, encoded)) {
+    LOG_ERROR("Failed to encode thumbnail [{}]", remote_id);
+    return -1;
   }
 
-  std::string cipher_password = AES_encrypt(password, aes128_key_, aes128_iv_);
-  image_file_name = remote_id + 'Y' + host_name + '@' + cipher_password;
-  std::string file_path = save_path_ + image_file_name;
-  stbi_write_png(file_path.data(), thumbnail_width_, thumbnail_height_, 4,
-                 rgba_buffer_, thumbnail_width_ * 4);
+  ThumbnailIndex::Entry entry;
+  entry.remote_id = remote_id;
+  entry.host_name = host_name;
+  entry.cipher_password = AES_encrypt(password, aes128_key_, aes128_iv_);
+  entry.file_name = remote_id + ".qoi";
+  std::string file_path = save_path_ + entry.file_name;
 
-  return 0;
+  int ret = 0;
+  {
+    std::lock_guard<std::mutex> lock(files_mutex_);
+    OpenIndexLocked();
+    std::ofstream file(file_path, std::ios::binary | std::ios::trunc);
+    if (!file.write((const char*)encoded.data(), encoded.size())) {
+      LOG_ERROR("Failed to write thumbnail [{}]", file_path);
+      ret = -1;
+    } else if (index_->IsOpen()) {
+      // a migrated entry still points at its old file name
+      const ThumbnailIndex::Entry* old = index_->Find(remote_id);
+      if (old && old->file_name != entry.file_name) {
+        std::error_code ec;
+        std::filesystem::remove(save_path_ + old->file_name, ec);
+      }
+      ret = index_->Put(entry);
+    }
+  }
+
+  return ret;
 }
 
 int Thumbnail::LoadThumbnail(
-    SDL_Renderer* renderer,
     std::vector<std::pair<std::string, Thumbnail::RecentConnection>>&
-        recent_connections,
-    int* width, int* height) {
-  for (auto& it : recent_connections) {
-    if (it.second.texture != nullptr) {
-      SDL_DestroyTexture(it.second.texture);
-      it.second.texture = nullptr;
-    }
-  }
+        recent_connections) {
   recent_connections.clear();
 
-  std::vector<std::filesystem::path> image_paths =
-      FindThumbnailPath(save_path_);
+  std::lock_guard<std::mutex> lock(files_mutex_);
+  if (0 != OpenIndexLocked()) {
+    return -1;
+  }
 
-  if (image_paths.size() == 0) {
+  std::vector<ThumbnailIndex::Entry> entries = index_->List();
+  if (entries.empty()) {
     return -1;
-  } else {
-    for (int i = 0; i < image_paths.size(); i++) {
-      size_t pos1 = image_paths[i].string().find('/') + 1;
-      std::string cipher_image_name = image_paths[i].filename().string();
-      std::string remote_id;
-      std::string cipher_password;
-      std::string remote_host_name;
-      std::string original_image_name;
-
-      if ('Y' == cipher_image_name[9] && cipher_image_name.size() >= 16) {
-        size_t pos_y = cipher_image_name.find('Y');
-        size_t pos_at = cipher_image_name.find('@');
-
-        if (pos_y == std::string::npos || pos_at == std::string::npos ||
-            pos_y >= pos_at) {
-          LOG_ERROR("Invalid filename");
-          continue;
-        }
-
-        remote_id = cipher_image_name.substr(0, pos_y);
-        remote_host_name =
-            cipher_image_name.substr(pos_y + 1, pos_at - pos_y - 1);
-        cipher_password = cipher_image_name.substr(pos_at + 1);
-
-        original_image_name =
-            remote_id + 'Y' + remote_host_name + "@" +
-            AES_decrypt(cipher_password, aes128_key_, aes128_iv_);
-      } else {
-        size_t pos_n = cipher_image_name.find('N');
-        size_t pos_at = cipher_image_name.find('@');
-
-        if (pos_n == std::string::npos) {
-          LOG_ERROR("Invalid filename");
-          continue;
-        }
-
-        remote_id = cipher_image_name.substr(0, pos_n);
-        remote_host_name = cipher_image_name.substr(pos_n + 1);
-
-        original_image_name =
-            remote_id + 'N' + remote_host_name + "@" +
-            AES_decrypt(cipher_password, aes128_key_, aes128_iv_);
-      }
+  }
 
-      std::string image_path = save_path_ + cipher_image_name;
-      recent_connections.emplace_back(
-          std::make_pair(original_image_name, Thumbnail::RecentConnection()));
-      LoadTextureFromFile(image_path.c_str(), renderer,
-                          &(recent_connections[i].second.texture), width,
-                          height);
+  for (const auto& entry : entries) {
+    Thumbnail::RecentConnection connection;
+    connection.remote_id = entry.remote_id;
+    connection.remote_host_name = entry.host_name;
+    // connection info -> remote_id + 'Y' + host_name + '@' + password
+    //                 -> remote_id + 'N' + host_name
+    std::string connection_info;
+    if (!entry.cipher_password.empty()) {
+      connection.password =
+          AES_decrypt(entry.cipher_password, aes128_key_, aes128_iv_);
+      connection.remember_password = true;
+      connection_info = entry.remote_id + 'Y' + entry.host_name + '@' +
+                        connection.password;
+    } else {
+      connection_info = entry.remote_id + 'N' + entry.host_name;
     }
+
+    connection.image_path = save_path_ + entry.file_name;
+    recent_connections.emplace_back(connection_info, std::move(connection));
+  }
+  return 0;
+}
+
+int Thumbnail::DeleteThumbnail(const std::string& remote_id) {
+  std::lock_guard<std::mutex> lock(files_mutex_);
+  return DeleteThumbnailLocked(remote_id);
+}
+
+int Thumbnail::DeleteThumbnailLocked(const std::string& remote_id) {
+  if (0 != OpenIndexLocked()) {
+    return -1;
+  }
+
+  const ThumbnailIndex::Entry* entry = index_->Find(remote_id);
+  if (!entry) {
     return 0;
   }
+  std::error_code ec;
+  std::filesystem::remove(save_path_ + entry->file_name, ec);
+  return index_->Remove(remote_id);
+}
+
+int Thumbnail::OpenIndexLocked() {
+  if (!index_) {
+    index_ = std::make_unique<ThumbnailIndex>(save_path_ + kIndexFileName);
+  }
+  if (index_->IsOpen()) {
+    return 0;
+  }
+
+  bool created = false;
+  if (0 != index_->Open(&created)) {
+    return -1;
+  }
+  if (created) {
+    RebuildIndexLocked();
+  }
   return 0;
 }
 
-int Thumbnail::DeleteThumbnail(const std::string& filename_keyword) {
-  for (const auto& entry : std::filesystem::directory_iterator(save_path_)) {
-    if (entry.is_regular_file()) {
-      const std::string filename = entry.path().filename().string();
-      std::string id_hostname = filename_keyword.substr(0, filename.find('@'));
-      if (filename.find(id_hostname) != std::string::npos) {
-        std::filesystem::remove(entry.path());
+void Thumbnail::RebuildIndexLocked() {
+  std::vector<std::filesystem::path> image_paths =
+      FindThumbnailPath(save_path_);
+  // oldest first, so the newest one ends up most recent in the index
+  for (auto it = image_paths.rbegin(); it != image_paths.rend(); ++it) {
+    std::string file_name = it->filename().string();
+    if (file_name.rfind(kIndexFileName, 0) == 0) {
+      continue;
+    }
+
+    // remote id length is 9
+    ThumbnailIndex::Entry entry;
+    entry.file_name = file_name;
+    if (file_name.size() == 13 && it->extension() == ".qoi") {
+      // host name and password lived in the lost index, only the image
+      // and the id are left
+      entry.remote_id = file_name.substr(0, 9);
+    } else if (file_name.size() >= 16 && 'Y' == file_name[9]) {
+      size_t pos_at = file_name.find('@', 10);
+      if (pos_at == std::string::npos) {
+        LOG_ERROR("Invalid thumbnail file name [{}]", file_name);
+        continue;
       }
+      entry.remote_id = file_name.substr(0, 9);
+      entry.host_name = file_name.substr(10, pos_at - 10);
+      entry.cipher_password = file_name.substr(pos_at + 1);
+    } else if (file_name.size() >= 10 && 'N' == file_name[9]) {
+      entry.remote_id = file_name.substr(0, 9);
+      entry.host_name = file_name.substr(10);
+    } else {
+      LOG_ERROR("Invalid thumbnail file name [{}]", file_name);
+      continue;
     }
+    index_->Put(entry);
   }
-
-  return 0;
+  LOG_INFO("Indexed [{}] existing thumbnails", index_->List().size());
 }
 
 std::vector<std::filesystem::path> Thumbnail::FindThumbnailPath(
@@ -307,6 +305,9 @@ std::vector<std::filesystem::path> Thumbnail::FindThumbnailPath(
 }
 
 int Thumbnail::DeleteAllFilesInDirectory() {
+  std::lock_guard<std::mutex> lock(files_mutex_);
+  // the index goes with the files and is recreated empty on next use
+  index_.reset();
   if (std::filesystem::exists(save_path_) &&
       std::filesystem::is_directory(save_path_)) {
     for (const auto& entry : std::filesystem::directory_iterator(save_path_)) {
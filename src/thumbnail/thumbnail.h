@@ -9,23 +9,46 @@
 
 #include <SDL3/SDL.h>
 
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 
+#include "nv12_scaler.h"
+#include "thumbnail_index.h"
+
 namespace crossdesk {
 
 class Thumbnail {
  public:
   struct RecentConnection {
-    SDL_Texture* texture = nullptr;
+    // decoded on demand by ThumbnailAtlas
+    std::string image_path;
     std::string remote_id;
     std::string remote_host_name;
     std::string password;
     bool remember_password = false;
   };
 
+  // everything the worker needs, so the session can go away meanwhile
+  struct SaveJob {
+    // NV12 frame owned by the job, null for a black thumbnail
+    std::unique_ptr<unsigned char[]> nv12;
+    int width = 0;
+    int height = 0;
+    std::string remote_id;
+    std::string host_name;
+    std::string password;
+  };
+
+  typedef std::function<void(const std::string& remote_id)> save_done_cb;
+
  public:
   Thumbnail(std::string save_path);
   explicit Thumbnail(std::string save_path, unsigned char* aes128_key,
@@ -33,18 +56,17 @@ class Thumbnail {
   ~Thumbnail();
 
  public:
-  int SaveToThumbnail(const char* yuv420p, int width, int height,
-                      const std::string& remote_id,
-                      const std::string& host_name,
-                      const std::string& password);
+  // Converts, encodes and writes the thumbnail on a worker thread, then
+  // calls the done callback there. Pending jobs finish before destruction.
+  void SaveToThumbnailAsync(SaveJob job);
+  void SetSaveDoneCallback(save_done_cb cb);
 
+  // lists the indexed thumbnails, the images themselves are not read
   int LoadThumbnail(
-      SDL_Renderer* renderer,
       std::vector<std::pair<std::string, Thumbnail::RecentConnection>>&
-          recent_connections,
-      int* width, int* height);
+          recent_connections);
 
-  int DeleteThumbnail(const std::string& filename_keyword);
+  int DeleteThumbnail(const std::string& remote_id);
 
   int DeleteAllFilesInDirectory();
 
@@ -65,6 +87,22 @@ class Thumbnail {
   }
 
  private:
+  // worker thread
+  void WorkerLoop();
+  int SaveToThumbnail(const char* yuv420p, int width, int height,
+                      const std::string& remote_id,
+                      const std::string& host_name,
+                      const std::string& password);
+  // caller holds files_mutex_
+  int DeleteThumbnailLocked(const std::string& remote_id);
+  // caller holds files_mutex_, opens the index on first use
+  int OpenIndexLocked();
+  // caller holds files_mutex_, indexes the thumbnails found on disk when
+  // the index is new: those named by the old remote_id + 'Y' + host_name +
+  // '@' + cipher_password scheme, and remote_id.qoi files whose index
+  // was lost
+  void RebuildIndexLocked();
+
   std::vector<std::filesystem::path> FindThumbnailPath(
       const std::filesystem::path& directory);
 
@@ -84,6 +122,20 @@ class Thumbnail {
   unsigned char aes128_iv_[16];
   unsigned char ciphertext_[64];
   unsigned char decryptedtext_[64];
+
+  // the worker writes while the UI lists and deletes
+  std::mutex files_mutex_;
+  std::unique_ptr<ThumbnailIndex> index_;
+
+  std::mutex jobs_mutex_;
+  std::condition_variable jobs_cv_;
+  std::deque<SaveJob> jobs_;
+  bool exit_ = false;
+  save_done_cb save_done_cb_;
+  std::thread worker_;
+
+  // worker thread
+  Nv12Scaler scaler_;
 };
 }  // namespace crossdesk
 #endif
\ No newline at end of file
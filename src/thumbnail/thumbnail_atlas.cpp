@@ -0,0 +1,296 @@
+#include "thumbnail_atlas.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "qoi_codec.h"
+#include "rd_log.h"
+#include "stb_image.h"
+
+namespace crossdesk {
+
+ThumbnailAtlas::ThumbnailAtlas(int cell_width, int cell_height, int columns,
+                               int rows)
+    : cell_width_(cell_width),
+      cell_height_(cell_height),
+      columns_(columns),
+      rows_(rows) {
+  for (int cell = columns_ * rows_ - 1; cell >= 0; --cell) {
+    free_cells_.push_back(cell);
+  }
+}
+
+ThumbnailAtlas::~ThumbnailAtlas() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    exit_ = true;
+  }
+  jobs_cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThumbnailAtlas::Request(const std::string& key,
+                             const std::string& file_path) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = items_.find(key);
+    if (it != items_.end()) {
+      lru_.splice(lru_.begin(), lru_, it->second.lru);
+      return;
+    }
+
+    lru_.push_front(key);
+    Item item;
+    item.lru = lru_.begin();
+    items_.emplace(key, item);
+    jobs_.push_back({key, file_path});
+
+    if (workers_.empty()) {
+      int count =
+          std::clamp((int)std::thread::hardware_concurrency() / 2, 1, 4);
+      for (int i = 0; i < count; ++i) {
+        workers_.emplace_back(&ThumbnailAtlas::WorkerLoop, this);
+      }
+    }
+  }
+  jobs_cv_.notify_one();
+}
+
+void ThumbnailAtlas::Store(const std::string& key,
+                           std::vector<uint8_t> pixels) {
+  if (pixels.size() != (size_t)cell_width_ * cell_height_ * 4) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = items_.find(key);
+  if (it != items_.end()) {
+    lru_.splice(lru_.begin(), lru_, it->second.lru);
+  } else {
+    lru_.push_front(key);
+    Item item;
+    item.lru = lru_.begin();
+    items_.emplace(key, item);
+  }
+  results_.push_back({key, std::move(pixels)});
+}
+
+int ThumbnailAtlas::Upload(SDL_Renderer* renderer) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (results_.empty()) {
+    return 0;
+  }
+
+  if (!texture_) {
+    texture_ = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_RGBA32,
+                                 SDL_TEXTUREACCESS_STATIC,
+                                 cell_width_ * columns_, cell_height_ * rows_);
+    if (!texture_) {
+      LOG_ERROR("Failed to create thumbnail atlas: [{}]", SDL_GetError());
+      return -1;
+    }
+    SDL_SetTextureBlendMode(texture_, SDL_BLENDMODE_BLEND);
+  }
+
+  for (auto& result : results_) {
+    auto it = items_.find(result.key);
+    if (it == items_.end()) {
+      // cleared while decoding
+      continue;
+    }
+    if (it->second.stale) {
+      // decoded the old file, the next Request picks up the new one
+      EraseLocked(it);
+      continue;
+    }
+    if (result.pixels.empty()) {
+      // stays in items_ as -1 so a broken file is not decoded every frame
+      continue;
+    }
+
+    // a stored image replaces the previous one in place
+    int cell = it->second.cell >= 0 ? it->second.cell : AcquireCellLocked();
+    if (cell < 0) {
+      EraseLocked(it);
+      continue;
+    }
+    SDL_Rect rect = {(cell % columns_) * cell_width_,
+                     (cell / columns_) * cell_height_, cell_width_,
+                     cell_height_};
+    if (!SDL_UpdateTexture(texture_, &rect, result.pixels.data(),
+                           cell_width_ * 4)) {
+      LOG_ERROR("Failed to update thumbnail atlas: [{}]", SDL_GetError());
+      if (it->second.cell < 0) {
+        free_cells_.push_back(cell);
+      }
+      EraseLocked(it);
+      continue;
+    }
+    it->second.cell = cell;
+  }
+  results_.clear();
+  return 0;
+}
+
+bool ThumbnailAtlas::Lookup(const std::string& key, Region* region) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = items_.find(key);
+  if (it == items_.end() || it->second.cell < 0 || !texture_) {
+    return false;
+  }
+
+  int cell = it->second.cell;
+  float width = (float)(cell_width_ * columns_);
+  float height = (float)(cell_height_ * rows_);
+  region->texture = texture_;
+  region->u0 = (cell % columns_) * cell_width_ / width;
+  region->v0 = (cell / columns_) * cell_height_ / height;
+  region->u1 = region->u0 + cell_width_ / width;
+  region->v1 = region->v0 + cell_height_ / height;
+  return true;
+}
+
+void ThumbnailAtlas::Invalidate(const std::string& key) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = items_.find(key);
+  if (it == items_.end()) {
+    return;
+  }
+  if (it->second.cell < 0) {
+    // still decoding, or failed; either way the file is worth another try
+    it->second.stale = true;
+    bool queued =
+        std::any_of(jobs_.begin(), jobs_.end(),
+                    [&key](const Job& job) { return job.key == key; });
+    bool decoded = std::any_of(
+        results_.begin(), results_.end(),
+        [&key](const Result& result) { return result.key == key; });
+    if (queued || decoded) {
+      return;
+    }
+  }
+  EraseLocked(it);
+}
+
+void ThumbnailAtlas::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (texture_) {
+    SDL_DestroyTexture(texture_);
+    texture_ = nullptr;
+  }
+  items_.clear();
+  lru_.clear();
+  jobs_.clear();
+  results_.clear();
+  free_cells_.clear();
+  for (int cell = columns_ * rows_ - 1; cell >= 0; --cell) {
+    free_cells_.push_back(cell);
+  }
+}
+
+void ThumbnailAtlas::WorkerLoop() {
+  while (true) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      jobs_cv_.wait(lock, [this]() { return exit_ || !jobs_.empty(); });
+      if (exit_) {
+        return;
+      }
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+
+    Result result;
+    result.key = std::move(job.key);
+    result.pixels = Decode(job.file_path);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    results_.push_back(std::move(result));
+  }
+}
+
+std::vector<uint8_t> ThumbnailAtlas::Decode(const std::string& file_path) {
+  std::vector<uint8_t> pixels;
+  std::ifstream file(file_path, std::ios::binary);
+  if (!file) {
+    LOG_ERROR("Failed to open thumbnail [{}]", file_path);
+    return pixels;
+  }
+  std::vector<char> data((std::istreambuf_iterator<char>(file)),
+                         std::istreambuf_iterator<char>());
+
+  std::vector<uint8_t> image;
+  int width = 0;
+  int height = 0;
+  if (IsQoi((const uint8_t*)data.data(), data.size())) {
+    if (0 != QoiDecode((const uint8_t*)data.data(), data.size(), image,
+                       &width, &height)) {
+      LOG_ERROR("Failed to decode thumbnail [{}]", file_path);
+      return pixels;
+    }
+  } else {
+    // saved as PNG by an older version
+    unsigned char* png =
+        stbi_load_from_memory((const unsigned char*)data.data(),
+                              (int)data.size(), &width, &height, NULL, 4);
+    if (!png) {
+      LOG_ERROR("Failed to decode thumbnail [{}]: [{}]", file_path,
+                stbi_failure_reason());
+      return pixels;
+    }
+    image.assign(png, png + (size_t)width * height * 4);
+    stbi_image_free(png);
+  }
+
+  if (width == cell_width_ && height == cell_height_) {
+    return image;
+  }
+
+  // thumbnails from older versions may use another size
+  pixels.resize((size_t)cell_width_ * cell_height_ * 4);
+  for (int y = 0; y < cell_height_; ++y) {
+    const uint8_t* src_row =
+        image.data() + (size_t)(y * height / cell_height_) * width * 4;
+    uint8_t* dst_row = pixels.data() + (size_t)y * cell_width_ * 4;
+    for (int x = 0; x < cell_width_; ++x) {
+      memcpy(dst_row + x * 4, src_row + (size_t)(x * width / cell_width_) * 4,
+             4);
+    }
+  }
+  return pixels;
+}
+
+int ThumbnailAtlas::AcquireCellLocked() {
+  if (!free_cells_.empty()) {
+    int cell = free_cells_.back();
+    free_cells_.pop_back();
+    return cell;
+  }
+
+  for (auto it = lru_.rbegin(); it != lru_.rend(); ++it) {
+    auto item = items_.find(*it);
+    if (item->second.cell < 0) {
+      continue;
+    }
+    int cell = item->second.cell;
+    item->second.cell = -1;
+    EraseLocked(item);
+    return cell;
+  }
+  return -1;
+}
+
+void ThumbnailAtlas::EraseLocked(
+    std::unordered_map<std::string, Item>::iterator it) {
+  if (it->second.cell >= 0) {
+    free_cells_.push_back(it->second.cell);
+  }
+  lru_.erase(it->second.lru);
+  items_.erase(it);
+}
+}  // namespace crossdesk
@@ -0,0 +1,100 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _THUMBNAIL_ATLAS_H_
+#define _THUMBNAIL_ATLAS_H_
+
+#include <SDL3/SDL.h>
+
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace crossdesk {
+
+// Decodes thumbnails on a small worker pool and packs them into the cells
+// of one shared texture. Only requested thumbnails are decoded, and once
+// every cell is taken the least recently requested one is reused.
+// Request, Store, Upload, Lookup and Clear run on the UI thread,
+// Invalidate may be called from any thread.
+class ThumbnailAtlas {
+ public:
+  struct Region {
+    SDL_Texture* texture = nullptr;
+    float u0 = 0;
+    float v0 = 0;
+    float u1 = 0;
+    float v1 = 0;
+  };
+
+ public:
+  ThumbnailAtlas(int cell_width, int cell_height, int columns, int rows);
+  ~ThumbnailAtlas();
+
+ public:
+  // decodes |file_path| unless |key| is cached or already queued
+  void Request(const std::string& key, const std::string& file_path);
+  // uploads |pixels| (cell sized RGBA) for |key| on the next Upload
+  void Store(const std::string& key, std::vector<uint8_t> pixels);
+  // copies finished decodes and stored images into the texture, creating
+  // it on first use
+  int Upload(SDL_Renderer* renderer);
+  // false until the thumbnail of |key| has been uploaded
+  bool Lookup(const std::string& key, Region* region);
+  // the file behind |key| changed
+  void Invalidate(const std::string& key);
+  // drops the texture and every cell, call before the renderer goes away
+  void Clear();
+
+ private:
+  struct Item {
+    // -1 while decoding
+    int cell = -1;
+    bool stale = false;
+    std::list<std::string>::iterator lru;
+  };
+  struct Job {
+    std::string key;
+    std::string file_path;
+  };
+  struct Result {
+    std::string key;
+    // cell_width_ x cell_height_ RGBA, empty when decoding failed
+    std::vector<uint8_t> pixels;
+  };
+
+  void WorkerLoop();
+  std::vector<uint8_t> Decode(const std::string& file_path);
+  // caller holds mutex_, returns a free cell or evicts one, -1 if all busy
+  int AcquireCellLocked();
+  void EraseLocked(std::unordered_map<std::string, Item>::iterator it);
+
+ private:
+  const int cell_width_;
+  const int cell_height_;
+  const int columns_;
+  const int rows_;
+
+  SDL_Texture* texture_ = nullptr;
+
+  std::mutex mutex_;
+  std::condition_variable jobs_cv_;
+  std::unordered_map<std::string, Item> items_;
+  // most recently requested first, decoding items included
+  std::list<std::string> lru_;
+  std::vector<int> free_cells_;
+  std::deque<Job> jobs_;
+  std::vector<Result> results_;
+  bool exit_ = false;
+  std::vector<std::thread> workers_;
+};
+}  // namespace crossdesk
+#endif
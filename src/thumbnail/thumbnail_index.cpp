@@ -0,0 +1,232 @@
+#include "thumbnail_index.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iterator>
+
+#include "rd_log.h"
+
+namespace crossdesk {
+
+constexpr char kMagic[4] = {'C', 'D', 'T', 'I'};
+constexpr char kVersion = 1;
+constexpr char kOpPut = 'P';
+constexpr char kOpRemove = 'R';
+// rewrite once dead records outnumber live ones, but not for a handful
+constexpr size_t kMinDeadRecords = 32;
+
+static void WriteField(std::string& out, const std::string& field) {
+  uint16_t size = (uint16_t)std::min<size_t>(field.size(), 0xFFFF);
+  out.push_back((char)(size & 0xFF));
+  out.push_back((char)(size >> 8));
+  out.append(field, 0, size);
+}
+
+static bool ReadField(const std::string& in, size_t& pos, std::string& field) {
+  if (pos + 2 > in.size()) {
+    return false;
+  }
+  size_t size = (uint8_t)in[pos] | ((size_t)(uint8_t)in[pos + 1] << 8);
+  pos += 2;
+  if (pos + size > in.size()) {
+    return false;
+  }
+  field.assign(in, pos, size);
+  pos += size;
+  return true;
+}
+
+static std::string EncodeRecord(char op,
+                                const ThumbnailIndex::Entry& entry) {
+  std::string record(1, op);
+  WriteField(record, entry.remote_id);
+  if (op == kOpPut) {
+    WriteField(record, entry.host_name);
+    WriteField(record, entry.cipher_password);
+    WriteField(record, entry.file_name);
+  }
+  return record;
+}
+
+ThumbnailIndex::ThumbnailIndex(const std::string& path) : path_(path) {}
+
+ThumbnailIndex::~ThumbnailIndex() {}
+
+int ThumbnailIndex::Open(bool* created) {
+  *created = false;
+  slots_.clear();
+  order_.clear();
+  next_seq_ = 0;
+  dead_records_ = 0;
+
+  std::ifstream in(path_, std::ios::binary);
+  if (!in) {
+    *created = true;
+    return Compact();
+  }
+  std::string data((std::istreambuf_iterator<char>(in)),
+                   std::istreambuf_iterator<char>());
+  in.close();
+
+  if (data.size() < sizeof(kMagic) + 1 ||
+      0 != data.compare(0, sizeof(kMagic), kMagic, sizeof(kMagic)) ||
+      data[sizeof(kMagic)] != kVersion) {
+    LOG_WARN("Unknown thumbnail index [{}], rebuilding it", path_);
+    *created = true;
+    return Compact();
+  }
+
+  size_t pos = sizeof(kMagic) + 1;
+  size_t records = 0;
+  bool truncated = false;
+  while (pos < data.size()) {
+    char op = data[pos++];
+    Entry entry;
+    bool ok = ReadField(data, pos, entry.remote_id);
+    if (ok && op == kOpPut) {
+      ok = ReadField(data, pos, entry.host_name) &&
+           ReadField(data, pos, entry.cipher_password) &&
+           ReadField(data, pos, entry.file_name);
+    } else if (ok && op != kOpRemove) {
+      ok = false;
+    }
+    if (!ok) {
+      // interrupted append, everything before it is intact
+      truncated = true;
+      break;
+    }
+    Apply(op, std::move(entry));
+    records++;
+  }
+  dead_records_ = records - slots_.size();
+
+  if (truncated || dead_records_ > slots_.size()) {
+    if (truncated) {
+      LOG_WARN("Thumbnail index [{}] ends in a partial record", path_);
+    }
+    return Compact();
+  }
+
+  log_.open(path_, std::ios::binary | std::ios::app);
+  if (!log_) {
+    LOG_ERROR("Failed to open thumbnail index [{}]", path_);
+    return -1;
+  }
+  return 0;
+}
+
+void ThumbnailIndex::Apply(char op, Entry entry) {
+  auto it = slots_.find(entry.remote_id);
+  if (it != slots_.end()) {
+    order_.erase(it->second.seq);
+    if (op == kOpRemove) {
+      slots_.erase(it);
+      return;
+    }
+  } else if (op == kOpRemove) {
+    return;
+  }
+
+  uint64_t seq = next_seq_++;
+  order_[seq] = entry.remote_id;
+  Slot& slot = slots_[entry.remote_id];
+  slot.entry = std::move(entry);
+  slot.seq = seq;
+}
+
+int ThumbnailIndex::Append(char op, const Entry& entry) {
+  if (!log_) {
+    return -1;
+  }
+  std::string record = EncodeRecord(op, entry);
+  log_.write(record.data(), record.size());
+  log_.flush();
+  if (!log_) {
+    LOG_ERROR("Failed to append to thumbnail index [{}]", path_);
+    return -1;
+  }
+
+  if (dead_records_ > kMinDeadRecords && dead_records_ > slots_.size()) {
+    return Compact();
+  }
+  return 0;
+}
+
+int ThumbnailIndex::Put(const Entry& entry) {
+  if (slots_.count(entry.remote_id)) {
+    dead_records_++;
+  }
+  Apply(kOpPut, entry);
+  return Append(kOpPut, entry);
+}
+
+int ThumbnailIndex::Remove(const std::string& remote_id) {
+  if (!slots_.count(remote_id)) {
+    return 0;
+  }
+  Entry entry;
+  entry.remote_id = remote_id;
+  Apply(kOpRemove, entry);
+  // the put it cancels and the remove itself
+  dead_records_ += 2;
+  return Append(kOpRemove, entry);
+}
+
+int ThumbnailIndex::Clear() {
+  slots_.clear();
+  order_.clear();
+  dead_records_ = 0;
+  return Compact();
+}
+
+const ThumbnailIndex::Entry* ThumbnailIndex::Find(
+    const std::string& remote_id) const {
+  auto it = slots_.find(remote_id);
+  return it == slots_.end() ? nullptr : &it->second.entry;
+}
+
+std::vector<ThumbnailIndex::Entry> ThumbnailIndex::List() const {
+  std::vector<Entry> entries;
+  entries.reserve(order_.size());
+  for (const auto& [seq, remote_id] : order_) {
+    entries.push_back(slots_.at(remote_id).entry);
+  }
+  return entries;
+}
+
+int ThumbnailIndex::Compact() {
+  std::string data(kMagic, sizeof(kMagic));
+  data.push_back(kVersion);
+  // oldest first, replaying restores the same order
+  for (auto it = order_.rbegin(); it != order_.rend(); ++it) {
+    data += EncodeRecord(kOpPut, slots_.at(it->second).entry);
+  }
+
+  if (log_.is_open()) {
+    log_.close();
+  }
+  std::string tmp_path = path_ + ".tmp";
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    if (!out.write(data.data(), data.size())) {
+      LOG_ERROR("Failed to write thumbnail index [{}]", tmp_path);
+      return -1;
+    }
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmp_path, path_, ec);
+  if (ec) {
+    LOG_ERROR("Failed to replace thumbnail index [{}]: [{}]", path_,
+              ec.message());
+    return -1;
+  }
+  dead_records_ = 0;
+
+  log_.open(path_, std::ios::binary | std::ios::app);
+  if (!log_) {
+    LOG_ERROR("Failed to open thumbnail index [{}]", path_);
+    return -1;
+  }
+  return 0;
+}
+}  // namespace crossdesk
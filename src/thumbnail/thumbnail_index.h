@@ -0,0 +1,76 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _THUMBNAIL_INDEX_H_
+#define _THUMBNAIL_INDEX_H_
+
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace crossdesk {
+
+// Metadata of the recent connections, kept as an append-only log next to
+// the thumbnails. Every insert, update or delete appends one record, the
+// log is replayed once on Open and rewritten when most of it is dead.
+// Not thread safe, Thumbnail serialises all calls.
+class ThumbnailIndex {
+ public:
+  struct Entry {
+    std::string remote_id;
+    std::string host_name;
+    // AES encrypted, hex encoded, empty without a remembered password
+    std::string cipher_password;
+    // image file name inside the thumbnail directory
+    std::string file_name;
+  };
+
+ public:
+  ThumbnailIndex(const std::string& path);
+  ~ThumbnailIndex();
+
+ public:
+  // Loads the log, or creates an empty one and sets |created| so the
+  // caller can migrate existing thumbnails into it.
+  int Open(bool* created);
+  bool IsOpen() const { return log_.is_open(); }
+
+  // inserts or updates |entry| and makes it the most recent one
+  int Put(const Entry& entry);
+  int Remove(const std::string& remote_id);
+  int Clear();
+
+  const Entry* Find(const std::string& remote_id) const;
+  // most recent first
+  std::vector<Entry> List() const;
+
+ private:
+  struct Slot {
+    Entry entry;
+    uint64_t seq = 0;
+  };
+
+  void Apply(char op, Entry entry);
+  int Append(char op, const Entry& entry);
+  int Compact();
+
+ private:
+  const std::string path_;
+  std::ofstream log_;
+
+  std::unordered_map<std::string, Slot> slots_;
+  // seq -> remote_id, newest first
+  std::map<uint64_t, std::string, std::greater<uint64_t>> order_;
+  uint64_t next_seq_ = 0;
+  // records in the log that no longer describe a live entry
+  size_t dead_records_ = 0;
+};
+}  // namespace crossdesk
+#endif
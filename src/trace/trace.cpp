@@ -0,0 +1,265 @@
+#include "trace.h"
+
+#include <csignal>
+#include <cstring>
+#include <functional>
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "rd_log.h"
+
+namespace crossdesk {
+
+namespace {
+
+int64_t SteadyNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+std::atomic<TraceRing*> g_rings[kMaxTraceRings];
+// may run past kMaxTraceRings once every ring is taken
+std::atomic<uint32_t> g_ring_count{0};
+
+// pairs the tick counter with the clocks, the rate is measured at dump time
+const uint64_t g_base_ticks = TraceTicks();
+const int64_t g_base_steady_ns = SteadyNanos();
+const int64_t g_base_unix_us =
+    std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch())
+        .count();
+
+// fixed buffers, the signal handlers must not allocate
+char g_dump_path[512] = {};
+char g_crash_path[512] = {};
+
+// releases the ring when its thread exits
+struct RingOwner {
+  TraceRing* ring = nullptr;
+  // every ring was taken, the thread records nothing
+  bool exhausted = false;
+  ~RingOwner() {
+    g_trace_ring = nullptr;
+    if (ring) {
+      ring->in_use.store(false, std::memory_order_release);
+    }
+  }
+};
+
+int OpenDumpFile(const char* path) {
+#ifdef _WIN32
+  return _open(path, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+               _S_IREAD | _S_IWRITE);
+#else
+  return open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+}
+
+bool WriteAll(int fd, const void* data, size_t size) {
+  const char* p = (const char*)data;
+  while (size > 0) {
+#ifdef _WIN32
+    int written = _write(fd, p, (unsigned int)size);
+#else
+    ssize_t written = write(fd, p, size);
+#endif
+    if (written <= 0) {
+      return false;
+    }
+    p += written;
+    size -= (size_t)written;
+  }
+  return true;
+}
+
+void CloseDumpFile(int fd) {
+#ifdef _WIN32
+  _close(fd);
+#else
+  close(fd);
+#endif
+}
+
+void OnCrashSignal(int sig) {
+  if (g_crash_path[0]) {
+    TraceDump(g_crash_path);
+  }
+  signal(sig, SIG_DFL);
+  raise(sig);
+}
+
+#ifdef _WIN32
+LONG WINAPI OnUnhandledException(EXCEPTION_POINTERS*) {
+  if (g_crash_path[0]) {
+    TraceDump(g_crash_path);
+  }
+  return EXCEPTION_CONTINUE_SEARCH;
+}
+#else
+void OnDumpSignal(int) {
+  if (g_dump_path[0]) {
+    TraceDump(g_dump_path);
+  }
+}
+#endif
+
+}  // namespace
+
+thread_local TraceRing* g_trace_ring = nullptr;
+
+int TraceInit(const std::string& dump_dir) {
+  std::string dump_path = dump_dir + "/crossdesk-trace.bin";
+  std::string crash_path = dump_dir + "/crossdesk-trace-crash.bin";
+  if (crash_path.size() >= sizeof(g_crash_path)) {
+    LOG_ERROR("Trace dump directory [{}] is too long", dump_dir);
+    return -1;
+  }
+  memcpy(g_dump_path, dump_path.c_str(), dump_path.size() + 1);
+  memcpy(g_crash_path, crash_path.c_str(), crash_path.size() + 1);
+
+#ifdef _WIN32
+  SetUnhandledExceptionFilter(OnUnhandledException);
+  signal(SIGABRT, OnCrashSignal);
+#else
+  struct sigaction action;
+  memset(&action, 0, sizeof(action));
+  sigemptyset(&action.sa_mask);
+  action.sa_handler = OnCrashSignal;
+  action.sa_flags = SA_RESETHAND;
+  for (int sig : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT}) {
+    sigaction(sig, &action, nullptr);
+  }
+
+  action.sa_handler = OnDumpSignal;
+  action.sa_flags = SA_RESTART;
+  sigaction(SIGUSR1, &action, nullptr);
+#endif
+
+  LOG_INFO("Trace dumps go to [{}]", dump_dir);
+  return 0;
+}
+
+TraceRing* TraceAcquireRingSlow() {
+  thread_local RingOwner owner;
+  if (owner.ring || owner.exhausted) {
+    return owner.ring;
+  }
+
+  TraceRing* ring = nullptr;
+  uint32_t count = g_ring_count.load(std::memory_order_acquire);
+  for (uint32_t i = 0; i < count && i < kMaxTraceRings && !ring; ++i) {
+    TraceRing* candidate = g_rings[i].load(std::memory_order_acquire);
+    bool expected = false;
+    if (candidate &&
+        candidate->in_use.compare_exchange_strong(expected, true)) {
+      ring = candidate;
+    }
+  }
+
+  if (!ring) {
+    uint32_t index = g_ring_count.fetch_add(1);
+    if (index >= kMaxTraceRings) {
+      owner.exhausted = true;
+      return nullptr;
+    }
+    ring = new TraceRing();
+    ring->in_use = true;
+    g_rings[index].store(ring, std::memory_order_release);
+  }
+
+  // the previous owner's history is gone with its thread id
+  ring->head.store(0, std::memory_order_release);
+  ring->thread_id = std::hash<std::thread::id>()(std::this_thread::get_id());
+  memset(ring->name, 0, sizeof(ring->name));
+  memcpy(ring->name, "thread", 6);
+  owner.ring = ring;
+  g_trace_ring = ring;
+  return ring;
+}
+
+void TraceSetThreadName(const char* name) {
+  TraceRing* ring = TraceAcquireRing();
+  if (!ring) {
+    return;
+  }
+  memset(ring->name, 0, sizeof(ring->name));
+  strncpy(ring->name, name, sizeof(ring->name) - 1);
+}
+
+int TraceDump(const char* path) {
+  int fd = OpenDumpFile(path);
+  if (fd < 0) {
+    return -1;
+  }
+
+  uint64_t ticks = TraceTicks();
+  int64_t steady_ns = SteadyNanos();
+  uint32_t ring_count = g_ring_count.load(std::memory_order_acquire);
+  if (ring_count > kMaxTraceRings) {
+    ring_count = kMaxTraceRings;
+  }
+
+  TraceFileHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kTraceMagic, sizeof(header.magic));
+  header.version = kTraceVersion;
+  header.ticks_per_second = 1000000000;
+  if (steady_ns > g_base_steady_ns && ticks > g_base_ticks) {
+    header.ticks_per_second =
+        (uint64_t)((double)(ticks - g_base_ticks) * 1e9 /
+                   (double)(steady_ns - g_base_steady_ns));
+  }
+  header.base_ticks = g_base_ticks;
+  header.base_unix_us = g_base_unix_us;
+  header.ring_count = ring_count;
+  bool ok = WriteAll(fd, &header, sizeof(header));
+
+  for (uint32_t i = 0; ok && i < ring_count; ++i) {
+    TraceRing* ring = g_rings[i].load(std::memory_order_acquire);
+    TraceRingHeader ring_header;
+    memset(&ring_header, 0, sizeof(ring_header));
+    if (!ring) {
+      // still being set up
+      ok = WriteAll(fd, &ring_header, sizeof(ring_header));
+      continue;
+    }
+
+    // other threads keep recording, the oldest records may be torn
+    uint64_t head = ring->head.load(std::memory_order_acquire);
+    uint64_t count = head < kTraceRingRecords ? head : kTraceRingRecords;
+    ring_header.thread_id = ring->thread_id;
+    memcpy(ring_header.name, ring->name, sizeof(ring_header.name));
+    ring_header.record_count = count;
+    ok = WriteAll(fd, &ring_header, sizeof(ring_header));
+
+    uint64_t start = (head - count) % kTraceRingRecords;
+    uint64_t first = kTraceRingRecords - start < count
+                         ? kTraceRingRecords - start
+                         : count;
+    ok = ok && WriteAll(fd, &ring->records[start],
+                        (size_t)first * sizeof(TraceRecord));
+    ok = ok && WriteAll(fd, &ring->records[0],
+                        (size_t)(count - first) * sizeof(TraceRecord));
+  }
+
+  CloseDumpFile(fd);
+  return ok ? 0 : -1;
+}
+
+int TraceDump() {
+  if (!g_dump_path[0]) {
+    return -1;
+  }
+  return TraceDump(g_dump_path);
+}
+}  // namespace crossdesk
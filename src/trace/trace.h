@@ -0,0 +1,171 @@
+/*
+ * @Author: DI JUNKUN
+ * @Date: 2025-10-19
+ * Copyright (c) 2025 by DI JUNKUN, All Rights Reserved.
+ */
+
+#ifndef _TRACE_H_
+#define _TRACE_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace crossdesk {
+
+// Always-on event history. Every thread records fixed-size events into a
+// ring of its own, without locks or allocation, and the rings are written
+// to a file on TraceDump, on SIGUSR1 or when the process crashes. Decode
+// the file with crossdesk_trace_decoder.
+enum class TraceEvent : uint32_t {
+  // arg0 width, arg1 height, arg2 bytes
+  capture = 1,
+  // arg0 bytes, arg1 capture timestamp
+  send_video,
+  // arg0 bytes
+  send_audio,
+  // arg0 bytes, arg1 capture timestamp
+  receive_video,
+  // arg0 bytes
+  receive_audio,
+  // arg0 width, arg1 height, arg2 capture timestamp
+  upload,
+  // stream window presented, arg0 sessions shown
+  present,
+  // arg0 mouse flag, arg1 x, arg2 y, both signed and scaled by 10000
+  input_mouse,
+  // arg0 key value, arg1 1 when pressed
+  input_keyboard,
+};
+
+inline const char* TraceEventName(uint32_t event) {
+  switch ((TraceEvent)event) {
+    case TraceEvent::capture:
+      return "capture";
+    case TraceEvent::send_video:
+      return "send_video";
+    case TraceEvent::send_audio:
+      return "send_audio";
+    case TraceEvent::receive_video:
+      return "receive_video";
+    case TraceEvent::receive_audio:
+      return "receive_audio";
+    case TraceEvent::upload:
+      return "upload";
+    case TraceEvent::present:
+      return "present";
+    case TraceEvent::input_mouse:
+      return "input_mouse";
+    case TraceEvent::input_keyboard:
+      return "input_keyboard";
+  }
+  return "unknown";
+}
+
+struct TraceRecord {
+  uint64_t ticks;
+  uint32_t event;
+  uint32_t arg0;
+  uint64_t arg1;
+  uint64_t arg2;
+};
+static_assert(sizeof(TraceRecord) == 32, "trace records are 32 bytes");
+
+// 128 KB per thread, a few seconds of history on the busiest threads
+constexpr uint32_t kTraceRingRecords = 4096;
+constexpr uint32_t kMaxTraceRings = 128;
+
+struct TraceRing {
+  TraceRecord records[kTraceRingRecords];
+  // records written so far, the newest is at (head - 1) % kTraceRingRecords
+  std::atomic<uint64_t> head{0};
+  uint64_t thread_id = 0;
+  char name[16] = {};
+  // a ring outlives its thread and is handed to the next new one
+  std::atomic<bool> in_use{false};
+};
+
+// dump file: TraceFileHeader, then per ring a TraceRingHeader followed by
+// its records, oldest first
+struct TraceFileHeader {
+  char magic[4];
+  uint32_t version;
+  uint64_t ticks_per_second;
+  uint64_t base_ticks;
+  int64_t base_unix_us;
+  uint32_t ring_count;
+  uint32_t reserved;
+};
+
+struct TraceRingHeader {
+  uint64_t thread_id;
+  char name[16];
+  uint64_t record_count;
+};
+
+constexpr char kTraceMagic[4] = {'C', 'D', 'T', 'R'};
+constexpr uint32_t kTraceVersion = 1;
+
+// TSC on x86, the virtual counter on ARM64, nanoseconds elsewhere
+inline uint64_t TraceTicks() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t ticks;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+#endif
+}
+
+// Sets up the dump files in |dump_dir| and the crash and SIGUSR1 handlers.
+// Events are recorded before this too.
+int TraceInit(const std::string& dump_dir);
+// names the calling thread's ring, at most 15 characters are kept
+void TraceSetThreadName(const char* name);
+// writes every ring to |path|, async-signal-safe
+int TraceDump(const char* path);
+// writes every ring to the on-demand dump file in the TraceInit directory
+int TraceDump();
+
+// the calling thread's ring, null until its first event. Constant
+// initialised, so reading it needs no guard.
+extern thread_local TraceRing* g_trace_ring;
+
+// claims a ring for the calling thread, null once every ring is taken
+TraceRing* TraceAcquireRingSlow();
+
+inline TraceRing* TraceAcquireRing() {
+  TraceRing* ring = g_trace_ring;
+  return ring ? ring : TraceAcquireRingSlow();
+}
+
+inline void TraceRecordEvent(TraceEvent event, uint32_t arg0 = 0,
+                             uint64_t arg1 = 0, uint64_t arg2 = 0) {
+  TraceRing* ring = TraceAcquireRing();
+  if (!ring) {
+    return;
+  }
+  uint64_t head = ring->head.load(std::memory_order_relaxed);
+  TraceRecord& record = ring->records[head % kTraceRingRecords];
+  record.ticks = TraceTicks();
+  record.event = (uint32_t)event;
+  record.arg0 = arg0;
+  record.arg1 = arg1;
+  record.arg2 = arg2;
+  ring->head.store(head + 1, std::memory_order_release);
+}
+}  // namespace crossdesk
+#endif
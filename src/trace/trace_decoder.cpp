@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "trace.h"
+
+using namespace crossdesk;
+
+namespace {
+
+struct Entry {
+  TraceRecord record;
+  uint32_t ring;
+};
+
+struct RingInfo {
+  uint64_t thread_id;
+  std::string name;
+};
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <crossdesk-trace.bin>\n", argv[0]);
+    return 1;
+  }
+
+  std::ifstream file(argv[1], std::ios::binary);
+  if (!file) {
+    fprintf(stderr, "cannot open %s\n", argv[1]);
+    return 1;
+  }
+
+  TraceFileHeader header;
+  if (!file.read((char*)&header, sizeof(header)) ||
+      memcmp(header.magic, kTraceMagic, sizeof(header.magic)) != 0) {
+    fprintf(stderr, "%s is not a trace dump\n", argv[1]);
+    return 1;
+  }
+  if (header.version != kTraceVersion) {
+    fprintf(stderr, "unsupported trace version %u\n", header.version);
+    return 1;
+  }
+  if (header.ticks_per_second == 0 || header.ring_count > kMaxTraceRings) {
+    fprintf(stderr, "corrupt trace header\n");
+    return 1;
+  }
+
+  std::vector<RingInfo> rings;
+  std::vector<Entry> entries;
+  for (uint32_t i = 0; i < header.ring_count; ++i) {
+    TraceRingHeader ring_header;
+    if (!file.read((char*)&ring_header, sizeof(ring_header)) ||
+        ring_header.record_count > kTraceRingRecords) {
+      fprintf(stderr, "truncated trace, ring %u\n", i);
+      break;
+    }
+    ring_header.name[sizeof(ring_header.name) - 1] = '\0';
+    rings.push_back({ring_header.thread_id, ring_header.name});
+
+    for (uint64_t j = 0; j < ring_header.record_count; ++j) {
+      Entry entry;
+      if (!file.read((char*)&entry.record, sizeof(entry.record))) {
+        fprintf(stderr, "truncated trace, ring %u\n", i);
+        break;
+      }
+      entry.ring = i;
+      entries.push_back(entry);
+    }
+  }
+
+  std::stable_sort(entries.begin(), entries.end(),
+                   [](const Entry& a, const Entry& b) {
+                     return a.record.ticks < b.record.ticks;
+                   });
+
+  printf("# %zu events from %zu threads, %llu ticks/s, started at %lld us\n",
+         entries.size(), rings.size(),
+         (unsigned long long)header.ticks_per_second,
+         (long long)header.base_unix_us);
+  for (const Entry& entry : entries) {
+    const TraceRecord& record = entry.record;
+    double ms = ((double)record.ticks - (double)header.base_ticks) * 1000.0 /
+                (double)header.ticks_per_second;
+    const RingInfo& ring = rings[entry.ring];
+    printf("%12.3f ms  %-15s %016llx  %-14s %10u ", ms, ring.name.c_str(),
+           (unsigned long long)ring.thread_id, TraceEventName(record.event),
+           record.arg0);
+    if (record.event == (uint32_t)TraceEvent::input_mouse) {
+      // remote cursors may sit left of or above the display
+      printf("%20lld %20lld\n", (long long)(int64_t)record.arg1,
+             (long long)(int64_t)record.arg2);
+    } else {
+      printf("%20llu %20llu\n", (unsigned long long)record.arg1,
+             (unsigned long long)record.arg2);
+    }
+  }
+
+  return 0;
+}
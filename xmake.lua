@@ -60,6 +60,12 @@ target("common")
     add_files("src/common/*.cpp")
     add_includedirs("src/common", {public = true})
 
+target("trace")
+    set_kind("object")
+    add_deps("rd_log")
+    add_files("src/trace/trace.cpp")
+    add_includedirs("src/trace", {public = true})
+
 target("path_manager")
     set_kind("object")
     add_deps("rd_log")
@@ -87,7 +93,8 @@ target("screen_capturer")
 
 target("speaker_capturer")
     set_kind("object")
-    add_deps("rd_log")
+    add_deps("rd_log", "common")
+    add_files("src/speaker_capturer/*.cpp")
     add_includedirs("src/speaker_capturer", {public = true})
     if is_os("windows") then
         add_packages("miniaudio")
@@ -106,6 +113,7 @@ target("device_controller")
     set_kind("object")
     add_deps("rd_log", "common")
     add_includedirs("src/device_controller", {public = true})
+    add_files("src/device_controller/*.cpp")
     if is_os("windows") then
         add_files("src/device_controller/mouse/windows/*.cpp",
         "src/device_controller/keyboard/windows/*.cpp")
@@ -125,7 +133,7 @@ target("device_controller")
 
 target("thumbnail")
     set_kind("object")
-    add_packages("libyuv", "openssl3")
+    add_packages("openssl3")
     add_deps("rd_log", "common")
     add_files("src/thumbnail/*.cpp")
     add_includedirs("src/thumbnail", {public = true})
@@ -149,7 +157,7 @@ target("gui")
     add_defines("CROSSDESK_VERSION=\"" .. (get_config("CROSSDESK_VERSION") or "Unknown") .. "\"")
     add_deps("rd_log", "common", "assets", "config_center", "minirtc", 
         "path_manager", "screen_capturer", "speaker_capturer", 
-        "device_controller", "thumbnail")
+        "device_controller", "thumbnail", "trace")
     add_files("src/gui/*.cpp", "src/gui/panels/*.cpp", "src/gui/toolbars/*.cpp",
         "src/gui/windows/*.cpp")
     add_includedirs("src/gui", "src/gui/panels", "src/gui/toolbars",
@@ -162,4 +170,32 @@ target("gui")
 target("crossdesk")
     set_kind("binary")
     add_deps("rd_log", "common", "gui")
-    add_files("src/app/main.cpp")
\ No newline at end of file
+    add_files("src/app/main.cpp")
+
+target("crossdesk_trace_decoder")
+    set_kind("binary")
+    add_files("src/trace/trace_decoder.cpp")
+    add_includedirs("src/trace")
+
+target("crossdesk_spsc_bench")
+    set_kind("binary")
+    set_default(false)
+    add_files("src/benchmark/spsc_ring_buffer_bench.cpp")
+    add_includedirs("src/common")
+
+target("crossdesk_nv12_scaler_bench")
+    set_kind("binary")
+    set_default(false)
+    add_packages("libyuv")
+    add_deps("rd_log")
+    add_files("src/benchmark/nv12_scaler_bench.cpp",
+        "src/thumbnail/nv12_scaler.cpp")
+    add_includedirs("src/thumbnail")
+
+target("crossdesk_remote_action_check")
+    set_kind("binary")
+    set_default(false)
+    add_files("src/tools/remote_action_check.cpp",
+        "src/device_controller/remote_action_codec.cpp",
+        "src/gui/data_channel_scheduler.cpp")
+    add_includedirs("src/common", "src/device_controller", "src/gui")